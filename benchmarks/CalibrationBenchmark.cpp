@@ -0,0 +1,318 @@
+/**
+ * @file CalibrationBenchmark.cpp
+ * @brief Benchmark de la calibración con tableros sintéticos, sin cámara.
+ * @details Renderiza vistas de un tablero de ajedrez con unos intrínsecos y una distorsión
+ * conocidos y poses aleatorias, las pasa por CalibrationWorker::processImageForCorners y
+ * CalibrationWorker::runCalibration y mide:
+ *   - imágenes por segundo de la detección de esquinas,
+ *   - tiempo total de la resolución (incluido el descarte de vistas atípicas),
+ *   - error de los intrínsecos y de la corrección resultante frente a los reales.
+ * Termina con código 1 si la calibración falla o si algún error supera su umbral (MAX_*), para
+ * poder usarlo como prueba de regresión de la precisión.
+ *
+ * Uso: calibrationBenchmark [vistas=30] [semilla=42]
+ */
+#include "CalibrationWorker.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace
+{
+const cv::Size IMAGE_SIZE(1280, 720);
+const cv::Size BOARD_SIZE(9, 6);        // Esquinas interiores, como en VideoCalibrationDialog
+const float    SQUARE_SIZE       = 25.0f; // mm
+const int      TEXTURE_PX_PER_MM = 4;
+const double   NOISE_SIGMA       = 2.0; // Ruido del sensor en niveles de gris
+const int      MAX_POSE_ATTEMPTS = 200;
+
+// Umbrales de la prueba de regresión, con margen sobre lo que se obtiene con 30 vistas
+const double MAX_RMS_PX            = 0.5; // Error de reproyección de la resolución
+const double MAX_FOCAL_ERROR_PX    = 4.0; // |fx - fx real| y |fy - fy real|
+const double MAX_CENTER_ERROR_PX   = 4.0; // |cx - cx real| y |cy - cy real|
+const double MAX_CORRECTION_RMS_PX = 0.5;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct GroundTruth
+{
+  cv::Mat cameraMatrix;
+  cv::Mat distCoeffs;
+};
+
+GroundTruth makeGroundTruth()
+{
+  GroundTruth truth;
+  truth.cameraMatrix = (cv::Mat_<double>(3, 3) << 910.0, 0.0, 641.3, 0.0, 905.0, 357.8, 0.0, 0.0, 1.0);
+  truth.distCoeffs   = (cv::Mat_<double>(1, 5) << -0.28, 0.11, 0.0008, -0.0006, -0.02);
+  return truth;
+}
+
+/**
+ * @brief Textura del tablero: (ancho+1)x(alto+1) casillas y un margen blanco de una casilla.
+ * Se suaviza para que el remuestreo posterior no produzca aliasing en los bordes.
+ */
+cv::Mat renderBoardTexture()
+{
+  const int squarePx = static_cast<int>(SQUARE_SIZE * TEXTURE_PX_PER_MM);
+  const int cols     = BOARD_SIZE.width + 1;
+  const int rows     = BOARD_SIZE.height + 1;
+
+  cv::Mat texture((rows + 2) * squarePx, (cols + 2) * squarePx, CV_8UC1, cv::Scalar(255));
+  for (int r = 0; r < rows; ++r) {
+    for (int c = 0; c < cols; ++c) {
+      if ((r + c) % 2 == 0)
+        cv::rectangle(texture, cv::Rect((c + 1) * squarePx, (r + 1) * squarePx, squarePx, squarePx), cv::Scalar(0), cv::FILLED);
+    }
+  }
+  cv::GaussianBlur(texture, texture, cv::Size(0, 0), 0.6 * TEXTURE_PX_PER_MM);
+  return texture;
+}
+
+/**
+ * @brief Rayo normalizado (sin distorsión) de cada píxel de la imagen. Se calcula una vez y se
+ * reutiliza en todas las vistas: renderizar es intersecar esos rayos con el plano del tablero.
+ */
+cv::Mat pixelRays(const GroundTruth& truth)
+{
+  std::vector<cv::Point2f> pixels;
+  pixels.reserve(IMAGE_SIZE.area());
+  for (int v = 0; v < IMAGE_SIZE.height; ++v) {
+    for (int u = 0; u < IMAGE_SIZE.width; ++u)
+      pixels.emplace_back(static_cast<float>(u), static_cast<float>(v));
+  }
+
+  std::vector<cv::Point2f> rays;
+  cv::undistortPoints(pixels, rays, truth.cameraMatrix, truth.distCoeffs, cv::noArray(), cv::noArray(),
+                      cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 50, 1e-10));
+  return cv::Mat(rays, true).reshape(2, IMAGE_SIZE.height);
+}
+
+std::vector<cv::Point3f> boardOutline()
+{
+  // Borde exterior del tablero impreso (una casilla más allá de las esquinas interiores)
+  const float x0 = -SQUARE_SIZE, y0 = -SQUARE_SIZE;
+  const float x1 = BOARD_SIZE.width * SQUARE_SIZE, y1 = BOARD_SIZE.height * SQUARE_SIZE;
+  return {{x0, y0, 0}, {x1, y0, 0}, {x1, y1, 0}, {x0, y1, 0}};
+}
+
+/**
+ * @brief Pose aleatoria con el tablero completo dentro de la imagen.
+ */
+bool randomPose(std::mt19937& rng, const GroundTruth& truth, cv::Mat& rvec, cv::Mat& tvec)
+{
+  std::uniform_real_distribution<double> tilt(-0.6, 0.6);   // ~35º
+  std::uniform_real_distribution<double> roll(-0.35, 0.35); // ~20º
+  std::uniform_real_distribution<double> distance(380.0, 750.0);
+  std::uniform_real_distribution<double> offset(-0.35, 0.35);
+
+  const cv::Point3d boardCenter((BOARD_SIZE.width - 1) * SQUARE_SIZE / 2.0, (BOARD_SIZE.height - 1) * SQUARE_SIZE / 2.0, 0.0);
+  const std::vector<cv::Point3f> outline = boardOutline();
+  const double                   margin  = 10.0;
+
+  for (int attempt = 0; attempt < MAX_POSE_ATTEMPTS; ++attempt) {
+    cv::Mat R1, R2, R3;
+    cv::Rodrigues(cv::Vec3d(tilt(rng), 0, 0), R1);
+    cv::Rodrigues(cv::Vec3d(0, tilt(rng), 0), R2);
+    cv::Rodrigues(cv::Vec3d(0, 0, roll(rng)), R3);
+    cv::Mat R = R3 * R2 * R1;
+
+    // El centro del tablero cae en un punto aleatorio del campo de visión
+    double  z      = distance(rng);
+    cv::Mat center = (cv::Mat_<double>(3, 1) << offset(rng) * z, offset(rng) * z, z);
+    tvec           = center - R * cv::Mat(boardCenter);
+    cv::Rodrigues(R, rvec);
+
+    std::vector<cv::Point2f> projected;
+    cv::projectPoints(outline, rvec, tvec, truth.cameraMatrix, truth.distCoeffs, projected);
+
+    bool inside = true;
+    for (const cv::Point2f& pt : projected) {
+      inside = inside && pt.x > margin && pt.y > margin && pt.x < IMAGE_SIZE.width - margin && pt.y < IMAGE_SIZE.height - margin;
+    }
+    if (inside)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Renderiza una vista: cada rayo se lleva al plano del tablero con la homografía inversa
+ * [r1 r2 t]^-1 y se muestrea la textura en ese punto.
+ */
+cv::Mat renderView(const cv::Mat& texture, const cv::Mat& rays, const cv::Mat& rvec, const cv::Mat& tvec)
+{
+  cv::Matx33d R;
+  cv::Rodrigues(rvec, R);
+  cv::Matx33d H(R(0, 0), R(0, 1), tvec.at<double>(0), R(1, 0), R(1, 1), tvec.at<double>(1), R(2, 0), R(2, 1), tvec.at<double>(2));
+  cv::Matx33d Hinv = H.inv();
+
+  // La esquina interior (0,0) está a dos casillas del borde de la textura; -0.5 por el centro de píxel
+  const double originPx = 2.0 * SQUARE_SIZE * TEXTURE_PX_PER_MM;
+
+  cv::Mat mapX(IMAGE_SIZE, CV_32FC1), mapY(IMAGE_SIZE, CV_32FC1);
+  for (int v = 0; v < IMAGE_SIZE.height; ++v) {
+    const cv::Vec2f* ray = rays.ptr<cv::Vec2f>(v);
+    float*           mx  = mapX.ptr<float>(v);
+    float*           my  = mapY.ptr<float>(v);
+    for (int u = 0; u < IMAGE_SIZE.width; ++u) {
+      cv::Vec3d b = Hinv * cv::Vec3d(ray[u][0], ray[u][1], 1.0);
+      if (b[2] <= 0.0) {
+        mx[u] = my[u] = -1.0f; // Rayo que no corta el tablero por delante de la cámara
+        continue;
+      }
+      mx[u] = static_cast<float>((b[0] / b[2]) * TEXTURE_PX_PER_MM + originPx - 0.5);
+      my[u] = static_cast<float>((b[1] / b[2]) * TEXTURE_PX_PER_MM + originPx - 0.5);
+    }
+  }
+
+  cv::Mat view;
+  cv::remap(texture, view, mapX, mapY, cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar(128));
+
+  cv::Mat noise(view.size(), CV_16SC1);
+  cv::randn(noise, 0, NOISE_SIGMA);
+  cv::Mat noisy;
+  view.convertTo(noisy, CV_16SC1);
+  noisy += noise;
+  noisy.convertTo(view, CV_8UC1);
+  return view;
+}
+
+/**
+ * @brief Diferencia RMS, en píxeles, entre corregir la imagen con la calibración real y con la
+ * estimada, evaluada en una rejilla que cubre toda la imagen.
+ */
+double correctionError(const GroundTruth& truth, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs)
+{
+  std::vector<cv::Point2f> grid;
+  for (int v = 0; v <= 8; ++v) {
+    for (int u = 0; u <= 16; ++u)
+      grid.emplace_back(u * (IMAGE_SIZE.width - 1) / 16.0f, v * (IMAGE_SIZE.height - 1) / 8.0f);
+  }
+
+  std::vector<cv::Point2f> expected, estimated;
+  cv::undistortPoints(grid, expected, truth.cameraMatrix, truth.distCoeffs, cv::noArray(), truth.cameraMatrix);
+  cv::undistortPoints(grid, estimated, cameraMatrix, distCoeffs, cv::noArray(), truth.cameraMatrix);
+
+  double sum = 0.0;
+  for (size_t i = 0; i < grid.size(); ++i) {
+    cv::Point2f d = expected[i] - estimated[i];
+    sum += d.dot(d);
+  }
+  return std::sqrt(sum / grid.size());
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  const int      viewCount = argc > 1 ? std::atoi(argv[1]) : 30;
+  const unsigned seed      = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 42u;
+
+  std::mt19937 rng(seed);
+  cv::theRNG().state = seed;
+
+  const GroundTruth truth   = makeGroundTruth();
+  const cv::Mat     texture = renderBoardTexture();
+
+  // 1. Renderizado (no forma parte de la medida)
+  Clock::time_point start = Clock::now();
+  const cv::Mat     rays  = pixelRays(truth);
+
+  CalibrationTarget target = CalibrationTarget::defaults(CalibrationPattern::Chessboard);
+  target.boardSize         = BOARD_SIZE;
+  target.squareSize        = SQUARE_SIZE;
+
+  std::vector<cv::Mat>                  views;
+  std::vector<std::vector<cv::Point2f>> truthCorners;
+  CalibrationWorker                     worker;
+  const CalibrationTargetDetector       detector(target);
+  const std::vector<cv::Point3f>        boardPoints = target.objectPoints();
+  for (int i = 0; i < viewCount; ++i) {
+    cv::Mat rvec, tvec;
+    if (!randomPose(rng, truth, rvec, tvec)) {
+      std::fprintf(stderr, "No se encontró una pose válida para la vista %d\n", i);
+      return 1;
+    }
+    views.push_back(renderView(texture, rays, rvec, tvec));
+
+    std::vector<cv::Point2f> projected;
+    cv::projectPoints(boardPoints, rvec, tvec, truth.cameraMatrix, truth.distCoeffs, projected);
+    truthCorners.push_back(projected);
+  }
+  std::printf("Vistas sintéticas: %d (%dx%d, tablero %dx%d) renderizadas en %.0f ms\n", viewCount, IMAGE_SIZE.width, IMAGE_SIZE.height, BOARD_SIZE.width,
+              BOARD_SIZE.height, elapsedMs(start));
+
+  // 2. Detección de esquinas
+  std::vector<std::vector<cv::Point2f>> imagePoints;
+  std::vector<std::vector<cv::Point3f>> objectPoints;
+  QStringList                           viewNames;
+  double                                cornerErrorSum = 0.0;
+  size_t                                cornerCount    = 0;
+
+  start = Clock::now();
+  for (int i = 0; i < viewCount; ++i) {
+    std::vector<cv::Point2f> corners;
+    std::vector<int>         ids;
+    if (!worker.processImageForCorners(views[i], detector, corners, ids))
+      continue;
+
+    for (size_t k = 0; k < corners.size(); ++k)
+      cornerErrorSum += cv::norm(corners[k] - truthCorners[i][ids[k]]);
+    cornerCount += corners.size();
+
+    imagePoints.push_back(corners);
+    objectPoints.push_back(target.objectPoints(ids));
+    viewNames.append(QString("view_%1").arg(i));
+  }
+  const double detectMs = elapsedMs(start);
+
+  std::printf("Detección: %zu/%d vistas, %.1f imágenes/s (%.2f ms/imagen), error medio de esquina %.3f px\n", imagePoints.size(), viewCount,
+              1000.0 * viewCount / detectMs, detectMs / viewCount, cornerCount ? cornerErrorSum / cornerCount : 0.0);
+
+  // 3. Resolución
+  CalibrationResult result;
+  start = Clock::now();
+  const bool   calibrated = worker.runCalibration(IMAGE_SIZE, imagePoints, objectPoints, viewNames, result);
+  const double solveMs    = elapsedMs(start);
+
+  if (!calibrated) {
+    std::fprintf(stderr, "La calibración falló con %zu vistas detectadas\n", imagePoints.size());
+    return 1;
+  }
+
+  // 4. Precisión frente a la calibración real
+  const cv::Mat& K  = result.cameraMatrix;
+  const cv::Mat& Kt = truth.cameraMatrix;
+  std::printf("Resolución: %.1f ms, RMS %.4f px, %d vistas descartadas\n", solveMs, result.rms, result.rejectedCount);
+  const double dfx = K.at<double>(0, 0) - Kt.at<double>(0, 0), dfy = K.at<double>(1, 1) - Kt.at<double>(1, 1);
+  const double dcx = K.at<double>(0, 2) - Kt.at<double>(0, 2), dcy = K.at<double>(1, 2) - Kt.at<double>(1, 2);
+  std::printf("Error de intrínsecos: fx %+.3f px  fy %+.3f px  cx %+.3f px  cy %+.3f px\n", dfx, dfy, dcx, dcy);
+  const double correction = correctionError(truth, result.cameraMatrix, result.distCoeffs);
+  std::printf("Error de corrección sobre la imagen: %.4f px RMS\n", correction);
+
+  // 5. Umbrales
+  bool passed = true;
+  auto check  = [&passed](const char* name, double value, double limit) {
+    if (std::abs(value) <= limit)
+      return;
+    std::fprintf(stderr, "REGRESIÓN: %s = %.4f px supera el umbral de %.4f px\n", name, value, limit);
+    passed = false;
+  };
+  check("RMS", result.rms, MAX_RMS_PX);
+  check("error de fx", dfx, MAX_FOCAL_ERROR_PX);
+  check("error de fy", dfy, MAX_FOCAL_ERROR_PX);
+  check("error de cx", dcx, MAX_CENTER_ERROR_PX);
+  check("error de cy", dcy, MAX_CENTER_ERROR_PX);
+  check("error de corrección", correction, MAX_CORRECTION_RMS_PX);
+
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,366 @@
+/**
+ * @file SerialLinkBenchmark.cpp
+ * @brief Benchmark del enlace serie de extremo a extremo a través de SerialPortHandler.
+ * @details Usa la misma pila que la aplicación (hilo de E/S, planificador de poses, gestor de
+ * peticiones) contra el firmware real o contra robotSimulator, y para cada configuración mide:
+ *   - latencia de ida y vuelta de READ:OFFSETS una a una (p50, p90, p99 y máximo),
+ *   - peticiones por segundo con PIPELINE peticiones lanzadas a la vez,
+ *   - poses por segundo que llegan a salir cuando se generan a 1 kHz durante la fase sostenida,
+ *     cuántas se agrupan y qué parte de la capacidad del enlace ocupan,
+ *   - telemetría recibida por segundo y tiempo desde la llegada de los bytes hasta la señal
+ *     telemetryReceived (análisis y despacho en el hilo de E/S),
+ *   - pérdidas: peticiones reintentadas y fallidas, y tramas de telemetría que faltan según su
+ *     secuencia (solo en binario; en ASCII no hay forma de saberlo).
+ * El protocolo lo decide el firmware en la negociación; los baudios son los del puerto.
+ *
+ * Con --simulator se lanza robotSimulator para cada combinación de protocolo (ASCII y binario)
+ * y baudios de BAUD_RATES, así que la tabla completa sale sin hardware, por ejemplo en CI.
+ * Termina con código 1 si alguna petición falla, para poder usarlo como prueba de regresión.
+ *
+ * Uso: serialLinkBenchmark <puerto> [baudios=115200] [peticiones=200] [segundos=3]
+ *      serialLinkBenchmark --simulator <ruta de robotSimulator> [peticiones=200] [segundos=3]
+ */
+#include "SerialPortHandler.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QThread>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+const qint32 BAUD_RATES[]        = {9600, 57600, 115200, 921600};
+const int    PIPELINE            = 16;
+const int    POSE_RATE_HZ        = 1000;
+const int    SIMULATOR_REPORT_HZ = 50;
+const int    SIMULATOR_START_MS  = 3000;
+
+qint64 steadyNowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+double elapsedMs(Clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Rango más próximo sobre la muestra ya ordenada
+double percentile(const std::vector<double>& sorted, double p)
+{
+  if (sorted.empty())
+    return 0.0;
+  const size_t rank = size_t(std::ceil(p / 100.0 * double(sorted.size())));
+  return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+// Lo que llega por telemetryReceived, contado en el hilo de E/S
+class TelemetryProbe
+{
+public:
+  void record(const SerialProtocol::Telemetry& telemetry)
+  {
+    const qint64 now = steadyNowNs();
+    QMutexLocker locker(&m_mutex);
+    if (!m_counting)
+      return;
+    ++m_count;
+    m_parseUs.push_back(double(now - telemetry.receivedNs) / 1000.0);
+
+    // Cada trama AllServoAngles se reparte en seis entradas con la misma secuencia: se mira la primera.
+    // Solo los informes UNSOLICITED llevan un contador seguido; las respuestas repiten la del host
+    if (telemetry.sequence >= 0 && (telemetry.sequence & SerialProtocol::UNSOLICITED) && telemetry.servo == 1) {
+      if (m_lastSequence >= 0)
+        m_lostFrames += quint64((telemetry.sequence - m_lastSequence - 1) & SerialProtocol::SEQUENCE_MASK);
+      m_lastSequence = telemetry.sequence;
+      m_sequenced    = true;
+    }
+  }
+
+  void start()
+  {
+    QMutexLocker locker(&m_mutex);
+    m_counting     = true;
+    m_count        = 0;
+    m_lostFrames   = 0;
+    m_lastSequence = -1;
+    m_sequenced    = false;
+    m_parseUs.clear();
+  }
+
+  void stop()
+  {
+    QMutexLocker locker(&m_mutex);
+    m_counting = false;
+  }
+
+  quint64 count() const
+  {
+    QMutexLocker locker(&m_mutex);
+    return m_count;
+  }
+
+  quint64 lostFrames() const
+  {
+    QMutexLocker locker(&m_mutex);
+    return m_lostFrames;
+  }
+
+  bool sequenced() const
+  {
+    QMutexLocker locker(&m_mutex);
+    return m_sequenced;
+  }
+
+  std::vector<double> parseUs() const
+  {
+    QMutexLocker locker(&m_mutex);
+    return m_parseUs;
+  }
+
+private:
+  mutable QMutex      m_mutex;
+  bool                m_counting     = false;
+  quint64             m_count        = 0;
+  quint64             m_lostFrames   = 0;
+  int                 m_lastSequence = -1;
+  bool                m_sequenced    = false;
+  std::vector<double> m_parseUs;
+};
+
+struct Result
+{
+  QString protocol;
+  qint32  baudRate = 0;
+
+  std::vector<double> rttMs; // Ordenada
+  double              rtoMs         = 0.0;
+  double              pipelinedPerS = 0.0;
+  quint64             requests      = 0;
+  quint64             retries       = 0;
+  quint64             failures      = 0;
+
+  double  posesOfferedPerS = 0.0;
+  double  posesSentPerS    = 0.0;
+  double  coalescedRatio   = 0.0;
+  double  utilization      = 0.0;
+  double  telemetryPerS    = 0.0;
+  quint64 lostFrames       = 0;
+  bool    sequenced        = false;
+
+  std::vector<double> parseUs; // Ordenada
+};
+
+void countReply(const SerialReply& reply, Result& result)
+{
+  ++result.requests;
+  result.retries += quint64(std::max(0, reply.attempts - 1));
+  if (!reply.ok) {
+    ++result.failures;
+    std::fprintf(stderr, "  %s\n", qPrintable(reply.error));
+  }
+}
+
+bool runConfiguration(const QString& port, qint32 baudRate, int requestCount, double seconds, TelemetryProbe& probe, Result& result)
+{
+  SerialPortHandler& serial = SerialPortHandler::instance();
+  serial.configurePort(port, baudRate);
+  if (!serial.connectSerial()) {
+    std::fprintf(stderr, "No se pudo abrir %s a %d baudios\n", qPrintable(port), baudRate);
+    return false;
+  }
+  result.baudRate = baudRate;
+
+  SerialRequest request;
+  request.kind = SerialRequest::ReadOffsets;
+
+  // 1. Latencia: una petición detrás de otra (la primera espera además a la negociación)
+  for (int i = 0; i < requestCount; ++i) {
+    QFuture<SerialReply> future = serial.request(request);
+    future.waitForFinished();
+    const SerialReply reply = future.result();
+    countReply(reply, result);
+    if (reply.ok)
+      result.rttMs.push_back(reply.rttMs);
+  }
+  std::sort(result.rttMs.begin(), result.rttMs.end());
+  result.protocol = serial.protocolMode() == SerialProtocol::Mode::Binary ? "binario" : "ASCII";
+
+  // 2. Peticiones en cadena: PIPELINE en vuelo a la vez mientras el gestor lo permita
+  Clock::time_point start = Clock::now();
+  int               done  = 0;
+  while (done < requestCount) {
+    std::vector<QFuture<SerialReply>> batch;
+    for (int i = 0; i < PIPELINE && done + i < requestCount; ++i)
+      batch.push_back(serial.request(request));
+    for (QFuture<SerialReply>& future : batch) {
+      future.waitForFinished();
+      countReply(future.result(), result);
+    }
+    done += int(batch.size());
+  }
+  result.pipelinedPerS = requestCount / (elapsedMs(start) / 1000.0);
+
+  // 3. Fase sostenida: poses a POSE_RATE_HZ con las seis articulaciones cambiando
+  // Las estadísticas del enlace se publican una vez por segundo: se espera una publicación a cada lado
+  QThread::msleep(SerialIoWorker::STATS_INTERVAL_MS + 100);
+  const SerialLinkStats before = serial.linkStats();
+  probe.start();
+
+  const auto   period  = std::chrono::nanoseconds(1000000000 / POSE_RATE_HZ);
+  auto         next    = Clock::now();
+  const auto   end     = next + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+  quint64      offered = 0;
+  QVector<int> angles(SerialProtocol::SERVO_COUNT);
+  while (Clock::now() < end) {
+    const double t = double(offered) / POSE_RATE_HZ;
+    for (int i = 0; i < angles.size(); ++i)
+      angles[i] = 90 + int(std::lround(45.0 * std::sin(2.0 * M_PI * 0.5 * t + i)));
+    serial.sendServoAngles(angles, (1 << SerialProtocol::SERVO_COUNT) - 1);
+    ++offered;
+    next += period;
+    std::this_thread::sleep_until(next);
+  }
+
+  QThread::msleep(SerialIoWorker::STATS_INTERVAL_MS + 100);
+  probe.stop();
+  const SerialLinkStats after = serial.linkStats();
+
+  const quint64 flushes   = after.poseFlushes - before.poseFlushes;
+  const quint64 updates   = after.servoUpdates - before.servoUpdates;
+  result.posesOfferedPerS = offered / seconds;
+  result.posesSentPerS    = flushes / seconds;
+  result.coalescedRatio   = updates ? double(updates - std::min(updates, flushes)) / double(updates) : 0.0;
+  result.utilization      = double(after.bytesSent - before.bytesSent) / (baudRate / 10.0 * seconds);
+  result.telemetryPerS    = probe.count() / seconds;
+  result.lostFrames       = probe.lostFrames();
+  result.sequenced        = probe.sequenced();
+  result.parseUs          = probe.parseUs();
+  result.rtoMs            = serial.roundTripStats().timeoutMs;
+  std::sort(result.parseUs.begin(), result.parseUs.end());
+
+  serial.disconnectSerial();
+  return true;
+}
+
+void report(const Result& r)
+{
+  std::printf("%-7s %7d baudios\n", qPrintable(r.protocol), r.baudRate);
+  std::printf("  RTT READ:OFFSETS     p50 %7.2f  p90 %7.2f  p99 %7.2f  máx %7.2f ms  (%zu respuestas)\n", percentile(r.rttMs, 50),
+              percentile(r.rttMs, 90), percentile(r.rttMs, 99), r.rttMs.empty() ? 0.0 : r.rttMs.back(), r.rttMs.size());
+  std::printf("  Tiempo límite        %8.1f ms, calculado a partir del RTT\n", r.rtoMs);
+  std::printf("  En cadena (%2d)       %8.1f peticiones/s\n", PIPELINE, r.pipelinedPerS);
+  std::printf("  Poses                %8.1f/s enviadas de %.0f/s generadas, %.1f%% agrupadas, enlace al %.0f%%\n", r.posesSentPerS,
+              r.posesOfferedPerS, r.coalescedRatio * 100.0, r.utilization * 100.0);
+  std::printf("  Telemetría           %8.1f/s, análisis p50 %.1f  p99 %.1f µs\n", r.telemetryPerS, percentile(r.parseUs, 50),
+              percentile(r.parseUs, 99));
+  if (r.sequenced)
+    std::printf("  Pérdidas             %llu reintentos, %llu fallidas de %llu peticiones, %llu tramas de telemetría perdidas\n",
+                (unsigned long long)r.retries, (unsigned long long)r.failures, (unsigned long long)r.requests, (unsigned long long)r.lostFrames);
+  else
+    std::printf("  Pérdidas             %llu reintentos, %llu fallidas de %llu peticiones\n", (unsigned long long)r.retries,
+                (unsigned long long)r.failures, (unsigned long long)r.requests);
+}
+
+// robotSimulator en un pty enlazado a una ruta fija; devuelve false si no llega a arrancar
+bool startSimulator(QProcess& simulator, const QString& path, const QString& link, qint32 baudRate, bool binary)
+{
+  QFile::remove(link);
+  simulator.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+  simulator.start(path, {"--link", link, "--baud", QString::number(baudRate), "--protocol", binary ? "binary" : "ascii", "--report-hz",
+                         QString::number(SIMULATOR_REPORT_HZ)});
+  // La primera línea que imprime es la ruta del puerto, cuando el enlace ya existe
+  if (!simulator.waitForStarted(SIMULATOR_START_MS) || !simulator.waitForReadyRead(SIMULATOR_START_MS)) {
+    std::fprintf(stderr, "No se pudo arrancar %s\n", qPrintable(path));
+    return false;
+  }
+  simulator.readAllStandardOutput();
+  return true;
+}
+
+void stopSimulator(QProcess& simulator)
+{
+  simulator.terminate();
+  if (!simulator.waitForFinished(SIMULATOR_START_MS))
+    simulator.kill();
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  QCoreApplication app(argc, argv);
+
+  if (argc < 2) {
+    std::fprintf(stderr, "Uso: %s <puerto> [baudios=115200] [peticiones=200] [segundos=3]\n"
+                         "     %s --simulator <ruta de robotSimulator> [peticiones=200] [segundos=3]\n",
+                 argv[0], argv[0]);
+    return 1;
+  }
+  const bool useSimulator = QString(argv[1]) == "--simulator";
+  if (useSimulator && argc < 3) {
+    std::fprintf(stderr, "Falta la ruta de robotSimulator\n");
+    return 1;
+  }
+  // Con --simulator no hay baudios: se recorren los de BAUD_RATES
+  int          next         = useSimulator ? 3 : 2;
+  const qint32 baudRate     = !useSimulator && argc > next ? std::atoi(argv[next++]) : 115200;
+  const int    requestCount = argc > next ? std::atoi(argv[next++]) : 200;
+  const double seconds      = argc > next ? std::atof(argv[next++]) : 3.0;
+  if (baudRate <= 0 || requestCount <= 0 || seconds <= 0.0) {
+    std::fprintf(stderr, "Baudios, peticiones y segundos deben ser positivos\n");
+    return 1;
+  }
+
+  // Todo se cuenta en el hilo de E/S, sin pasar por un bucle de eventos
+  SerialPortHandler& serial = SerialPortHandler::instance();
+  TelemetryProbe     probe;
+  QObject::connect(
+    &serial, &SerialPortHandler::telemetryReceived, &serial, [&probe](const SerialProtocol::Telemetry& telemetry) { probe.record(telemetry); },
+    Qt::DirectConnection);
+  QObject::connect(
+    &serial, &SerialPortHandler::errorOccurred, &serial, [](const QString& error) { std::fprintf(stderr, "  %s\n", qPrintable(error)); },
+    Qt::DirectConnection);
+
+  std::vector<Result> results;
+  if (!useSimulator) {
+    Result result;
+    if (!runConfiguration(QString::fromLocal8Bit(argv[1]), baudRate, requestCount, seconds, probe, result))
+      return 1;
+    results.push_back(result);
+  }
+  else {
+    const QString simulatorPath = QString::fromLocal8Bit(argv[2]);
+    const QString link          = QDir::tempPath() + "/robotarm-benchmark-" + QString::number(QCoreApplication::applicationPid());
+    for (bool binary : {false, true}) {
+      for (qint32 baud : BAUD_RATES) {
+        QProcess simulator;
+        if (!startSimulator(simulator, simulatorPath, link, baud, binary))
+          return 1;
+        Result     result;
+        const bool ok = runConfiguration(link, baud, requestCount, seconds, probe, result);
+        stopSimulator(simulator);
+        if (!ok)
+          return 1;
+        results.push_back(result);
+      }
+    }
+  }
+
+  bool failed = false;
+  for (const Result& result : results) {
+    report(result);
+    failed = failed || result.failures > 0;
+  }
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,207 @@
+/**
+ * @file SerialParserBenchmark.cpp
+ * @brief Benchmark del análisis de las líneas del firmware, sin puerto serie.
+ * @details Reproduce tráfico grabado (o, sin fichero, uno sintético con la misma mezcla que
+ * envía el firmware: ANGLE_WITH_OFFSET de los seis servos, OFFSET tras READ:OFFSETS, mensajes
+ * de depuración y finales \r\n) troceado en lecturas de 1 a 64 bytes como las de un adaptador
+ * USB-serie, y lo pasa por dos caminos:
+ *   - el anterior: QByteArray por línea, ida y vuelta por QString y dos sscanf,
+ *   - SerialLineParser: anillo fijo, búsqueda incremental del '\n' y switch sobre el prefijo.
+ * Mide MB/s, líneas/s y ns por línea de cada uno y comprueba que los dos sacan los mismos
+ * eventos; termina con código 1 si no coinciden, para poder usarlo como prueba de regresión.
+ *
+ * Uso: serialParserBenchmark [captura=""] [MB=32] [semilla=42]
+ * La captura es el volcado en bruto de lo recibido por el puerto (p. ej. cat /dev/ttyUSB0 > captura.txt).
+ */
+#include "SerialLineParser.h"
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+const int MIN_READ = 1;
+const int MAX_READ = 64;
+
+double elapsedMs(Clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Summary
+{
+  quint64 lines   = 0;
+  quint64 angles  = 0;
+  quint64 offsets = 0;
+  qint64  sum     = 0; // Suma ponderada de servo y valor, para comparar los dos caminos
+};
+
+QByteArray syntheticTraffic(qint64 bytes, std::mt19937& rng)
+{
+  std::uniform_int_distribution<int> angle(0, 180);
+  std::uniform_int_distribution<int> offset(-20, 20);
+  std::uniform_int_distribution<int> kind(0, 99);
+
+  QByteArray traffic;
+  traffic.reserve(int(bytes + 128));
+  while (traffic.size() < bytes) {
+    const int k = kind(rng);
+    if (k < 85) {
+      for (int servo = 1; servo <= 6; ++servo)
+        traffic += "ANGLE_WITH_OFFSET:SERVO" + QByteArray::number(servo) + ':' + QByteArray::number(angle(rng)) + "\r\n";
+    }
+    else if (k < 95) {
+      for (int servo = 1; servo <= 6; ++servo)
+        traffic += "OFFSET:SERVO" + QByteArray::number(servo) + ':' + QByteArray::number(offset(rng)) + "\r\n";
+    }
+    else {
+      traffic += "Servo " + QByteArray::number(1 + k % 6) + " moving to target\r\n";
+    }
+  }
+  return traffic;
+}
+
+// Tamaños de lectura fijados de antemano para que los dos caminos vean los mismos trozos
+std::vector<int> readSizes(int total, std::mt19937& rng)
+{
+  std::uniform_int_distribution<int> size(MIN_READ, MAX_READ);
+  std::vector<int>                   sizes;
+  for (int done = 0; done < total;) {
+    sizes.push_back(std::min(size(rng), total - done));
+    done += sizes.back();
+  }
+  return sizes;
+}
+
+Summary legacyParse(const QByteArray& traffic, const std::vector<int>& sizes)
+{
+  Summary    summary;
+  QByteArray buffer;
+  int        offset = 0;
+  for (int size : sizes) {
+    buffer.append(traffic.constData() + offset, size);
+    offset += size;
+
+    // Como QSerialPort::canReadLine/readLine: una QByteArray por línea
+    int newline;
+    while ((newline = buffer.indexOf('\n')) >= 0) {
+      const QByteArray data = buffer.left(newline + 1);
+      buffer.remove(0, newline + 1);
+
+      // Como el antiguo RobotHandler::onDataReceived
+      const QString msg      = QString::fromUtf8(data).trimmed();
+      int           servoNum = 0, valor = 0;
+      ++summary.lines;
+      // El rango del servo lo validaba después; aquí se exige igual para comparar
+      if (sscanf(msg.toUtf8().constData(), "ANGLE_WITH_OFFSET:SERVO%d:%d", &servoNum, &valor) == 2 && servoNum >= 1 && servoNum <= 6) {
+        ++summary.angles;
+        summary.sum += servoNum * 1000 + valor;
+      }
+      else if (sscanf(msg.toUtf8().constData(), "OFFSET:SERVO%d:%d", &servoNum, &valor) == 2 && servoNum >= 1 && servoNum <= 6) {
+        ++summary.offsets;
+        summary.sum -= servoNum * 1000 + valor;
+      }
+    }
+  }
+  return summary;
+}
+
+Summary ringParse(const QByteArray& traffic, const std::vector<int>& sizes, SerialLineParser& parser)
+{
+  Summary                 summary;
+  SerialLineParser::Event event;
+  int                     offset = 0;
+  for (int size : sizes) {
+    parser.write(traffic.constData() + offset, size);
+    offset += size;
+
+    while (parser.next(event)) {
+      ++summary.lines;
+      switch (event.type) {
+        case SerialLineParser::Event::AngleWithOffset:
+          ++summary.angles;
+          summary.sum += event.servo * 1000 + event.value;
+          break;
+        case SerialLineParser::Event::Offset:
+          ++summary.offsets;
+          summary.sum -= event.servo * 1000 + event.value;
+          break;
+        default:
+          break;
+      }
+    }
+  }
+  return summary;
+}
+
+void report(const char* name, const Summary& summary, qint64 bytes, double ms)
+{
+  std::printf("%-16s %8.1f MB/s  %10.0f líneas/s  %7.1f ns/línea  (%llu ángulos, %llu offsets)\n", name, bytes / 1e6 / (ms / 1000.0),
+              summary.lines / (ms / 1000.0), ms * 1e6 / double(summary.lines ? summary.lines : 1), (unsigned long long)summary.angles,
+              (unsigned long long)summary.offsets);
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  const QString  capturePath = argc > 1 ? QString::fromLocal8Bit(argv[1]) : QString();
+  const int      megabytes   = argc > 2 ? std::atoi(argv[2]) : 32;
+  const unsigned seed        = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : 42u;
+
+  std::mt19937 rng(seed);
+
+  // 1. Tráfico: la captura se repite hasta el tamaño pedido (no forma parte de la medida)
+  QByteArray traffic;
+  if (!capturePath.isEmpty()) {
+    QFile file(capturePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+      std::fprintf(stderr, "No se pudo abrir la captura %s\n", argv[1]);
+      return 1;
+    }
+    const QByteArray capture = file.readAll();
+    if (capture.isEmpty()) {
+      std::fprintf(stderr, "La captura %s está vacía\n", argv[1]);
+      return 1;
+    }
+    while (traffic.size() < qint64(megabytes) * 1000000)
+      traffic += capture;
+  }
+  else {
+    traffic = syntheticTraffic(qint64(megabytes) * 1000000, rng);
+  }
+  const std::vector<int> sizes = readSizes(traffic.size(), rng);
+  std::printf("Tráfico: %.1f MB en %zu lecturas de %d a %d bytes (%s)\n", traffic.size() / 1e6, sizes.size(), MIN_READ, MAX_READ,
+              capturePath.isEmpty() ? "sintético" : argv[1]);
+
+  // 2. Camino anterior
+  Clock::time_point start    = Clock::now();
+  const Summary     legacy   = legacyParse(traffic, sizes);
+  const double      legacyMs = elapsedMs(start);
+
+  // 3. SerialLineParser (el anillo va en el heap: CAPACITY bytes no tienen por qué caber en la pila)
+  std::unique_ptr<SerialLineParser> parser(new SerialLineParser());
+  start               = Clock::now();
+  const Summary ring   = ringParse(traffic, sizes, *parser);
+  const double  ringMs = elapsedMs(start);
+
+  report("Anterior", legacy, traffic.size(), legacyMs);
+  report("SerialLineParser", ring, traffic.size(), ringMs);
+  std::printf("Aceleración: x%.1f, %llu líneas descartadas por largas\n", legacyMs / ringMs, (unsigned long long)parser->overflows());
+
+  // 4. Los dos caminos deben ver los mismos mensajes (las líneas vacías solo las cuenta el anterior)
+  if (legacy.angles != ring.angles || legacy.offsets != ring.offsets || legacy.sum != ring.sum) {
+    std::fprintf(stderr, "Los resultados no coinciden: %llu/%llu ángulos, %llu/%llu offsets\n", (unsigned long long)legacy.angles,
+                 (unsigned long long)ring.angles, (unsigned long long)legacy.offsets, (unsigned long long)ring.offsets);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,409 @@
+#include "IkLookupTable.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+const int    CELL_FLOATS       = 4;    // q1, q2, q3, q5
+const qint64 BLOB_ALIGNMENT    = 64;
+const double BRANCH_TOLERANCE  = 20.0; // Grados: vecinas más separadas son soluciones de ramas distintas
+const int    BUILD_ITERATIONS  = 60;
+const double BUILD_TOLERANCE   = 0.05; // mm
+const int    ACTIVE_JOINTS[4]  = {0, 1, 2, 4};
+const double SEED_FRACTIONS[3] = {0.25, 0.5, 0.75};
+
+struct FileHeader
+{
+  quint32 magic;
+  quint32 version;
+  double  geometry[4];
+  double  limitsMin[6];
+  double  limitsMax[6];
+  double  origin[3];
+  double  spacing;
+  qint32  dims[3];
+  quint32 reserved;
+};
+
+static_assert(sizeof(FileHeader) % 8 == 0, "FileHeader alineado a 8");
+
+qint64 cellsOffset()
+{
+  return (qint64(sizeof(FileHeader)) + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT;
+}
+
+void fillHeader(FileHeader& header, const RobotGeometry& geometry, const JointLimits& limits, const IkLookupTable::Grid& grid)
+{
+  std::memset(&header, 0, sizeof(header));
+  header.magic       = IkLookupTable::MAGIC;
+  header.version     = IkLookupTable::VERSION;
+  header.geometry[0] = geometry.a1;
+  header.geometry[1] = geometry.a2;
+  header.geometry[2] = geometry.a3;
+  header.geometry[3] = geometry.a5;
+  for (int i = 0; i < 6; ++i) {
+    header.limitsMin[i] = limits.min[i];
+    header.limitsMax[i] = limits.max[i];
+  }
+  header.origin[0] = grid.origin.x;
+  header.origin[1] = grid.origin.y;
+  header.origin[2] = grid.origin.z;
+  header.spacing   = grid.spacing;
+  header.dims[0]   = grid.dims[0];
+  header.dims[1]   = grid.dims[1];
+  header.dims[2]   = grid.dims[2];
+}
+
+bool isReachable(const float* cell)
+{
+  return !std::isnan(cell[0]);
+}
+
+bool isOtherBranch(const float* a, const float* b)
+{
+  for (int k = 0; k < CELL_FLOATS; ++k) {
+    if (std::abs(a[k] - b[k]) > BRANCH_TOLERANCE)
+      return true;
+  }
+  return false;
+}
+
+void storeCell(float* cell, const JointAngles& q)
+{
+  for (int k = 0; k < CELL_FLOATS; ++k)
+    cell[k] = static_cast<float>(q[ACTIVE_JOINTS[k]]);
+}
+
+bool trySeed(const IkTarget& target, const JointAngles& seed, const JointLimits& limits, const RobotGeometry& geometry, const IkOptions& options,
+             JointAngles& solution)
+{
+  const IkResult result = RobotKinematics::solveInverse(target, seed, limits, geometry, options);
+  if (!result.converged)
+    return false;
+  solution = result.angles;
+  return true;
+}
+
+/**
+ * @brief Resuelve una capa z de la rejilla. Cada celda parte de la solución de su vecina en x
+ * (o de la fila anterior) para que las soluciones contiguas sean de la misma rama y se puedan
+ * interpolar; solo si eso falla se prueba con semillas repartidas por los límites.
+ */
+void buildSlice(int z, const RobotGeometry& geometry, const JointLimits& limits, const IkLookupTable::Grid& grid, float* cells)
+{
+  IkOptions options;
+  options.maxIterations = BUILD_ITERATIONS;
+  options.tolerance     = BUILD_TOLERANCE;
+
+  const double      reach = geometry.a2 + geometry.a3 + geometry.a5;
+  const cv::Point3d shoulder(0, 0, geometry.a1);
+
+  JointAngles rowStart{};
+  bool        hasRowStart = false;
+
+  for (int y = 0; y < grid.dims[1]; ++y) {
+    JointAngles previous{};
+    bool        hasPrevious = false;
+
+    for (int x = 0; x < grid.dims[0]; ++x) {
+      float* cell = cells + ((size_t(y) * grid.dims[0] + x) * CELL_FLOATS);
+      std::fill(cell, cell + CELL_FLOATS, std::numeric_limits<float>::quiet_NaN());
+
+      IkTarget target;
+      target.position = grid.origin + cv::Point3d(x, y, z) * grid.spacing;
+      if (cv::norm(target.position - shoulder) > reach)
+        continue; // Fuera de la esfera de alcance: ni se intenta
+
+      JointAngles solution;
+      bool        solved = (hasPrevious && trySeed(target, previous, limits, geometry, options, solution)) ||
+                    (x == 0 && hasRowStart && trySeed(target, rowStart, limits, geometry, options, solution));
+
+      if (!solved) {
+        // q1 apunta al objetivo (o al lado opuesto, con el brazo echado hacia atrás); q2 y q3
+        // recorren su rango y el resto queda a mitad de recorrido
+        const double azimuth  = std::atan2(target.position.y, target.position.x) * 180.0 / M_PI;
+        const double bases[3] = {azimuth, azimuth + 180.0, azimuth - 180.0};
+        for (int b = 0; b < 3 && !solved; ++b) {
+          if (b > 0 && (bases[b] < limits.min[0] || bases[b] > limits.max[0]))
+            continue;
+          for (int i = 0; i < 9 && !solved; ++i) {
+            JointAngles seed;
+            for (size_t j = 0; j < seed.size(); ++j)
+              seed[j] = 0.5 * (limits.min[j] + limits.max[j]);
+            seed[0] = bases[b];
+            seed[1] = limits.min[1] + SEED_FRACTIONS[i / 3] * (limits.max[1] - limits.min[1]);
+            seed[2] = limits.min[2] + SEED_FRACTIONS[i % 3] * (limits.max[2] - limits.min[2]);
+            solved  = trySeed(target, seed, limits, geometry, options, solution);
+          }
+        }
+      }
+
+      hasPrevious = solved;
+      if (!solved)
+        continue;
+
+      previous = solution;
+      storeCell(cell, solution);
+      if (x == 0 || !hasRowStart) {
+        rowStart    = solution;
+        hasRowStart = true;
+      }
+    }
+  }
+}
+} // namespace
+
+IkLookupTable::Grid IkLookupTable::Grid::forGeometry(const RobotGeometry& geometry, double spacing)
+{
+  const double reach = geometry.a2 + geometry.a3 + geometry.a5;
+
+  Grid grid;
+  grid.spacing = spacing;
+  grid.origin  = cv::Point3d(-reach, -reach, geometry.a1 - reach);
+
+  const int horizontal = static_cast<int>(std::ceil(2.0 * reach / spacing)) + 1;
+  const int vertical   = static_cast<int>(std::ceil((geometry.a1 + reach - grid.origin.z) / spacing)) + 1;
+  grid.dims            = cv::Vec3i(horizontal, horizontal, vertical);
+  return grid;
+}
+
+size_t IkLookupTable::Grid::pointCount() const
+{
+  return size_t(dims[0]) * dims[1] * dims[2];
+}
+
+bool IkLookupTable::Grid::operator==(const Grid& other) const
+{
+  return origin == other.origin && spacing == other.spacing && dims == other.dims;
+}
+
+IkLookupTable::~IkLookupTable() = default;
+
+std::shared_ptr<const IkLookupTable> IkLookupTable::load(const QString& filePath, const RobotGeometry& geometry, const JointLimits& limits,
+                                                         const Grid& grid)
+{
+  auto file = std::make_unique<QFile>(filePath);
+  if (!file->open(QIODevice::ReadOnly))
+    return nullptr;
+
+  const qint64 expectedSize = cellsOffset() + qint64(grid.pointCount() * CELL_FLOATS * sizeof(float));
+  if (file->size() != expectedSize)
+    return nullptr;
+
+  const uchar* base = file->map(0, expectedSize);
+  if (!base)
+    return nullptr;
+
+  // Se compara la cabecera completa: otra geometría, otros límites u otra rejilla invalidan la tabla
+  FileHeader expected;
+  fillHeader(expected, geometry, limits, grid);
+  if (std::memcmp(base, &expected, sizeof(FileHeader)) != 0)
+    return nullptr;
+
+  std::shared_ptr<IkLookupTable> table(new IkLookupTable());
+  table->m_geometry = geometry;
+  table->m_limits   = limits;
+  table->m_grid     = grid;
+  table->m_cells    = reinterpret_cast<const float*>(base + cellsOffset());
+  table->m_file     = std::move(file);
+  return table;
+}
+
+/**
+ * @brief Genera la tabla resolviendo cada punto de la rejilla, una capa z por tarea.
+ * @details Con la rejilla por defecto (10 mm) son unos 450.000 puntos, de los que se resuelven
+ * los que quedan dentro del alcance; tarda de segundos a medio minuto según los núcleos, así que
+ * se ejecuta fuera del hilo de la interfaz. cancelled se consulta antes de cada capa.
+ */
+std::shared_ptr<const IkLookupTable> IkLookupTable::build(const RobotGeometry& geometry, const JointLimits& limits, const Grid& grid,
+                                                          const std::function<bool()>& cancelled)
+{
+  std::shared_ptr<IkLookupTable> table(new IkLookupTable());
+  table->m_geometry = geometry;
+  table->m_limits   = limits;
+  table->m_grid     = grid;
+  table->m_ownedCells.resize(grid.pointCount() * CELL_FLOATS);
+
+  const size_t sliceFloats = size_t(grid.dims[0]) * grid.dims[1] * CELL_FLOATS;
+  float*       cells       = table->m_ownedCells.data();
+
+  QThreadPool pool;
+  for (int z = 0; z < grid.dims[2]; ++z) {
+    pool.start([z, &geometry, &limits, &grid, &cancelled, cells, sliceFloats]() {
+      if (!cancelled || !cancelled())
+        buildSlice(z, geometry, limits, grid, cells + z * sliceFloats);
+    });
+  }
+  pool.waitForDone();
+  if (cancelled && cancelled())
+    return nullptr;
+
+  table->m_cells = table->m_ownedCells.data();
+  return table;
+}
+
+bool IkLookupTable::save(const QString& filePath) const
+{
+  QDir().mkpath(QFileInfo(filePath).absolutePath());
+
+  FileHeader header;
+  fillHeader(header, m_geometry, m_limits, m_grid);
+
+  QSaveFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(QByteArray(int(cellsOffset() - file.pos()), '\0'));
+  file.write(reinterpret_cast<const char*>(m_cells), qint64(m_grid.pointCount() * CELL_FLOATS * sizeof(float)));
+
+  if (!file.commit()) {
+    qWarning() << "No se pudo guardar la tabla de cinemática inversa:" << file.errorString();
+    return false;
+  }
+  return true;
+}
+
+const float* IkLookupTable::cell(int x, int y, int z) const
+{
+  return m_cells + ((size_t(z) * m_grid.dims[1] + y) * m_grid.dims[0] + x) * CELL_FLOATS;
+}
+
+/**
+ * @brief Las ocho celdas que rodean la posición y sus pesos trilineales.
+ * @return Índice de la celda alcanzable con más peso, o -1 si no hay ninguna o la posición
+ * cae fuera de la rejilla.
+ */
+int IkLookupTable::neighbours(const cv::Point3d& position, const float* corners[8], double weights[8]) const
+{
+  const cv::Point3d g = (position - m_grid.origin) * (1.0 / m_grid.spacing);
+  if (g.x < 0 || g.y < 0 || g.z < 0 || g.x > m_grid.dims[0] - 1 || g.y > m_grid.dims[1] - 1 || g.z > m_grid.dims[2] - 1)
+    return -1;
+
+  const int    x0 = std::min(static_cast<int>(g.x), m_grid.dims[0] - 2);
+  const int    y0 = std::min(static_cast<int>(g.y), m_grid.dims[1] - 2);
+  const int    z0 = std::min(static_cast<int>(g.z), m_grid.dims[2] - 2);
+  const double fx = g.x - x0;
+  const double fy = g.y - y0;
+  const double fz = g.z - z0;
+
+  int nearest = -1;
+  for (int i = 0; i < 8; ++i) {
+    const int dx = i & 1;
+    const int dy = (i >> 1) & 1;
+    const int dz = (i >> 2) & 1;
+    corners[i]   = cell(x0 + dx, y0 + dy, z0 + dz);
+    weights[i]   = (dx ? fx : 1 - fx) * (dy ? fy : 1 - fy) * (dz ? fz : 1 - fz);
+    if (isReachable(corners[i]) && (nearest < 0 || weights[i] > weights[nearest]))
+      nearest = i;
+  }
+  return nearest;
+}
+
+/**
+ * @brief Interpolación trilineal entre las celdas alcanzables de alrededor, con los pesos
+ * renormalizados. Si las vecinas pertenecen a ramas distintas (una diferencia grande en alguna
+ * articulación) la media no tiene sentido y se usa la más cercana.
+ */
+bool IkLookupTable::seedFor(const cv::Point3d& position, JointAngles& seed) const
+{
+  const float* corners[8];
+  double       weights[8];
+  const int    nearest = neighbours(position, corners, weights);
+  if (nearest < 0)
+    return false;
+
+  double sum[CELL_FLOATS] = {0, 0, 0, 0};
+  double totalWeight      = 0.0;
+  bool   sameBranch       = true;
+  for (int i = 0; i < 8 && sameBranch; ++i) {
+    if (!isReachable(corners[i]))
+      continue;
+    sameBranch = !isOtherBranch(corners[i], corners[nearest]);
+    for (int k = 0; k < CELL_FLOATS; ++k)
+      sum[k] += weights[i] * corners[i][k];
+    totalWeight += weights[i];
+  }
+
+  for (int k = 0; k < CELL_FLOATS; ++k)
+    seed[ACTIVE_JOINTS[k]] = sameBranch ? sum[k] / totalWeight : corners[nearest][k];
+  return true;
+}
+
+/**
+ * @brief Pule la semilla interpolada. Junto a la frontera entre dos ramas (p. ej. q1 = 0 y
+ * q1 = 180 con el brazo hacia atrás) puede que la rama de la semilla no llegue al objetivo sin
+ * salirse de los límites; entonces se prueba una vez con cada rama distinta de las vecinas. El
+ * coste queda acotado por 8 * POLISH_ITERATIONS iteraciones.
+ */
+IkResult IkLookupTable::solve(const IkTarget& target, const JointAngles& rest) const
+{
+  IkResult     best;
+  const float* corners[8];
+  double       weights[8];
+  const int    nearest = neighbours(target.position, corners, weights);
+  if (nearest < 0) {
+    best.angles   = m_limits.clamp(rest);
+    best.residual = std::numeric_limits<double>::infinity();
+    return best; // Fuera de la rejilla o sin celdas alcanzables cerca
+  }
+
+  IkOptions options;
+  options.maxIterations = POLISH_ITERATIONS;
+
+  JointAngles seed = rest;
+  seedFor(target.position, seed);
+  best = RobotKinematics::solveInverse(target, seed, m_limits, m_geometry, options);
+
+  const float* tried[8];
+  int          triedCount = 0;
+  for (int i = 0; i < 8 && !best.converged; ++i) {
+    if (!isReachable(corners[i]) || !isOtherBranch(corners[i], corners[nearest]))
+      continue;
+    if (std::any_of(tried, tried + triedCount, [&](const float* other) { return !isOtherBranch(corners[i], other); }))
+      continue;
+    tried[triedCount++] = corners[i];
+
+    JointAngles branchSeed = rest;
+    for (int k = 0; k < CELL_FLOATS; ++k)
+      branchSeed[ACTIVE_JOINTS[k]] = corners[i][k];
+
+    const IkResult result = RobotKinematics::solveInverse(target, branchSeed, m_limits, m_geometry, options);
+    const int      iterations = best.iterations + result.iterations;
+    if (result.converged || result.residual < best.residual)
+      best = result;
+    best.iterations = iterations;
+  }
+  return best;
+}
+
+const RobotGeometry& IkLookupTable::geometry() const
+{
+  return m_geometry;
+}
+
+const JointLimits& IkLookupTable::limits() const
+{
+  return m_limits;
+}
+
+const IkLookupTable::Grid& IkLookupTable::grid() const
+{
+  return m_grid;
+}
+
+size_t IkLookupTable::reachableCount() const
+{
+  size_t count = 0;
+  for (size_t i = 0; i < m_grid.pointCount(); ++i)
+    count += isReachable(m_cells + i * CELL_FLOATS) ? 1 : 0;
+  return count;
+}
@@ -0,0 +1,79 @@
+#ifndef IKLOOKUPTABLE_H
+#define IKLOOKUPTABLE_H
+
+#include "RobotInverseKinematics.h"
+#include "RobotKinematics.h"
+#include <QString>
+#include <functional>
+#include <memory>
+#include <opencv2/core.hpp>
+#include <vector>
+
+class QFile;
+
+/**
+ * @brief Tabla de cinemática inversa precalculada sobre una rejilla 3D del volumen de trabajo.
+ * @details Cada celda guarda q1, q2, q3 y q5 de una solución que respeta los límites (NaN si el
+ * punto no es alcanzable). Una consulta interpola la semilla de las ocho celdas vecinas y la
+ * pule con unas pocas iteraciones del solver, así que su coste no depende de lo lejos que esté
+ * la pose actual. Se guarda en un fichero que se abre con QFile::map y lleva la geometría y los
+ * límites con los que se generó; si cualquiera de ellos cambia, la tabla se descarta y se
+ * vuelve a generar.
+ *
+ * Formato (orden de bytes nativo, versión 1):
+ *   FileHeader | celdas alineadas a 64 bytes, float[4] por celda, x varía más rápido
+ */
+class IkLookupTable
+{
+public:
+  struct Grid
+  {
+    cv::Point3d origin;       // Esquina inferior (mm)
+    double      spacing = 10; // Lado de la celda (mm)
+    cv::Vec3i   dims;         // Puntos de la rejilla en x, y, z
+
+    // Caja que contiene todo el alcance del brazo
+    static Grid forGeometry(const RobotGeometry& geometry, double spacing = DEFAULT_SPACING);
+    size_t      pointCount() const;
+    bool        operator==(const Grid& other) const;
+  };
+
+  ~IkLookupTable();
+
+  static std::shared_ptr<const IkLookupTable> load(const QString& filePath, const RobotGeometry& geometry, const JointLimits& limits,
+                                                   const Grid& grid);
+  // Nulo si cancelled devuelve true antes de terminar (otra geometría, cierre de la aplicación)
+  static std::shared_ptr<const IkLookupTable> build(const RobotGeometry& geometry, const JointLimits& limits, const Grid& grid,
+                                                    const std::function<bool()>& cancelled = nullptr);
+  bool                                        save(const QString& filePath) const;
+
+  // Semilla interpolada para q1, q2, q3 y q5; el resto de articulaciones no se toca
+  bool seedFor(const cv::Point3d& position, JointAngles& seed) const;
+  // Semilla de la tabla + unas pocas iteraciones (por rama vecina, como mucho); q4 y q6 se toman de rest
+  IkResult solve(const IkTarget& target, const JointAngles& rest) const;
+
+  const RobotGeometry& geometry() const;
+  const JointLimits&   limits() const;
+  const Grid&          grid() const;
+  size_t               reachableCount() const;
+
+  static constexpr double DEFAULT_SPACING   = 10.0; // mm
+  static const int        POLISH_ITERATIONS = 8;
+  static const quint32    MAGIC             = 0x4b495241; // "ARIK"
+  static const quint32    VERSION           = 1;
+
+private:
+  IkLookupTable() = default;
+
+  const float* cell(int x, int y, int z) const;
+  int          neighbours(const cv::Point3d& position, const float* corners[8], double weights[8]) const;
+
+  RobotGeometry          m_geometry;
+  JointLimits            m_limits;
+  Grid                   m_grid;
+  const float*           m_cells = nullptr; // Apunta a m_ownedCells o al fichero mapeado
+  std::vector<float>     m_ownedCells;
+  std::unique_ptr<QFile> m_file;
+};
+
+#endif // IKLOOKUPTABLE_H
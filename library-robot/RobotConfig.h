@@ -7,10 +7,12 @@ struct MotorConfig {
   int minAngle = 0;
   int maxAngle = 180;
   int defaultAngle = 0;
-  int speed = 100;
+  int speed = 100; // Velocidad máxima de la trayectoria (grados/s)
   int desiredAngle = 0;
   int currentAngle = 0;
   int fixedAngle   = 0;
+  int acceleration = 300; // Aceleración máxima de la trayectoria (grados/s²)
+  int jerk         = 2000; // Jerk máximo del suavizado de consignas (grados/s³)
 };
 
 struct RobotClawPosition { // Angles for claw 
@@ -30,6 +32,8 @@ struct RobotSettings
     {0, 180, 82, 100, 0, 0},   // Motor 5
     {0, 180, 0, 100, 0, 0}     // Motor 6
   };
+
+  int controlRateHz = 200; // Frecuencia del hilo de control (Hz)
 };
 
 } // namespace RobotConfig
@@ -130,13 +130,10 @@ void RobotControlDialog::on_pushButtonSetup_clicked() {
     return;
   }
 
-  int vals[6] = {ui->horizontalSlider1->value(), ui->horizontalSlider2->value(), ui->horizontalSlider3->value(),
-                 ui->horizontalSlider4->value(), ui->horizontalSlider5->value(), ui->horizontalSlider6->value()};
-
-  for (int i = 0; i < 6; ++i) {
-    int valToSend = vals[i];
-    emit motorAngleChanged(i + 1, valToSend);
-  }
+  // Una sola pose para que el planificador mueva las seis articulaciones a la vez
+  QVector<int> vals = {ui->horizontalSlider1->value(), ui->horizontalSlider2->value(), ui->horizontalSlider3->value(),
+                       ui->horizontalSlider4->value(), ui->horizontalSlider5->value(), ui->horizontalSlider6->value()};
+  emit motorAnglesChanged(vals);
 }
 
 void RobotControlDialog::on_pushButtonAllSingle_clicked() {
@@ -167,6 +164,16 @@ void RobotControlDialog::on_pushButtonSetOffsets_clicked() {
   }
 }
 
+void RobotControlDialog::on_pushButtonMoveLinear_clicked() {
+  emit linearMoveRequested(ui->doubleSpinBoxX->value(), ui->doubleSpinBoxY->value(), ui->doubleSpinBoxZ->value(),
+                           ui->doubleSpinBoxLinearSpeed->value(), ui->checkBoxKeepPitch->isChecked());
+}
+
+void RobotControlDialog::setEffectorPosition(double x, double y, double z) {
+  ui->groupBoxCartesian->setTitle(
+    QString("Cartesian Move (effector: %1, %2, %3 mm)").arg(x, 0, 'f', 1).arg(y, 0, 'f', 1).arg(z, 0, 'f', 1));
+}
+
 void RobotControlDialog::setupOffsets() {
   if (!m_robotSettings) {
     emit errorOccurred("Robot settings not initialized.");
@@ -3,6 +3,7 @@
 
 #include "RobotConfig.h"
 #include <QDialog>
+#include <QVector>
 
 namespace Ui {
 class RobotControlDialog;
@@ -17,12 +18,16 @@ public:
   ~RobotControlDialog();
 
   void setupOffsets();
+  // Posicion actual de la pinza, se muestra junto a los controles del movimiento cartesiano
+  void setEffectorPosition(double x, double y, double z);
 
 signals:
   void errorOccurred(const QString &error);
   void motorAngleChanged(int motorIndex, int angle);
+  void motorAnglesChanged(const QVector<int> &angles); // Pose completa (boton Setup)
   void allMotorsReset();
   void motorOffsetChanged(int motorIndex, int newOffset);
+  void linearMoveRequested(double x, double y, double z, double speed, bool keepPitch);
 
 
 private slots:
@@ -30,6 +35,7 @@ private slots:
   void on_pushButtonSetup_clicked();
   void on_pushButtonAllSingle_clicked();
   void on_pushButtonSetOffsets_clicked();
+  void on_pushButtonMoveLinear_clicked();
 
 private:
   Ui::RobotControlDialog *ui;
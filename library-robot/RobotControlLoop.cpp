@@ -0,0 +1,355 @@
+#include "RobotControlLoop.h"
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+JointAngles requestEnd(const MotionRequest& request)
+{
+  return request.kind == MotionRequest::Joint ? request.goal : request.path.goal();
+}
+} // namespace
+
+RobotControlLoop::RobotControlLoop(QObject* parent) : QThread(parent)
+{
+  qRegisterMetaType<ControlLoopStats>();
+}
+
+RobotControlLoop::~RobotControlLoop()
+{
+  {
+    QMutexLocker locker(&m_mutex);
+    requestInterruption();
+    m_wake.wakeAll();
+  }
+  wait();
+}
+
+void RobotControlLoop::setRate(int hz)
+{
+  m_rateHz = std::clamp(hz, MIN_RATE_HZ, MAX_RATE_HZ);
+}
+
+int RobotControlLoop::rate() const
+{
+  return m_rateHz;
+}
+
+void RobotControlLoop::submit(const MotionRequest& request)
+{
+  QMutexLocker locker(&m_mutex);
+  m_request    = request;
+  m_hasRequest = true;
+  m_wake.wakeAll();
+}
+
+JointAngles RobotControlLoop::endPose() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_publishedEnd;
+}
+
+void RobotControlLoop::setPose(const JointAngles& pose)
+{
+  QMutexLocker locker(&m_mutex);
+  m_pose       = pose;
+  m_hasPose    = true;
+  m_hasRequest = false; // Una petición anterior partía de una pose que no era la real
+  m_wake.wakeAll();
+}
+
+void RobotControlLoop::stopMotion()
+{
+  QMutexLocker locker(&m_mutex);
+  m_stopRequested = true;
+  m_hasRequest    = false;
+  m_wake.wakeAll();
+}
+
+void RobotControlLoop::postTelemetry(const SerialProtocol::Telemetry& telemetry)
+{
+  QMutexLocker locker(&m_mutex);
+  m_telemetry.push_back(telemetry);
+  m_wake.wakeAll();
+}
+
+ControlLoopStats RobotControlLoop::stats() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_publishedStats;
+}
+
+void RobotControlLoop::resetStats()
+{
+  QMutexLocker locker(&m_mutex);
+  m_resetStats = true;
+}
+
+void RobotControlLoop::run()
+{
+  Clock::time_point next       = Clock::now();
+  Clock::time_point lastReport = next;
+
+  while (!isInterruptionRequested()) {
+    drainInbox();
+
+    if (!active()) {
+      // Parado: sin periodos que cumplir, se espera a la siguiente petición
+      publishStats(false);
+      {
+        QMutexLocker locker(&m_mutex);
+        if (!m_hasRequest && !m_hasPose && !m_stopRequested && m_telemetry.empty() && !isInterruptionRequested())
+          m_wake.wait(&m_mutex, IDLE_WAIT_MS);
+      }
+      next = Clock::now();
+      continue;
+    }
+
+    const int                      rateHz = m_rateHz;
+    const std::chrono::nanoseconds period(1000000000LL / rateHz);
+    const Clock::time_point        wake = Clock::now();
+
+    const double lateness = std::chrono::duration<double, std::micro>(wake - next).count();
+    m_stats.rateHz        = rateHz;
+    m_stats.maxLatenessUs = std::max(m_stats.maxLatenessUs, lateness);
+    m_latenessSumUs += std::max(0.0, lateness);
+
+    step(wake);
+
+    const Clock::time_point done = Clock::now();
+    ++m_stats.ticks;
+    m_stats.maxWorkUs = std::max(m_stats.maxWorkUs, std::chrono::duration<double, std::micro>(done - wake).count());
+
+    // Plazo incumplido: la rejilla se recoloca en lugar de encadenar periodos atrasados
+    next += period;
+    if (done > next) {
+      ++m_stats.missedDeadlines;
+      next = done;
+    }
+
+    if (done - lastReport >= std::chrono::seconds(1)) {
+      publishStats(true);
+      lastReport = done;
+    }
+    std::this_thread::sleep_until(next);
+  }
+}
+
+bool RobotControlLoop::active() const
+{
+  return m_moving || !m_filter.settled();
+}
+
+void RobotControlLoop::drainInbox()
+{
+  std::vector<SerialProtocol::Telemetry> telemetry;
+  MotionRequest                          request;
+  JointAngles                            pose{};
+  bool                                   hasRequest = false;
+  bool                                   hasPose    = false;
+  bool                                   stop       = false;
+  bool                                   reset      = false;
+  {
+    QMutexLocker locker(&m_mutex);
+    telemetry.swap(m_telemetry);
+    hasRequest      = m_hasRequest;
+    hasPose         = m_hasPose;
+    stop            = m_stopRequested;
+    reset           = m_resetStats;
+    m_hasRequest    = false;
+    m_hasPose       = false;
+    m_stopRequested = false;
+    m_resetStats    = false;
+    if (hasRequest)
+      request = m_request;
+    pose = m_pose;
+  }
+
+  // La pose leída sustituye a todo lo anterior; lo enviado se da por hecho, sin reenviarlo
+  if (hasPose) {
+    m_moving        = false;
+    m_hasPending    = false;
+    m_finishPending = false;
+    m_commanded     = pose;
+    m_hasCommanded  = true;
+    m_filter.reset(pose);
+    for (size_t i = 0; i < pose.size(); ++i)
+      m_lastSent[i] = static_cast<int>(std::lround(pose[i]));
+    m_hasSent = true;
+    publishEnd(pose);
+  }
+
+  for (const SerialProtocol::Telemetry& sample : telemetry)
+    ingestTelemetry(sample);
+
+  if (reset) {
+    m_stats         = ControlLoopStats();
+    m_latenessSumUs = 0.0;
+  }
+
+  // La consigna se congela en la última pose muestreada y el filtro frena hasta ella
+  if (stop) {
+    m_moving     = false;
+    m_hasPending = false;
+    publishEnd(m_commanded);
+  }
+
+  if (!hasRequest)
+    return;
+
+  // Partir de una pose supuesta mandaría las seis articulaciones hacia ella antes de ir al destino
+  if (!m_hasCommanded) {
+    emit motionRejected("Robot pose not read yet: motion ignored");
+    return;
+  }
+
+  // Durante un movimiento, la petición nueva sustituye a la pendiente: arrastrar un slider no
+  // encola cien movimientos
+  if (m_moving) {
+    m_pending    = request;
+    m_hasPending = true;
+    publishEnd(requestEnd(request));
+    return;
+  }
+  startRequest(request, Clock::now());
+}
+
+void RobotControlLoop::ingestTelemetry(const SerialProtocol::Telemetry& telemetry)
+{
+  if (telemetry.kind != SerialProtocol::Telemetry::AngleWithOffset || telemetry.servo < 1 || telemetry.servo > 6)
+    return;
+
+  ++m_stats.telemetryLines;
+
+  // Parado, la pose leída manda: el siguiente movimiento sale de ella. El servo ya está en ese
+  // ángulo, así que no cuenta como cambio en el siguiente envío
+  if (!active() && m_hasCommanded) {
+    m_commanded[telemetry.servo - 1] = telemetry.value;
+    m_lastSent[telemetry.servo - 1]  = telemetry.value;
+    m_filter.reset(m_commanded);
+    publishEnd(m_commanded);
+  }
+}
+
+void RobotControlLoop::step(Clock::time_point now)
+{
+  if (m_moving) {
+    const double t = std::chrono::duration<double>(now - m_motionStart).count();
+    m_commanded    = activePosition(t);
+    if (t >= activeDuration()) {
+      m_commanded     = activeGoal();
+      m_moving        = false;
+      m_finishPending = true;
+      // La siguiente trayectoria sale de la consigna sin filtrar: el filtro enlaza las dos sin parar
+      if (m_hasPending) {
+        m_hasPending    = false;
+        m_finishPending = !startRequest(m_pending, now);
+      }
+    }
+  }
+
+  sendPose(m_filter.update(m_commanded));
+
+  if (m_finishPending && !active()) {
+    m_finishPending = false;
+    publishStats(true);
+    emit motionFinished();
+  }
+}
+
+bool RobotControlLoop::startRequest(const MotionRequest& request, Clock::time_point now)
+{
+  // Aquí solo se planifica el trapecio articular, de coste fijo; las rutas llegan resueltas
+  if (request.kind == MotionRequest::Joint) {
+    m_jointTrajectory = TrajectoryPlanner::planJointMove(m_commanded, request.goal, request.motion);
+    m_kind            = MotionRequest::Joint;
+  }
+  else if (request.path.waypoints.empty()) {
+    m_moving = false;
+    emit motionRejected("Empty path rejected");
+    return false;
+  }
+  else {
+    // La ruta se resolvió desde endPose. Si la consigna ya no está ahí (una parada, o un
+    // movimiento pendiente sustituido por esta ruta) se llega antes a su inicio con un trapecio
+    // articular y la ruta queda pendiente, en lugar de dar un salto
+    const JointAngles& start = request.path.waypoints.front();
+    double             gap   = 0.0;
+    for (size_t i = 0; i < m_commanded.size(); ++i)
+      gap = std::max(gap, std::abs(start[i] - m_commanded[i]));
+    if (gap > PATH_START_TOLERANCE) {
+      m_pending         = request;
+      m_hasPending      = true;
+      m_jointTrajectory = TrajectoryPlanner::planJointMove(m_commanded, start, request.motion);
+      m_kind            = MotionRequest::Joint;
+    }
+    else {
+      m_path = request.path;
+      m_kind = MotionRequest::Path;
+    }
+  }
+
+  m_filter.configure(request.motion.smoothingWindows(), 1.0 / double(m_rateHz));
+  m_moving        = true;
+  m_finishPending = false;
+  m_motionStart   = now;
+
+  const JointAngles goal = activeGoal();
+  publishEnd(m_hasPending ? requestEnd(m_pending) : goal);
+
+  emit motionStarted(QVector<double>(goal.begin(), goal.end()));
+  return true;
+}
+
+double RobotControlLoop::activeDuration() const
+{
+  return m_kind == MotionRequest::Joint ? m_jointTrajectory.duration : m_path.duration();
+}
+
+JointAngles RobotControlLoop::activePosition(double t) const
+{
+  return m_kind == MotionRequest::Joint ? m_jointTrajectory.position(t) : m_path.position(t);
+}
+
+JointAngles RobotControlLoop::activeGoal() const
+{
+  return m_kind == MotionRequest::Joint ? m_jointTrajectory.goal() : m_path.goal();
+}
+
+void RobotControlLoop::sendPose(const JointAngles& pose)
+{
+  int changedMask = 0;
+  for (size_t i = 0; i < pose.size(); ++i) {
+    const int angle = static_cast<int>(std::lround(pose[i]));
+    if (m_hasSent && angle == m_lastSent[i])
+      continue;
+    m_lastSent[i] = angle;
+    changedMask |= 1 << i;
+  }
+  m_hasSent = true;
+
+  // El formato lo decide el puerto: una trama con toda la pose o una línea por servo cambiado
+  if (changedMask)
+    emit servoAnglesReady(QVector<int>(m_lastSent.begin(), m_lastSent.end()), changedMask);
+}
+
+void RobotControlLoop::publishStats(bool notify)
+{
+  ControlLoopStats snapshot = m_stats;
+  snapshot.rateHz           = m_rateHz;
+  snapshot.meanLatenessUs   = m_stats.ticks ? m_latenessSumUs / double(m_stats.ticks) : 0.0;
+  {
+    QMutexLocker locker(&m_mutex);
+    m_publishedStats = snapshot;
+  }
+  if (notify)
+    emit statsUpdated(snapshot);
+}
+
+void RobotControlLoop::publishEnd(const JointAngles& pose)
+{
+  QMutexLocker locker(&m_mutex);
+  m_publishedEnd = pose;
+}
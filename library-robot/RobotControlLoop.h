@@ -0,0 +1,154 @@
+#ifndef ROBOTCONTROLLOOP_H
+#define ROBOTCONTROLLOOP_H
+
+#include "../library-serial/SerialProtocol.h"
+#include "SetpointFilter.h"
+#include "TrajectoryPlanner.h"
+#include <QByteArray>
+#include <QMetaType>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+// Petición de movimiento; la articular se planifica cuando le toca empezar, desde la última pose enviada
+struct MotionRequest
+{
+  enum Kind
+  {
+    Joint, // Trapecio articular sincronizado hasta goal
+    Path   // Waypoints ya resueltos fuera del hilo de control (rectas de TrajectoryPlanner::planLinearMove)
+  };
+
+  Kind               kind = Joint;
+  JointAngles        goal{};
+  WaypointTrajectory path; // Resuelta desde endPose(); si la consigna ya no está ahí, se va antes a su inicio
+  JointMotionLimits  motion{};
+  JointLimits        limits;
+};
+
+// Medidas del bucle de control desde que arrancó (o desde resetStats)
+struct ControlLoopStats
+{
+  int     rateHz          = 0;
+  quint64 ticks           = 0;
+  quint64 missedDeadlines = 0;   // Periodos cuyo trabajo terminó después del inicio del siguiente
+  double  maxLatenessUs   = 0.0; // Retraso máximo al despertar respecto al instante previsto
+  double  meanLatenessUs  = 0.0;
+  double  maxWorkUs       = 0.0; // Tiempo máximo de cálculo de un periodo
+  quint64 telemetryLines  = 0;   // Líneas ANGLE_WITH_OFFSET procesadas
+};
+Q_DECLARE_METATYPE(ControlLoopStats)
+
+/**
+ * @brief Hilo de control a frecuencia fija sobre reloj monótono.
+ * @details Cada periodo recoge la telemetría y las peticiones pendientes, muestrea la
+ * trayectoria en curso, la pasa por el JerkLimitedFilter y emite la pose entera con la máscara
+ * de los servos cuyo ángulo entero ha cambiado. Todas las consignas (sliders, calibración,
+ * rectas) llegan por aquí, así que ninguna sale como escalón; al acabar la trayectoria el hilo
+ * sigue en marcha hasta que el filtro alcanza el destino. Los instantes se calculan con
+ * std::chrono::steady_clock y sleep_until sobre una rejilla fija, así que un bloqueo de la
+ * interfaz no estira el movimiento: solo puede retrasar la entrega de los comandos ya emitidos.
+ * Un periodo cuyo trabajo acaba después del inicio del siguiente cuenta como plazo incumplido y
+ * la rejilla se recoloca en lugar de encadenar periodos atrasados. Parado, el hilo duerme en una
+ * condición y solo despierta con una petición, telemetría o cada IDLE_WAIT_MS.
+ *
+ * Todos los métodos públicos se pueden llamar desde cualquier hilo.
+ */
+class RobotControlLoop : public QThread
+{
+  Q_OBJECT
+public:
+  explicit RobotControlLoop(QObject* parent = nullptr);
+  ~RobotControlLoop();
+
+  static const int DEFAULT_RATE_HZ = 200;
+  static const int MIN_RATE_HZ     = 10;
+  static const int MAX_RATE_HZ     = 1000;
+  static const int IDLE_WAIT_MS    = 100;
+  // Grados que puede separarse el primer waypoint de una ruta de la consigna sin acercarse antes a él
+  static constexpr double PATH_START_TOLERANCE = 0.5;
+
+  void setRate(int hz);
+  int  rate() const;
+
+  // Sin pose leída (setPose) las peticiones se rechazan con motionRejected
+  void submit(const MotionRequest& request);
+  // Pose en la que quedará la consigna al terminar lo que hay en marcha: el inicio de una ruta
+  JointAngles endPose() const;
+  void stopMotion();
+  // Pose leída del robot (READ:ANGLES_WITH_OFFSET): detiene lo que haya en marcha y fija en ella
+  // la consigna, el filtro y lo último enviado, así el primer periodo solo manda lo que cambie
+  void setPose(const JointAngles& pose);
+  // Telemetría del puerto serie; los ángulos con offset fijan la pose de partida si está parado
+  void postTelemetry(const SerialProtocol::Telemetry& telemetry);
+
+  ControlLoopStats stats() const;
+  void             resetStats();
+
+signals:
+  void servoAnglesReady(const QVector<int>& angles, int changedMask); // Bit i: el servo i+1 ha cambiado
+  void motionStarted(const QVector<double>& goal);                    // Pose final del movimiento que empieza
+  void motionFinished(); // Cuando la salida del filtro llega al destino
+  void motionRejected(const QString& reason);
+  void statsUpdated(const ControlLoopStats& stats); // Una vez por segundo mientras hay movimiento
+
+protected:
+  void run() override;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  // Buzón compartido con el resto de hilos (m_mutex)
+  mutable QMutex          m_mutex;
+  QWaitCondition          m_wake;
+  bool                    m_hasRequest = false;
+  MotionRequest           m_request;
+  bool                    m_hasPose = false;
+  JointAngles             m_pose{};
+  bool                    m_stopRequested = false;
+  std::vector<SerialProtocol::Telemetry> m_telemetry;
+  ControlLoopStats        m_publishedStats;
+  JointAngles             m_publishedEnd{};
+  bool                    m_resetStats = false;
+  std::atomic<int>        m_rateHz{DEFAULT_RATE_HZ};
+
+  // Estado del hilo de control (solo se toca en run())
+  MotionRequest::Kind m_kind = MotionRequest::Joint;
+  JointTrajectory     m_jointTrajectory;
+  WaypointTrajectory  m_path;
+  Clock::time_point   m_motionStart;
+  bool                m_moving     = false;
+  bool                m_hasPending = false;
+  MotionRequest       m_pending;
+  JerkLimitedFilter   m_filter;
+  bool                m_finishPending = false; // motionFinished en cuanto el filtro se asiente
+
+  JointAngles        m_commanded{}; // Última pose muestreada, antes del filtro
+  bool               m_hasCommanded = false; // Hay pose de partida: la de setPose o una posterior
+  std::array<int, 6> m_lastSent{};
+  bool               m_hasSent = false;
+
+  ControlLoopStats m_stats;
+  double           m_latenessSumUs = 0.0;
+
+  bool        active() const;
+  void        drainInbox();
+  void        ingestTelemetry(const SerialProtocol::Telemetry& telemetry);
+  void        step(Clock::time_point now);
+  bool        startRequest(const MotionRequest& request, Clock::time_point now);
+  double      activeDuration() const;
+  JointAngles activePosition(double t) const;
+  JointAngles activeGoal() const;
+  void        sendPose(const JointAngles& pose);
+  void        publishStats(bool notify);
+  void        publishEnd(const JointAngles& pose);
+};
+
+#endif // ROBOTCONTROLLOOP_H
@@ -1,43 +1,129 @@
 #include "RobotHandler.h"
 #include "../library-serial/SerialPortHandler.h"
 #include "RobotConfig.h"
+#include "RobotControlLoop.h"
 #include <QDebug>
+#include <QDir>
+#include <QFutureWatcher>
 #include <QSettings>
+#include <QThread>
 #include <cmath>
+#include <limits>
 #include <opencv2/core.hpp>
 #include <opencv2/opencv.hpp>
 
 RobotConfig::RobotSettings robotSettings; // instancia global
 
-RobotHandler::RobotHandler(QObject *parent) : QObject(parent) {
-  // Inicializa matrices como identidad 4x4
-  RTb1 = cv::Mat::eye(4, 4, CV_64F);
-  RT12 = cv::Mat::eye(4, 4, CV_64F);
-  RT23 = cv::Mat::eye(4, 4, CV_64F);
-  RT35 = cv::Mat::eye(4, 4, CV_64F);
-  RTbt = cv::Mat::eye(4, 4, CV_64F);
+namespace {
+const char *IK_TABLE_FILE = "kinematics/ik_lookup.bin";
+const char *WORKSPACE_MAP_FILE = "kinematics/workspace.bin";
+} // namespace
 
+RobotHandler::RobotHandler(QObject *parent) : QObject(parent) {
   // Inicializa matriz de �ngulos (q1...q6)
   q = (cv::Mat_<int>(1, 6) << 0, 0, 0, 0, 0, 0);
+  m_robotSettings = &robotSettings;
 
   // Conexi�n de se�ales del puerto serie
   SerialPortHandler &serial = SerialPortHandler::instance();
-  connect(&serial, &SerialPortHandler::dataReceived, this,
-          &RobotHandler::onDataReceived);
-  connect(&serial, &SerialPortHandler::dataSent, this,
-          &RobotHandler::onDataSent);
+  connect(&serial, &SerialPortHandler::telemetryReceived, this,
+          &RobotHandler::onTelemetryReceived);
+  // dataSent no se conecta: el hilo de control envía una pose por ciclo y registrarlas en la GUI
+  // devolvería la E/S a su hilo. Lo enviado se ve en SerialMonitorDialog
+  connect(&serial, &SerialPortHandler::connectionStatusChanged, this,
+          &RobotHandler::onSerialStatusChanged);
 
   m_serialConnected = serial.isConnected();
+  m_ikPool.setMaxThreadCount(1);
+  m_planPool.setMaxThreadCount(1);
+
+  // Hilo de control: muestrea las trayectorias a frecuencia fija y recoge la telemetría
+  // directamente desde la señal del puerto serie, sin pasar por el hilo de la interfaz
+  m_controlLoop = new RobotControlLoop(this);
+  RobotControlLoop *loop = m_controlLoop;
+  connect(&serial, &SerialPortHandler::telemetryReceived, loop,
+          [loop](const SerialProtocol::Telemetry &telemetry) { loop->postTelemetry(telemetry); }, Qt::DirectConnection);
+  // Los comandos van del hilo de control a la cola del hilo de E/S, también sin pasar por la interfaz
+  connect(
+      m_controlLoop, &RobotControlLoop::servoAnglesReady, this,
+      [](const QVector<int> &angles, int changedMask) { SerialPortHandler::instance().sendServoAngles(angles, changedMask); },
+      Qt::DirectConnection);
+  connect(m_controlLoop, &RobotControlLoop::motionStarted, this, [this](const QVector<double> &goal) {
+    for (int i = 0; i < goal.size() && i < int(m_goal.size()); ++i)
+      m_goal[i] = goal[i];
+    m_hasGoal = true;
+  });
+  connect(m_controlLoop, &RobotControlLoop::motionFinished, this, &RobotHandler::motionFinished);
+  connect(m_controlLoop, &RobotControlLoop::motionRejected, this, &RobotHandler::errorOccurred);
+  connect(m_controlLoop, &RobotControlLoop::statsUpdated, this, &RobotHandler::controlStatsUpdated);
+  m_controlLoop->start(QThread::TimeCriticalPriority);
+
+  if (m_serialConnected)
+    requestPose();
+}
+
+void RobotHandler::onSerialStatusChanged(bool connected) {
+  m_serialConnected = connected;
+  // La pose anterior ya no vale: el brazo puede haberse movido o reiniciado con el puerto cerrado
+  m_poseKnown = false;
+  if (connected)
+    requestPose();
+  else
+    stopMotion();
+}
+
+/**
+ * @brief Lee la pose real del brazo; hasta que llega, moveTo y moveLinear no hacen nada. Sin
+ * ella el hilo de control partiría de una pose supuesta y mandaría todas las articulaciones
+ * hacia ella antes de ir al destino pedido.
+ */
+void RobotHandler::requestPose() {
+  if (m_poseRequested)
+    return;
+  m_poseRequested = true;
+
+  SerialRequest request;
+  request.kind = SerialRequest::ReadAngles;
+
+  auto *watcher = new QFutureWatcher<SerialReply>(this);
+  connect(watcher, &QFutureWatcher<SerialReply>::finished, this, [this, watcher]() {
+    watcher->deleteLater();
+    m_poseRequested = false;
+    const SerialReply reply = watcher->future().isResultReadyAt(0) ? watcher->result() : SerialReply();
+    if (!reply.ok || reply.values.size() < int(m_angles.size())) {
+      if (m_serialConnected) // Al cerrar el puerto se cancela sin más
+        emit errorOccurred("Could not read the robot pose: " + reply.error);
+      return;
+    }
+
+    for (size_t i = 0; i < m_angles.size(); ++i) {
+      m_angles[i] = reply.values[int(i)];
+      q.at<int>(0, int(i)) = reply.values[int(i)];
+    }
+    m_poseKnown = true;
+    m_controlLoop->setPose(m_angles);
+    actualizarMatrices(q);
+  });
+  watcher->setFuture(SerialPortHandler::instance().request(request));
 }
 
-void RobotHandler::onDataReceived(const QByteArray &data) {
-  const QString msg = QString::fromUtf8(data).trimmed();
+bool RobotHandler::ensurePose() {
+  if (m_poseKnown)
+    return true;
+  // Un aviso por lectura, no uno por cada evento de un slider
+  if (!m_poseRequested) {
+    emit errorOccurred("Robot pose not read yet: motion ignored while it is read");
+    requestPose();
+  }
+  return false;
+}
 
-  int servoNum = 0, valor = 0;
+void RobotHandler::onTelemetryReceived(const SerialProtocol::Telemetry &telemetry) {
+  // El puerto serie ya ha separado servo y valor, tanto de las líneas ASCII como de las tramas
+  const int servoNum = telemetry.servo;
+  const int valor = telemetry.value;
 
-  // Extraer servo y valor con sscanf
-  if (sscanf(msg.toUtf8().constData(), "ANGLE_WITH_OFFSET:SERVO%d:%d", &servoNum, &valor) ==
-      2) {
+  if (telemetry.kind == SerialProtocol::Telemetry::AngleWithOffset) {
     // Validar rangos
     if (servoNum < 1 || servoNum > 6) {
       qDebug() << "[RobotHandler] Servo inv�lido:" << servoNum;
@@ -52,21 +138,15 @@ void RobotHandler::onDataReceived(const QByteArray &data) {
 
     // Actualizar el valor correspondiente en la matriz q
     q.at<int>(0, servoNum - 1) = valor;
+    m_angles[servoNum - 1] = valor;
 
-    qDebug()
-        << QString("[RobotHandler] Servo %1 -> %2").arg(servoNum).arg(valor);
-    qDebug() << "Estado actual de los servos: [" << q.at<int>(0, 0) << ", "
-             << q.at<int>(0, 1) << ", " << q.at<int>(0, 2) << ", "
-             << q.at<int>(0, 3) << ", " << q.at<int>(0, 4) << ", "
-             << q.at<int>(0, 5) << "]";
-
-    // Actualizar matrices cinem�ticas
+    // Actualizar matrices cinem�ticas (solo cinemática directa: llega una línea por servo y movimiento)
     actualizarMatrices(q);
 
     // Emitir se�al informando cambio de �ngulo
     emit motorAngleChanged(servoNum, valor);
   } 
-  else if (sscanf(msg.toUtf8().constData(), "OFFSET:SERVO%d:%d", &servoNum, &valor) == 2) {
+  else if (telemetry.kind == SerialProtocol::Telemetry::Offset) {
     if (servoNum < 1 || servoNum > 6) {
       qDebug() << "[RobotHandler] Servo inválido:" << servoNum;
       emit errorOccurred(QString("Invalid servo index: %1").arg(servoNum));
@@ -75,124 +155,279 @@ void RobotHandler::onDataReceived(const QByteArray &data) {
     // Puedes ajustar el rango de offset si lo necesitas
     emit motorOffsetsChanged(servoNum, valor);
   }
-  else {
-    qDebug() << "[RobotHandler] Mensaje no reconocido:" << msg;
-  }
 }
 
 void RobotHandler::actualizarMatrices(const cv::Mat &q) {
-  if (q.cols < 4) {
+  if (q.cols < 5) {
     qDebug() << "La matriz q no tiene suficientes columnas.";
     return;
   }
 
-  // Convertir �ngulos de grados a radianes
-  double q1_rad = -q.at<int>(0, 0) * M_PI / 180.0;
-  double q2_rad = -q.at<int>(0, 1) * M_PI / 180.0;
-  double q3_rad = -q.at<int>(0, 2) * M_PI / 180.0;
-  double q5_rad = -q.at<int>(0, 4) * M_PI / 180.0;
-
-  // RTb1 � Base al primer eslab�n
-  RTb1 = cv::Mat::eye(4, 4, CV_64F);
-  RTb1.at<double>(0, 0) = cos(q1_rad);
-  RTb1.at<double>(0, 1) = -sin(q1_rad);
-  RTb1.at<double>(1, 0) = sin(q1_rad);
-  RTb1.at<double>(1, 1) = cos(q1_rad);
-  RTb1.at<double>(2, 3) = -a1; // traslaci�n en z
-
-  // RT12 � Primer eslab�n al segundo
-  RT12 = cv::Mat::eye(4, 4, CV_64F);
-  RT12.at<double>(0, 0) = cos(q2_rad);
-  RT12.at<double>(0, 2) = sin(q2_rad);
-  RT12.at<double>(2, 3) = -a2;
-  RT12.at<double>(2, 0) = -sin(q2_rad);
-  RT12.at<double>(2, 2) = cos(q2_rad);
-
-  // RT23 � Segundo al tercero
-  RT23 = cv::Mat::eye(4, 4, CV_64F);
-  RT23.at<double>(0, 0) = cos(q3_rad);
-  RT23.at<double>(0, 2) = sin(q3_rad);
-  RT23.at<double>(2, 3) = -a3;
-  RT23.at<double>(2, 0) = -sin(q3_rad);
-  RT23.at<double>(2, 2) = cos(q3_rad);
-
-  // RT35 � Tercer eslab�n al efector final
-  cv::Mat RT35          = cv::Mat::eye(4, 4, CV_64F);
-  RT35.at<double>(0, 0) = cos(q5_rad);
-  RT35.at<double>(0, 2) = sin(q5_rad);
-  RT35.at<double>(2, 3) = -a5;
-  RT35.at<double>(2, 0) = -sin(q5_rad);
-  RT35.at<double>(2, 2) = cos(q5_rad);
+  JointAngles angles{};
+  for (int i = 0; i < q.cols && i < static_cast<int>(angles.size()); ++i)
+    angles[i] = q.at<int>(0, i);
+
+  // Cadena RTb1 · RT12 · RT23 · RT35 sobre matrices fijas, sin reservas de memoria
+  const RobotKinematics::Chain chain = RobotKinematics::forwardChain(angles, m_geometry);
+  RTb1 = chain.RTb1;
+  RT12 = chain.RT12;
+  RT23 = chain.RT23;
+  RT35 = chain.RT35;
 
   // Transformaci�n total
-  /*RTbt = RTb1 * RT12 * RT23 * RT35;*/
-  RTbt = RT35 * RT23 * RT12 * RTb1;
-  /*cv::Mat RTbt2 = RT35.inv() * RT23.inv() * RT12.inv() * RTb1.inv();
-  cv::Mat mult = RTbt * RTbt2;
-  double* f     = &(mult.at<double>(0, 0));*/
+  RTbt = chain.RTbt;
 
   emit messageOccurred("Matrices updated successfully.");
-  emit matrixsUpdated(RTbt);
-
-  qDebug() << "Matrices actualizadas:";
-  for (int i = 0; i < RTbt.rows; ++i) {
-    QString row;
-    for (int j = 0; j < RTbt.cols; ++j) {
-      row += QString::number(RTbt.at<double>(i, j), 'f', 3) + " ";
-    }
-    qDebug() << row;
-  }
+  emit matrixsUpdated(cv::Mat(RTbt));
 
   cv::Point3d efectorLocal(0, 0, 0);
   cv::Point3d efectorGlobal = transformarPunto(efectorLocal);
 
   emit efectorPositionChanged(efectorGlobal.x, efectorGlobal.y,
                               efectorGlobal.z);
+}
+
+IkResult RobotHandler::inverseCinematic(const IkTarget &target) const {
+  const JointLimits limits = JointLimits::fromSettings(*m_robotSettings);
+  IkResult rejected;
+  if (isOutsideWorkspace(target, rejected))
+    return rejected;
+  return RobotKinematics::solveInverse(target, m_angles, limits, m_geometry);
+}
 
-  qDebug() << "Posicion de la pinza (respecto a la base del robot):"
-           << "(" << efectorGlobal.x << ", " << efectorGlobal.y << ", "
-           << efectorGlobal.z << ")";
+IkResult RobotHandler::inverseCinematicFromTable(const IkTarget &target) const {
+  IkResult rejected;
+  if (isOutsideWorkspace(target, rejected))
+    return rejected;
 
-  inverseCinematic(efectorGlobal);
+  const std::shared_ptr<const IkLookupTable> table = std::atomic_load(&m_ikTable->table);
+  if (!table) {
+    requestIkTable();
+    return inverseCinematic(target); // Tabla aún no disponible
+  }
+
+  return table->solve(target, m_angles);
 }
 
-void RobotHandler::inverseCinematic(const cv::Point3d &efectorGlobal) {
-  // Implementaci�n pendiente
-  int R = sqrt(efectorGlobal.x * efectorGlobal.x +
-               efectorGlobal.y * efectorGlobal.y);
-  int Z = efectorGlobal.z;
+void RobotHandler::setRobotSettings(RobotConfig::RobotSettings *settings) {
+  m_robotSettings = settings ? settings : &robotSettings;
+  m_controlLoop->setRate(m_robotSettings->controlRateHz);
+  refreshIkTable();
+}
 
-  qDebug("Valores R y Z calculados: R = %d, Z = %d", R, Z);
+void RobotHandler::setGeometry(const RobotGeometry &geometry) {
+  m_geometry = geometry;
+  refreshIkTable();
+}
 
-  double B_rad = acos((R * R + (Z - a1 + a5) * (Z - a1 + a5) - a2 * a2 - a3 * a3) / (2 * a2 * a3));
-  int B = B_rad * 180 / M_PI;
+const RobotGeometry &RobotHandler::geometry() const { return m_geometry; }
 
-  double A_rad = asin((R * (a2 + a3 * cos(B_rad)) - a3 * sin(B_rad) * (Z - a1 + a5)) / (a2 * a2 + a3 * a3 + 2 * a2 * a3 * cos(B_rad)));
-  int A = A_rad * 180 / M_PI;
+std::shared_ptr<const WorkspaceMap> RobotHandler::workspaceMap() const {
+  return std::atomic_load(&m_ikTable->workspaceMap);
+}
 
-  int C = 180 - A - B;
+// Descarte O(1): un objetivo fuera del mapa no llega al solver y se devuelve sin converger
+bool RobotHandler::isOutsideWorkspace(const IkTarget &target, IkResult &rejected) const {
+  const std::shared_ptr<const WorkspaceMap> map = workspaceMap();
+  if (!map || map->contains(target.position))
+    return false;
+
+  rejected.angles = JointLimits::fromSettings(*m_robotSettings).clamp(m_angles);
+  rejected.converged = false;
+  rejected.iterations = 0;
+  rejected.residual = std::numeric_limits<double>::infinity();
+  return true;
+}
 
-  qDebug("Angulos calculados: A (q2) = %d, B (q3) = %d, C (q5) = %d", A, B, C);
+/**
+ * @brief Abre el mapa de alcance guardado o, si se generó con otra geometría u otros límites,
+ * lo vuelve a generar (un par de segundos) y lo guarda. La tabla de cinemática inversa se
+ * descarta aquí pero no se abre hasta que alguien la usa (requestIkTable). Todo ocurre en
+ * m_ikPool; las tareas de una generación anterior que aún no han empezado se quitan de la cola
+ * y la que está generando la tabla se cancela.
+ */
+void RobotHandler::refreshIkTable() {
+  const std::shared_ptr<IkTableState> state = m_ikTable;
+  const int generation = ++state->generation;
+  std::atomic_store(&state->table, std::shared_ptr<const IkLookupTable>());
+  std::atomic_store(&state->workspaceMap, std::shared_ptr<const WorkspaceMap>());
+  m_ikPool.clear();
+
+  const RobotGeometry geometry = m_geometry;
+  const JointLimits limits = JointLimits::fromSettings(*m_robotSettings);
+
+  m_ikPool.start([state, generation, geometry, limits]() {
+    if (generation != state->generation.load())
+      return;
+    const QString mapPath = QDir::current().filePath(WORKSPACE_MAP_FILE);
+    std::shared_ptr<const WorkspaceMap> map = WorkspaceMap::load(mapPath, geometry, limits);
+    if (!map) {
+      qDebug() << "[RobotHandler] Generando el mapa del espacio de trabajo...";
+      map = WorkspaceMap::build(geometry, limits);
+      if (!map->save(mapPath))
+        qWarning() << "[RobotHandler] No se pudo guardar" << mapPath;
+    }
+    if (generation == state->generation.load())
+      std::atomic_store(&state->workspaceMap, map);
+  });
 }
 
+/**
+ * @brief Abre la tabla guardada o la genera (de segundos a medio minuto según los núcleos) la
+ * primera vez que se pide en cada generación. Si cambian la geometría o los límites mientras se
+ * genera, IkLookupTable::build se detiene en la siguiente capa y no se guarda nada.
+ */
+void RobotHandler::requestIkTable() const {
+  const std::shared_ptr<IkTableState> state = m_ikTable;
+  const int generation = state->generation.load();
+  if (state->tableGeneration.exchange(generation) == generation)
+    return; // Ya pedida
+
+  const RobotGeometry geometry = m_geometry;
+  const JointLimits limits = JointLimits::fromSettings(*m_robotSettings);
+
+  m_ikPool.start([state, generation, geometry, limits]() {
+    const auto cancelled = [state, generation]() { return generation != state->generation.load(); };
+    if (cancelled())
+      return;
+
+    const QString filePath = QDir::current().filePath(IK_TABLE_FILE);
+    const IkLookupTable::Grid grid = IkLookupTable::Grid::forGeometry(geometry);
+
+    std::shared_ptr<const IkLookupTable> table = IkLookupTable::load(filePath, geometry, limits, grid);
+    if (!table) {
+      qDebug() << "[RobotHandler] Generando la tabla de cinemática inversa...";
+      table = IkLookupTable::build(geometry, limits, grid, cancelled);
+      if (!table)
+        return; // Cancelada
+      if (!table->save(filePath))
+        qWarning() << "[RobotHandler] No se pudo guardar" << filePath;
+    }
+
+    // Una petición posterior (otra geometría u otros límites) deja obsoleta esta tabla
+    if (!cancelled())
+      std::atomic_store(&state->table, table);
+  });
+}
+
+JointAngles RobotHandler::currentAngles() const { return m_angles; }
+
+bool RobotHandler::poseKnown() const { return m_poseKnown; }
+
 // Transforma un punto del efector en coordenadas de la base
 cv::Point3d RobotHandler::transformarPunto(const cv::Point3d &puntoLocal) {
-  // Crear punto homog�neo [x, y, z, 1]
-  cv::Mat puntoHom =
-      (cv::Mat_<double>(4, 1) << puntoLocal.x, puntoLocal.y, puntoLocal.z, 1);
+  // RTbt es rígida: su inversa es cerrada, sin factorizar la matriz
+  return RobotKinematics::transformPoint(RobotKinematics::rigidInverse(RTbt), puntoLocal);
+}
+
+void RobotHandler::forwardKinematicsBatch(const JointBatch &joints,
+                                          EffectorBatch &effectors) const {
+  RobotKinematics::forwardBatch(joints, m_geometry, effectors);
+}
+
+RobotHandler::~RobotHandler() {
+  // Cancela la generación en curso y espera a que termine la capa que esté resolviendo
+  ++m_ikTable->generation;
+  m_ikPool.clear();
+  m_ikPool.waitForDone();
+  m_planPool.clear();
+  m_planPool.waitForDone();
+}
+
+void RobotHandler::moveTo(const JointAngles &goal) {
+  if (!SerialPortHandler::instance().isConnected()) {
+    emit errorOccurred("Cannot move: serial port not connected");
+    return;
+  }
+  if (!ensurePose())
+    return;
+
+  MotionRequest request = motionRequest();
+  request.kind = MotionRequest::Joint;
+  request.goal = request.limits.clamp(goal);
+  ++m_planGeneration; // Sustituye a una recta que aún se esté resolviendo
+  m_goal = request.goal;
+  m_hasGoal = true;
+  submitMotion(request);
+}
+
+void RobotHandler::moveLinear(const LinearMove &move) {
+  if (!SerialPortHandler::instance().isConnected()) {
+    emit errorOccurred("Cannot move: serial port not connected");
+    return;
+  }
+  if (!ensurePose())
+    return;
 
-  // Aplicar transformaci�n total RTbt
-  cv::Mat puntoGlobal = RTbt.inv() * puntoHom;
+  // Cientos de soluciones de la cinemática inversa: se resuelven en m_planPool y no en el periodo
+  // de control. La recta sale de donde quedará la consigna al terminar lo ya pedido
+  MotionRequest request = motionRequest();
+  request.kind = MotionRequest::Path;
+  const JointAngles start = m_hasGoal ? m_goal : m_controlLoop->endPose();
+  const RobotGeometry geometry = m_geometry;
+  const std::shared_ptr<const WorkspaceMap> workspace = workspaceMap();
+  const int generation = ++m_planGeneration;
+  m_hasGoal = false;
+
+  m_planPool.start([this, request, start, move, geometry, workspace, generation]() {
+    const LinearPlan plan =
+        TrajectoryPlanner::planLinearMove(start, move, request.limits, request.motion, geometry, workspace.get());
+    QMetaObject::invokeMethod(this, [this, request, plan, generation]() { onLinearPlanned(request, plan, generation); }, Qt::QueuedConnection);
+  });
+}
+
+void RobotHandler::onLinearPlanned(MotionRequest request, const LinearPlan &plan, int generation) {
+  // Otro movimiento, una parada o una desconexión posteriores dejan obsoleta esta recta
+  if (generation != m_planGeneration)
+    return;
 
-  // Devolver el punto transformado (coordenadas en la base del robot)
-  return cv::Point3d(puntoGlobal.at<double>(0, 0), puntoGlobal.at<double>(1, 0),
-                     puntoGlobal.at<double>(2, 0));
+  if (plan.status != LinearPlan::Ok) {
+    static const char *const REASONS[] = {"ok", "outside the workspace", "no IK solution on the current branch",
+                                          "joint discontinuity (branch change or singularity)"};
+    emit errorOccurred(QString("Linear move rejected at waypoint %1 (%2, %3, %4): %5")
+                           .arg(plan.failedIndex)
+                           .arg(plan.failedPosition.x, 0, 'f', 1)
+                           .arg(plan.failedPosition.y, 0, 'f', 1)
+                           .arg(plan.failedPosition.z, 0, 'f', 1)
+                           .arg(REASONS[plan.status]));
+    return;
+  }
+
+  request.path = plan.trajectory;
+  m_goal = request.path.goal();
+  m_hasGoal = true;
+  submitMotion(request);
 }
 
-void RobotHandler::onDataSent(const QByteArray &data) {
-  if (m_serialConnected) {
-    qDebug() << "[Serial] Data sent:" << QString::fromUtf8(data);
+MotionRequest RobotHandler::motionRequest() const {
+  MotionRequest request;
+  request.motion = JointMotionLimits::fromSettings(*m_robotSettings);
+  request.limits = JointLimits::fromSettings(*m_robotSettings);
+  return request;
+}
+
+void RobotHandler::submitMotion(const MotionRequest &request) {
+  m_controlLoop->submit(request);
+}
+
+void RobotHandler::moveJointTo(int motorIndex, int angle) {
+  if (motorIndex < 1 || motorIndex > 6) {
+    emit errorOccurred(QString("Invalid servo index: %1").arg(motorIndex));
+    return;
   }
+
+  // El resto de articulaciones conserva el último destino pedido
+  JointAngles goal = m_hasGoal ? m_goal : m_controlLoop->endPose();
+  goal[motorIndex - 1] = angle;
+  moveTo(goal);
+}
+
+void RobotHandler::stopMotion() {
+  ++m_planGeneration;
+  m_hasGoal = false;
+  m_controlLoop->stopMotion();
 }
 
-RobotHandler::~RobotHandler() {}
+void RobotHandler::setControlRate(int hz) { m_controlLoop->setRate(hz); }
+
+ControlLoopStats RobotHandler::controlStats() const { return m_controlLoop->stats(); }
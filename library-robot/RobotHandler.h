@@ -1,7 +1,18 @@
 #ifndef ROBOTHANDLER_H
 #define ROBOTHANDLER_H
+#include "IkLookupTable.h"
+#include "RobotConfig.h"
+#include "RobotControlLoop.h"
+#include "RobotInverseKinematics.h"
+#include "RobotKinematics.h"
+#include "TrajectoryPlanner.h"
+#include "WorkspaceMap.h"
 #include <opencv2/opencv.hpp>
 #include <QObject>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+
 
 class RobotHandler : public QObject {
   Q_OBJECT
@@ -12,29 +23,51 @@ public:
   // Funcin para actualizar las matrices con los ngulos de los motores
 	void actualizarMatrices(const cv::Mat& q);
 
-	// Funcin para realizar la cinemtica inversa
-	void inverseCinematic(const cv::Point3d& efectorGlobal);
+	// Cinemtica inversa completa, partiendo de la pose actual y respetando los lmites de los motores
+	IkResult inverseCinematic(const IkTarget& target) const;
+	// Igual, pero con la semilla de la tabla precalculada: latencia constante, independiente de la pose actual.
+	// La primera llamada abre o genera la tabla en segundo plano; hasta que est lista se usa inverseCinematic
+	IkResult inverseCinematicFromTable(const IkTarget& target) const;
+
+	// Ajustes de los motores (lmites articulares); el propietario es MainWindow
+	void setRobotSettings(RobotConfig::RobotSettings* settings);
+	void setGeometry(const RobotGeometry& geometry);
+	const RobotGeometry& geometry() const;
+	JointAngles currentAngles() const;
+	// true cuando la pose de currentAngles es la leda del robot tras conectar
+	bool poseKnown() const;
+	// Mapa de alcance; nulo mientras se genera. Las dos cinemticas inversas lo consultan antes de iterar
+	std::shared_ptr<const WorkspaceMap> workspaceMap() const;
+
+	// Movimiento articular con perfil trapezoidal y llegada sincronizada; lo ejecuta el hilo de control
+	void moveTo(const JointAngles& goal);
+	void moveJointTo(int motorIndex, int angle);
+	// Recta de la pinza con waypoints resueltos por cinemtica inversa en m_planPool, fuera del hilo de
+	// control; un plan discontinuo se rechaza con errorOccurred
+	void moveLinear(const LinearMove& move);
+	void stopMotion();
+	// Frecuencia del hilo de control (RobotControlLoop::MIN_RATE_HZ..MAX_RATE_HZ) y sus medidas
+	void setControlRate(int hz);
+	ControlLoopStats controlStats() const;
 
 	cv::Point3d transformarPunto(const cv::Point3d& puntoLocal);
 
-  // Matrices de transformacin
-  cv::Mat RTb1;
-  cv::Mat RT12;
-  cv::Mat RT23;
-  cv::Mat RT35;
+  // Cinemtica directa de un lote de configuraciones, sin seales ni trazas
+  void forwardKinematicsBatch(const JointBatch& joints, EffectorBatch& effectors) const;
+
+  // Matrices de transformacin (tamao fijo, en la pila)
+  RobotKinematics::Transform RTb1 = RobotKinematics::Transform::eye();
+  RobotKinematics::Transform RT12 = RobotKinematics::Transform::eye();
+  RobotKinematics::Transform RT23 = RobotKinematics::Transform::eye();
+  RobotKinematics::Transform RT35 = RobotKinematics::Transform::eye();
 
   // Transformacin final 4x4
-  cv::Mat RTbt;
+  RobotKinematics::Transform RTbt = RobotKinematics::Transform::eye();
 
-  // Constantes de la geometra del robot
-  double a1 = 130;
-  double a2 = 125;
-  double a3 = 125;
-  double a5 = 130;
 
 private slots:
-	void onDataReceived(const QByteArray& data);
-	void onDataSent(const QByteArray& data);
+	void onTelemetryReceived(const SerialProtocol::Telemetry& telemetry);
+	void onSerialStatusChanged(bool connected);
 
 signals:
   void errorOccurred(const QString &error);
@@ -44,11 +77,52 @@ signals:
   void motorOffsetsChanged(int motorIndex, int offset);
   void allMotorsReset();
   void efectorPositionChanged(double x, double y, double z);
+  void motionFinished();
+  void controlStatsUpdated(const ControlLoopStats& stats);
 
 private:
   //Matriz de ngulos de los servomotores
   cv::Mat q;
+  JointAngles m_angles{}; // Los mismos ngulos que q, como semilla de la cinemtica inversa
+  RobotConfig::RobotSettings* m_robotSettings = nullptr;
+
+  // Constantes de la geometra del robot
+  RobotGeometry m_geometry;
+
+  // Tabla de cinemtica inversa y mapa de alcance; se publican desde m_ikPool
+  // (std::atomic_load/store). Cambiar la geometra o los lmites sube generation, lo que
+  // cancela la generacin en curso; tableGeneration es la ltima para la que se pidi la tabla
+  struct IkTableState {
+    std::shared_ptr<const IkLookupTable> table;
+    std::shared_ptr<const WorkspaceMap> workspaceMap;
+    std::atomic<int> generation{0};
+    std::atomic<int> tableGeneration{-1};
+  };
+  std::shared_ptr<IkTableState> m_ikTable = std::make_shared<IkTableState>();
+  // Un solo hilo, propio: no compite con el pool global ni retiene su cierre
+  mutable QThreadPool m_ikPool;
+  void refreshIkTable();
+  void requestIkTable() const;
+  bool isOutsideWorkspace(const IkTarget& target, IkResult& rejected) const;
   bool m_serialConnected = false;
+
+  // Pose real leda al conectar (READ:ANGLES_WITH_OFFSET); sin ella no se acepta ningn movimiento
+  bool m_poseKnown = false;
+  bool m_poseRequested = false;
+  void requestPose();
+  bool ensurePose();
+
+  // Hilo de control de trayectorias y ltimo destino pedido
+  RobotControlLoop* m_controlLoop = nullptr;
+  JointAngles m_goal{};
+  bool m_hasGoal = false;
+  MotionRequest motionRequest() const;
+  void submitMotion(const MotionRequest& request);
+
+  // Planificacin de rectas; cada movimiento o parada sube m_planGeneration y descarta la que est en curso
+  QThreadPool m_planPool;
+  int m_planGeneration = 0;
+  void onLinearPlanned(MotionRequest request, const LinearPlan& plan, int generation);
 };
 
 #endif // ROBOTHANDLER_H
@@ -0,0 +1,166 @@
+#include "RobotInverseKinematics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+const double DEG_TO_RAD    = M_PI / 180.0;
+const double RAD_TO_DEG    = 180.0 / M_PI;
+const double PITCH_WEIGHT  = 100.0; // mm por radián: peso del error de inclinación frente al de posición
+const double MIN_DAMPING   = 1e-3;
+const double MAX_DAMPING   = 1e4;
+const double LIMIT_EPSILON = 1e-9;
+
+const int ACTIVE_JOINTS[4] = {0, 1, 2, 4}; // q1, q2, q3, q5: las que desplazan la pinza
+
+// Error ponderado (x, y, z, inclinación) y su Jacobiano respecto a las articulaciones activas en radianes
+struct Evaluation
+{
+  cv::Vec4d   error;
+  cv::Matx44d jacobian;
+  double      cost;
+  double      residual;
+  double      pitchResidual;
+};
+
+double wrapAngle(double angle)
+{
+  return std::remainder(angle, 2.0 * M_PI);
+}
+
+Evaluation evaluate(const JointAngles& q, const IkTarget& target, const RobotGeometry& g)
+{
+  const double q1   = q[0] * DEG_TO_RAD;
+  const double q2   = q[1] * DEG_TO_RAD;
+  const double q23  = q2 + q[2] * DEG_TO_RAD;
+  const double q235 = q23 + q[4] * DEG_TO_RAD;
+
+  const double c1   = std::cos(q1);
+  const double s1   = std::sin(q1);
+  const double c2   = std::cos(q2);
+  const double s2   = std::sin(q2);
+  const double c23  = std::cos(q23);
+  const double s23  = std::sin(q23);
+  const double c235 = std::cos(q235);
+  const double s235 = std::sin(q235);
+
+  // Proyecciones horizontal (r) y vertical de los eslabones a partir de cada articulación
+  const double r5 = g.a5 * s235;
+  const double r3 = g.a3 * s23 + r5;
+  const double r  = g.a2 * s2 + r3;
+  const double h5 = g.a5 * c235;
+  const double h3 = g.a3 * c23 + h5;
+  const double h  = g.a2 * c2 + h3;
+
+  Evaluation result;
+  result.error = cv::Vec4d(target.position.x - c1 * r, target.position.y - s1 * r, target.position.z - (g.a1 + h), 0.0);
+
+  // Columnas: d/dq1, d/dq2, d/dq3, d/dq5
+  result.jacobian = cv::Matx44d(-s1 * r, c1 * h, c1 * h3, c1 * h5,
+                                c1 * r, s1 * h, s1 * h3, s1 * h5,
+                                0, -r, -r3, -r5,
+                                0, 0, 0, 0);
+
+  result.residual      = std::sqrt(result.error[0] * result.error[0] + result.error[1] * result.error[1] + result.error[2] * result.error[2]);
+  result.pitchResidual = 0.0;
+  if (target.constrainPitch) {
+    const double pitchError = wrapAngle(target.pitch * DEG_TO_RAD - q235);
+    result.error[3]         = PITCH_WEIGHT * pitchError;
+    result.jacobian(3, 1)   = PITCH_WEIGHT;
+    result.jacobian(3, 2)   = PITCH_WEIGHT;
+    result.jacobian(3, 3)   = PITCH_WEIGHT;
+    result.pitchResidual    = std::abs(pitchError) * RAD_TO_DEG;
+  }
+  result.cost = result.error.dot(result.error);
+  return result;
+}
+
+bool isConverged(const Evaluation& evaluation, const IkTarget& target, const IkOptions& options)
+{
+  return evaluation.residual <= options.tolerance && (!target.constrainPitch || evaluation.pitchResidual <= options.pitchTolerance);
+}
+
+// Paso amortiguado: dq = J^T (J J^T + lambda^2 I)^-1 e
+cv::Vec4d dampedStep(const cv::Matx44d& jacobian, const cv::Vec4d& error, double damping)
+{
+  cv::Matx44d system = jacobian * jacobian.t();
+  for (int i = 0; i < 4; ++i)
+    system(i, i) += damping * damping;
+  return jacobian.t() * system.solve(error, cv::DECOMP_CHOLESKY);
+}
+} // namespace
+
+JointLimits JointLimits::fromSettings(const RobotConfig::RobotSettings& settings)
+{
+  JointLimits limits;
+  for (size_t i = 0; i < limits.min.size(); ++i) {
+    limits.min[i] = settings.motors[i].minAngle;
+    limits.max[i] = settings.motors[i].maxAngle;
+  }
+  return limits;
+}
+
+JointAngles JointLimits::clamp(const JointAngles& q) const
+{
+  JointAngles clamped;
+  for (size_t i = 0; i < q.size(); ++i)
+    clamped[i] = std::min(max[i], std::max(min[i], q[i]));
+  return clamped;
+}
+
+namespace RobotKinematics
+{
+IkResult solveInverse(const IkTarget& target, const JointAngles& seed, const JointLimits& limits, const RobotGeometry& geometry,
+                      const IkOptions& options)
+{
+  IkResult result;
+  JointAngles q       = limits.clamp(seed);
+  Evaluation  current = evaluate(q, target, geometry);
+  double      damping = options.damping;
+
+  while (!isConverged(current, target, options) && result.iterations < options.maxIterations) {
+    ++result.iterations;
+
+    // Las articulaciones apoyadas en un límite hacia el que empuja el paso se bloquean y se
+    // repite el paso con las demás
+    cv::Matx44d jacobian = current.jacobian;
+    cv::Vec4d   step     = dampedStep(jacobian, current.error, damping);
+    bool        locked   = false;
+    for (int k = 0; k < 4; ++k) {
+      const int joint = ACTIVE_JOINTS[k];
+      if ((step[k] < 0 && q[joint] <= limits.min[joint] + LIMIT_EPSILON) || (step[k] > 0 && q[joint] >= limits.max[joint] - LIMIT_EPSILON)) {
+        for (int row = 0; row < 4; ++row)
+          jacobian(row, k) = 0.0;
+        locked = true;
+      }
+    }
+    if (locked)
+      step = dampedStep(jacobian, current.error, damping);
+
+    JointAngles candidate = q;
+    for (int k = 0; k < 4; ++k)
+      candidate[ACTIVE_JOINTS[k]] += step[k] * RAD_TO_DEG;
+    candidate = limits.clamp(candidate);
+
+    // Levenberg-Marquardt: si el paso mejora se acepta y se relaja el amortiguamiento; si no,
+    // se descarta y se amortigua más
+    const Evaluation next = evaluate(candidate, target, geometry);
+    if (next.cost < current.cost) {
+      q       = candidate;
+      current = next;
+      damping = std::max(MIN_DAMPING, damping * 0.5);
+    }
+    else {
+      damping *= 4.0;
+      if (damping > MAX_DAMPING)
+        break; // Mínimo local o límite: no hay paso que mejore
+    }
+  }
+
+  result.angles        = q;
+  result.converged     = isConverged(current, target, options);
+  result.residual      = current.residual;
+  result.pitchResidual = current.pitchResidual;
+  return result;
+}
+} // namespace RobotKinematics
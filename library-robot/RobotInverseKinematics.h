@@ -0,0 +1,58 @@
+#ifndef ROBOTINVERSEKINEMATICS_H
+#define ROBOTINVERSEKINEMATICS_H
+
+#include "RobotConfig.h"
+#include "RobotKinematics.h"
+#include <opencv2/core.hpp>
+
+// Límites articulares en grados, en el mismo orden y unidades que JointAngles
+struct JointLimits
+{
+  JointAngles min{};
+  JointAngles max{};
+
+  static JointLimits fromSettings(const RobotConfig::RobotSettings& settings);
+  JointAngles        clamp(const JointAngles& q) const;
+};
+
+// Objetivo de la pinza respecto a la base
+struct IkTarget
+{
+  cv::Point3d position;               // mm
+  bool        constrainPitch = false; // Fijar también la inclinación de la pinza
+  double      pitch          = 0.0;   // Grados, q2 + q3 + q5; 0 es la pinza apuntando hacia +z
+};
+
+struct IkOptions
+{
+  int    maxIterations  = 100;
+  double tolerance      = 0.05; // mm
+  double pitchTolerance = 0.1;  // Grados
+  double damping        = 1.0;  // Amortiguamiento inicial (mm); se adapta en cada iteración
+};
+
+struct IkResult
+{
+  JointAngles angles{};            // Solución, o la mejor aproximación encontrada, dentro de los límites
+  bool        converged     = false;
+  int         iterations    = 0;
+  double      residual      = 0.0; // mm, distancia entre la pinza y el objetivo
+  double      pitchResidual = 0.0; // Grados, solo si el objetivo fija la inclinación
+};
+
+namespace RobotKinematics
+{
+/**
+ * @brief Cinemática inversa por mínimos cuadrados amortiguados (Levenberg-Marquardt) sobre el
+ * Jacobiano analítico de effectorPosition.
+ * @details Parte de seed (normalmente la pose actual, así las soluciones son continuas y
+ * convergen en pocas iteraciones). Resuelve q1, q2, q3 y q5; q4 y q6 no mueven la pinza y se
+ * conservan de seed. Los límites se respetan en cada paso: las articulaciones apoyadas en un
+ * límite hacia el que empuja el paso se bloquean y el resto compensa. Si el objetivo no es
+ * alcanzable devuelve la configuración más cercana con converged = false. No reserva memoria.
+ */
+IkResult solveInverse(const IkTarget& target, const JointAngles& seed, const JointLimits& limits, const RobotGeometry& geometry,
+                      const IkOptions& options = IkOptions());
+} // namespace RobotKinematics
+
+#endif // ROBOTINVERSEKINEMATICS_H
@@ -0,0 +1,220 @@
+#include "RobotKinematics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+const double DEG_TO_RAD  = M_PI / 180.0;
+const size_t BATCH_BLOCK = 256; // Configuraciones por bloque: los temporales caben en la caché L1
+
+// Reducción de rango: x = n * pi/2 + r, con |r| <= pi/4 y pi/2 partido en dos (Cody-Waite)
+const double TWO_OVER_PI = 0.63661977236758134308;
+const double PIO2_HI     = 1.5707963267948966;
+const double PIO2_LO     = 6.123233995736766e-17;
+const double ROUND_MAGIC = 6755399441055744.0; // 1.5 * 2^52: sumarlo y restarlo redondea al entero más cercano
+
+// Giro alrededor de z con traslación -length en z
+RobotKinematics::Transform rotationZ(double angle, double length)
+{
+  const double c = std::cos(angle);
+  const double s = std::sin(angle);
+  return RobotKinematics::Transform(c, -s, 0, 0,
+                                    s, c, 0, 0,
+                                    0, 0, 1, -length,
+                                    0, 0, 0, 1);
+}
+
+// Giro alrededor de y con traslación -length en z
+RobotKinematics::Transform rotationY(double angle, double length)
+{
+  const double c = std::cos(angle);
+  const double s = std::sin(angle);
+  return RobotKinematics::Transform(c, 0, s, 0,
+                                    0, 1, 0, 0,
+                                    -s, 0, c, -length,
+                                    0, 0, 0, 1);
+}
+} // namespace
+
+void JointBatch::resize(size_t count)
+{
+  q1.resize(count);
+  q2.resize(count);
+  q3.resize(count);
+  q5.resize(count);
+}
+
+size_t JointBatch::size() const
+{
+  return q1.size();
+}
+
+void EffectorBatch::resize(size_t count)
+{
+  x.resize(count);
+  y.resize(count);
+  z.resize(count);
+  ax.resize(count);
+  ay.resize(count);
+  az.resize(count);
+}
+
+size_t EffectorBatch::size() const
+{
+  return x.size();
+}
+
+namespace RobotKinematics
+{
+/**
+ * @brief Cadena completa, con los ángulos negados como los monta el brazo.
+ */
+Chain forwardChain(const JointAngles& q, const RobotGeometry& geometry)
+{
+  Chain chain;
+  chain.RTb1 = rotationZ(-q[0] * DEG_TO_RAD, geometry.a1);
+  chain.RT12 = rotationY(-q[1] * DEG_TO_RAD, geometry.a2);
+  chain.RT23 = rotationY(-q[2] * DEG_TO_RAD, geometry.a3);
+  chain.RT35 = rotationY(-q[4] * DEG_TO_RAD, geometry.a5);
+  chain.RTbt = chain.RT35 * chain.RT23 * chain.RT12 * chain.RTb1;
+  return chain;
+}
+
+/**
+ * @brief Desarrollo de rigidInverse(RTbt): los tres giros en y se suman, así que la pose es
+ * Rz(q1) * Ry(q2 + q3 + q5) y la posición sale de las proyecciones de cada eslabón.
+ */
+Transform effectorPose(const JointAngles& q, const RobotGeometry& geometry)
+{
+  const double q1   = q[0] * DEG_TO_RAD;
+  const double q2   = q[1] * DEG_TO_RAD;
+  const double q23  = q2 + q[2] * DEG_TO_RAD;
+  const double q235 = q23 + q[4] * DEG_TO_RAD;
+
+  const double c1   = std::cos(q1);
+  const double s1   = std::sin(q1);
+  const double c2   = std::cos(q2);
+  const double s2   = std::sin(q2);
+  const double c23  = std::cos(q23);
+  const double s23  = std::sin(q23);
+  const double c235 = std::cos(q235);
+  const double s235 = std::sin(q235);
+
+  const double r = geometry.a2 * s2 + geometry.a3 * s23 + geometry.a5 * s235;
+  const double z = geometry.a1 + geometry.a2 * c2 + geometry.a3 * c23 + geometry.a5 * c235;
+
+  return Transform(c1 * c235, -s1, c1 * s235, c1 * r,
+                   s1 * c235, c1, s1 * s235, s1 * r,
+                   -s235, 0, c235, z,
+                   0, 0, 0, 1);
+}
+
+cv::Point3d effectorPosition(const JointAngles& q, const RobotGeometry& geometry)
+{
+  const double q1   = q[0] * DEG_TO_RAD;
+  const double q2   = q[1] * DEG_TO_RAD;
+  const double q23  = q2 + q[2] * DEG_TO_RAD;
+  const double q235 = q23 + q[4] * DEG_TO_RAD;
+
+  const double r = geometry.a2 * std::sin(q2) + geometry.a3 * std::sin(q23) + geometry.a5 * std::sin(q235);
+  const double z = geometry.a1 + geometry.a2 * std::cos(q2) + geometry.a3 * std::cos(q23) + geometry.a5 * std::cos(q235);
+  return cv::Point3d(std::cos(q1) * r, std::sin(q1) * r, z);
+}
+
+Transform rigidInverse(const Transform& t)
+{
+  // -R^T t
+  const double x = -(t(0, 0) * t(0, 3) + t(1, 0) * t(1, 3) + t(2, 0) * t(2, 3));
+  const double y = -(t(0, 1) * t(0, 3) + t(1, 1) * t(1, 3) + t(2, 1) * t(2, 3));
+  const double z = -(t(0, 2) * t(0, 3) + t(1, 2) * t(1, 3) + t(2, 2) * t(2, 3));
+
+  return Transform(t(0, 0), t(1, 0), t(2, 0), x,
+                   t(0, 1), t(1, 1), t(2, 1), y,
+                   t(0, 2), t(1, 2), t(2, 2), z,
+                   0, 0, 0, 1);
+}
+
+cv::Point3d transformPoint(const Transform& t, const cv::Point3d& p)
+{
+  return cv::Point3d(t(0, 0) * p.x + t(0, 1) * p.y + t(0, 2) * p.z + t(0, 3),
+                     t(1, 0) * p.x + t(1, 1) * p.y + t(1, 2) * p.z + t(1, 3),
+                     t(2, 0) * p.x + t(2, 1) * p.y + t(2, 2) * p.z + t(2, 3));
+}
+/**
+ * @brief Seno y coseno sin ramas ni llamadas a libm, para que el bucle se vectorice.
+ * @details Tras la reducción de rango se evalúan los desarrollos de Taylor hasta r^15 y r^16
+ * (error < 2e-15 en |r| <= pi/4) y el cuadrante n mod 4 decide qué polinomio y qué signo
+ * corresponden a cada función.
+ */
+void sinCosBatch(const double* angles, double* sines, double* cosines, size_t count)
+{
+  for (size_t i = 0; i < count; ++i) {
+    const double n  = (angles[i] * TWO_OVER_PI + ROUND_MAGIC) - ROUND_MAGIC;
+    const double r  = (angles[i] - n * PIO2_HI) - n * PIO2_LO;
+    const double r2 = r * r;
+
+    const double s =
+      r + r * r2 * (-1.0 / 6 + r2 * (1.0 / 120 + r2 * (-1.0 / 5040 + r2 * (1.0 / 362880 + r2 * (-1.0 / 39916800 + r2 * (1.0 / 6227020800 + r2 * (-1.0 / 1307674368000)))))));
+    const double c =
+      1.0 + r2 * (-0.5 + r2 * (1.0 / 24 + r2 * (-1.0 / 720 + r2 * (1.0 / 40320 + r2 * (-1.0 / 3628800 + r2 * (1.0 / 479001600 + r2 * (-1.0 / 87178291200 + r2 * (1.0 / 20922789888000))))))));
+
+    const int    quadrant = static_cast<int>(n);
+    const double sinValue = (quadrant & 1) ? c : s;
+    const double cosValue = (quadrant & 1) ? s : c;
+    sines[i]              = (quadrant & 2) ? -sinValue : sinValue;
+    cosines[i]            = ((quadrant + 1) & 2) ? -cosValue : cosValue;
+  }
+}
+
+/**
+ * @brief Cinemática directa de un lote, por bloques: primero los ángulos acumulados, después
+ * sus senos y cosenos y por último las proyecciones de cada eslabón. Cada paso es un bucle
+ * simple sobre arrays contiguos.
+ */
+void forwardBatch(const JointBatch& joints, const RobotGeometry& geometry, EffectorBatch& effectors)
+{
+  const size_t count = joints.size();
+  if (effectors.size() != count)
+    effectors.resize(count);
+
+  alignas(64) double angle1[BATCH_BLOCK], angle2[BATCH_BLOCK], angle23[BATCH_BLOCK], angle235[BATCH_BLOCK];
+  alignas(64) double s1[BATCH_BLOCK], s2[BATCH_BLOCK], s23[BATCH_BLOCK], s235[BATCH_BLOCK];
+  alignas(64) double c1[BATCH_BLOCK], c2[BATCH_BLOCK], c23[BATCH_BLOCK], c235[BATCH_BLOCK];
+
+  for (size_t begin = 0; begin < count; begin += BATCH_BLOCK) {
+    const size_t n = std::min(BATCH_BLOCK, count - begin);
+
+    const double* q1 = joints.q1.data() + begin;
+    const double* q2 = joints.q2.data() + begin;
+    const double* q3 = joints.q3.data() + begin;
+    const double* q5 = joints.q5.data() + begin;
+    for (size_t i = 0; i < n; ++i) {
+      angle1[i]   = q1[i] * DEG_TO_RAD;
+      angle2[i]   = q2[i] * DEG_TO_RAD;
+      angle23[i]  = (q2[i] + q3[i]) * DEG_TO_RAD;
+      angle235[i] = (q2[i] + q3[i] + q5[i]) * DEG_TO_RAD;
+    }
+
+    sinCosBatch(angle1, s1, c1, n);
+    sinCosBatch(angle2, s2, c2, n);
+    sinCosBatch(angle23, s23, c23, n);
+    sinCosBatch(angle235, s235, c235, n);
+
+    double* x  = effectors.x.data() + begin;
+    double* y  = effectors.y.data() + begin;
+    double* z  = effectors.z.data() + begin;
+    double* ax = effectors.ax.data() + begin;
+    double* ay = effectors.ay.data() + begin;
+    double* az = effectors.az.data() + begin;
+    for (size_t i = 0; i < n; ++i) {
+      const double r = geometry.a2 * s2[i] + geometry.a3 * s23[i] + geometry.a5 * s235[i];
+      x[i]           = c1[i] * r;
+      y[i]           = s1[i] * r;
+      z[i]           = geometry.a1 + geometry.a2 * c2[i] + geometry.a3 * c23[i] + geometry.a5 * c235[i];
+      ax[i]          = c1[i] * s235[i];
+      ay[i]          = s1[i] * s235[i];
+      az[i]          = c235[i];
+    }
+  }
+}
+} // namespace RobotKinematics
@@ -0,0 +1,89 @@
+#ifndef ROBOTKINEMATICS_H
+#define ROBOTKINEMATICS_H
+
+#include <array>
+#include <cstddef>
+#include <opencv2/core.hpp>
+#include <vector>
+
+// Longitudes de los eslabones del brazo (mm)
+struct RobotGeometry
+{
+  double a1 = 130; // Base al hombro
+  double a2 = 125; // Hombro al codo
+  double a3 = 125; // Codo a la muñeca
+  double a5 = 130; // Muñeca a la pinza
+};
+
+// Ángulos de los seis servos en grados (q1..q6), en el orden de los mensajes serie
+using JointAngles = std::array<double, 6>;
+
+// Lote de vectores articulares en formato SoA: un vector por articulación, en grados
+struct JointBatch
+{
+  std::vector<double> q1;
+  std::vector<double> q2;
+  std::vector<double> q3;
+  std::vector<double> q5;
+
+  void   resize(size_t count);
+  size_t size() const;
+};
+
+/**
+ * @brief Resultado de un lote de cinemática directa.
+ * @details La orientación de la pinza es Rz(q1) * Ry(q2 + q3 + q5); (ax, ay, az) es su eje de
+ * aproximación, la tercera columna de esa rotación.
+ */
+struct EffectorBatch
+{
+  std::vector<double> x; // mm
+  std::vector<double> y;
+  std::vector<double> z;
+  std::vector<double> ax; // Vector unitario
+  std::vector<double> ay;
+  std::vector<double> az;
+
+  void   resize(size_t count);
+  size_t size() const;
+};
+
+/**
+ * @brief Cinemática directa del brazo sobre matrices de tamaño fijo.
+ * @details Todo se calcula en la pila con cv::Matx44d: no hay reservas de memoria, así que se
+ * puede llamar dentro de bucles de control. q4 (giro de muñeca) y q6 (pinza) no desplazan el
+ * efector y se ignoran. Para muestrear el espacio de trabajo o validar trayectorias, forwardBatch
+ * evalúa millones de configuraciones sin pasar por RobotHandler ni por sus señales.
+ */
+namespace RobotKinematics
+{
+using Transform = cv::Matx44d;
+
+// Transformaciones de cada eslabón y la total, con la misma convención que RobotHandler
+struct Chain
+{
+  Transform RTb1; // Base al primer eslabón
+  Transform RT12; // Primer eslabón al segundo
+  Transform RT23; // Segundo al tercero
+  Transform RT35; // Tercero al efector final
+  Transform RTbt; // RT35 * RT23 * RT12 * RTb1
+};
+
+Chain forwardChain(const JointAngles& q, const RobotGeometry& geometry);
+
+// Pose de la pinza respecto a la base (la inversa de RTbt), en forma cerrada
+Transform effectorPose(const JointAngles& q, const RobotGeometry& geometry);
+// Solo la posición de la pinza: la forma más barata, para bucles de control
+cv::Point3d effectorPosition(const JointAngles& q, const RobotGeometry& geometry);
+
+// Misma cuenta que effectorPosition para un lote completo; effectors se redimensiona si hace falta
+void forwardBatch(const JointBatch& joints, const RobotGeometry& geometry, EffectorBatch& effectors);
+// Seno y coseno de count ángulos en radianes, con polinomios que el compilador vectoriza
+void sinCosBatch(const double* angles, double* sines, double* cosines, size_t count);
+
+// Inversa de una transformación rígida [R | t] -> [R^T | -R^T t], sin factorizar la matriz
+Transform   rigidInverse(const Transform& transform);
+cv::Point3d transformPoint(const Transform& transform, const cv::Point3d& point);
+} // namespace RobotKinematics
+
+#endif // ROBOTKINEMATICS_H
@@ -0,0 +1,61 @@
+#include "SetpointFilter.h"
+#include <algorithm>
+#include <cmath>
+
+void JerkLimitedFilter::configure(const std::array<double, 6>& windowSeconds, double tickSeconds)
+{
+  bool changed = false;
+  for (size_t i = 0; i < m_channels.size(); ++i) {
+    const size_t length = std::max<size_t>(1, static_cast<size_t>(std::lround(windowSeconds[i] / tickSeconds)));
+    if (length != m_channels[i].samples.size()) {
+      m_channels[i].samples.assign(length, 0.0);
+      changed = true;
+    }
+  }
+  if (changed)
+    reset(m_output);
+}
+
+void JerkLimitedFilter::reset(const JointAngles& pose)
+{
+  m_longest = 1;
+  for (size_t i = 0; i < m_channels.size(); ++i) {
+    Channel& channel = m_channels[i];
+    std::fill(channel.samples.begin(), channel.samples.end(), pose[i]);
+    channel.head = 0;
+    channel.sum  = pose[i] * double(channel.samples.size());
+    m_longest    = std::max(m_longest, channel.samples.size());
+  }
+  m_output      = pose;
+  m_lastInput   = pose;
+  m_steadyTicks = m_longest;
+}
+
+const JointAngles& JerkLimitedFilter::update(const JointAngles& setpoint)
+{
+  m_steadyTicks = setpoint == m_lastInput ? m_steadyTicks + 1 : 1;
+  m_lastInput   = setpoint;
+
+  for (size_t i = 0; i < m_channels.size(); ++i) {
+    Channel& channel = m_channels[i];
+    // Suma acumulada: O(1) por muestra; el error de redondeo se anula al vaciar la ventana
+    channel.sum += setpoint[i] - channel.samples[channel.head];
+    channel.samples[channel.head] = setpoint[i];
+    channel.head                  = (channel.head + 1) % channel.samples.size();
+    m_output[i]                   = channel.sum / double(channel.samples.size());
+  }
+
+  if (settled())
+    m_output = setpoint;
+  return m_output;
+}
+
+const JointAngles& JerkLimitedFilter::output() const
+{
+  return m_output;
+}
+
+bool JerkLimitedFilter::settled() const
+{
+  return m_steadyTicks >= m_longest;
+}
@@ -0,0 +1,45 @@
+#ifndef SETPOINTFILTER_H
+#define SETPOINTFILTER_H
+
+#include "RobotKinematics.h"
+#include <array>
+#include <vector>
+
+/**
+ * @brief Suavizado de consignas articulares con jerk limitado, un paso por periodo de control.
+ * @details Es una media móvil por articulación de longitud T = aceleración / jerk. Como las
+ * consignas de entrada ya salen del planificador con la aceleración limitada, cada escalón de
+ * aceleración se convierte en una rampa de duración T y el jerk queda acotado por
+ * aceleración / T, sin sobrepasar el destino (la media de valores en [a, b] no sale de [a, b]).
+ * El precio es un retraso de T/2 y T más de duración por movimiento.
+ */
+class JerkLimitedFilter
+{
+public:
+  // Ventana de cada articulación en segundos y periodo del control; si no cambian las longitudes
+  // en muestras, el estado se conserva
+  void configure(const std::array<double, 6>& windowSeconds, double tickSeconds);
+  // Fija la salida en pose sin transitorio
+  void reset(const JointAngles& pose);
+
+  const JointAngles& update(const JointAngles& setpoint);
+  const JointAngles& output() const;
+  // La ventana entera contiene ya la última consigna
+  bool settled() const;
+
+private:
+  struct Channel
+  {
+    std::vector<double> samples{0.0};
+    size_t              head = 0;
+    double              sum  = 0.0;
+  };
+
+  std::array<Channel, 6> m_channels;
+  JointAngles            m_output{};
+  JointAngles            m_lastInput{};
+  size_t                 m_steadyTicks = 1;
+  size_t                 m_longest     = 1;
+};
+
+#endif // SETPOINTFILTER_H
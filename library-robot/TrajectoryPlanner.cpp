@@ -0,0 +1,231 @@
+#include "TrajectoryPlanner.h"
+#include "WorkspaceMap.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+const double MIN_VELOCITY     = 1.0; // grados/s: un ajuste a 0 no debe dejar el motor parado para siempre
+const double MIN_ACCELERATION = 1.0; // grados/s²
+const double MIN_JERK         = 1.0; // grados/s³
+const double CONTINUITY_SLACK = 1.5; // Margen sobre el salto articular permitido entre waypoints
+
+/**
+ * @brief Perfil de una articulación que recorre distance en exactamente duration segundos,
+ * con la aceleración máxima y la menor velocidad de crucero que lo consigue.
+ * @details De d = v·(T - v/a) sale v = (a·T - sqrt(a²·T² - 4·a·d)) / 2; como T no es menor que
+ * el tiempo mínimo de la articulación, el discriminante no es negativo salvo por redondeo.
+ */
+TrapezoidProfile synchronizedProfile(double start, double distance, double acceleration, double duration)
+{
+  TrapezoidProfile profile;
+  profile.start        = start;
+  profile.distance     = distance;
+  profile.acceleration = acceleration;
+  profile.duration     = duration;
+
+  const double d = std::abs(distance);
+  if (d <= 0.0 || duration <= 0.0)
+    return profile;
+
+  const double discriminant = std::max(0.0, acceleration * acceleration * duration * duration - 4.0 * acceleration * d);
+  profile.velocity          = 0.5 * (acceleration * duration - std::sqrt(discriminant));
+  profile.accelTime         = profile.velocity / acceleration;
+  return profile;
+}
+} // namespace
+
+JointMotionLimits JointMotionLimits::fromSettings(const RobotConfig::RobotSettings& settings)
+{
+  JointMotionLimits limits;
+  for (size_t i = 0; i < limits.velocity.size(); ++i) {
+    limits.velocity[i]     = std::max(MIN_VELOCITY, double(settings.motors[i].speed));
+    limits.acceleration[i] = std::max(MIN_ACCELERATION, double(settings.motors[i].acceleration));
+    limits.jerk[i]         = std::max(MIN_JERK, double(settings.motors[i].jerk));
+  }
+  return limits;
+}
+
+std::array<double, 6> JointMotionLimits::smoothingWindows() const
+{
+  std::array<double, 6> windows;
+  for (size_t i = 0; i < windows.size(); ++i)
+    windows[i] = jerk[i] > 0.0 ? acceleration[i] / jerk[i] : 0.0;
+  return windows;
+}
+
+double TrapezoidProfile::position(double t) const
+{
+  const double sign = distance < 0.0 ? -1.0 : 1.0;
+  if (t <= 0.0 || velocity <= 0.0)
+    return t >= duration ? start + distance : start;
+  if (t >= duration)
+    return start + distance;
+
+  double travelled;
+  if (t < accelTime)
+    travelled = 0.5 * acceleration * t * t;
+  else if (t < duration - accelTime)
+    travelled = 0.5 * acceleration * accelTime * accelTime + velocity * (t - accelTime);
+  else {
+    const double remaining = duration - t;
+    travelled              = std::abs(distance) - 0.5 * acceleration * remaining * remaining;
+  }
+  return start + sign * travelled;
+}
+
+double TrapezoidProfile::speed(double t) const
+{
+  if (t <= 0.0 || t >= duration || velocity <= 0.0)
+    return 0.0;
+
+  const double sign = distance < 0.0 ? -1.0 : 1.0;
+  if (t < accelTime)
+    return sign * acceleration * t;
+  if (t < duration - accelTime)
+    return sign * velocity;
+  return sign * acceleration * (duration - t);
+}
+
+double WaypointTrajectory::duration() const
+{
+  return waypoints.size() < 2 ? 0.0 : period * double(waypoints.size() - 1);
+}
+
+JointAngles WaypointTrajectory::position(double t) const
+{
+  if (waypoints.empty())
+    return JointAngles{};
+  if (t <= 0.0 || waypoints.size() < 2)
+    return waypoints.front();
+  if (t >= duration())
+    return waypoints.back();
+
+  // t / period puede redondear hacia arriba hasta el último waypoint con t justo por debajo de duration()
+  const double segment  = t / period;
+  const size_t index    = std::min(static_cast<size_t>(segment), waypoints.size() - 2);
+  const double fraction = std::clamp(segment - double(index), 0.0, 1.0);
+  JointAngles  q;
+  for (size_t i = 0; i < q.size(); ++i)
+    q[i] = waypoints[index][i] + fraction * (waypoints[index + 1][i] - waypoints[index][i]);
+  return q;
+}
+
+JointAngles WaypointTrajectory::goal() const
+{
+  return waypoints.empty() ? JointAngles{} : waypoints.back();
+}
+
+JointAngles JointTrajectory::position(double t) const
+{
+  JointAngles q;
+  for (size_t i = 0; i < joints.size(); ++i)
+    q[i] = joints[i].position(t);
+  return q;
+}
+
+JointAngles JointTrajectory::velocity(double t) const
+{
+  JointAngles dq;
+  for (size_t i = 0; i < joints.size(); ++i)
+    dq[i] = joints[i].speed(t);
+  return dq;
+}
+
+JointAngles JointTrajectory::goal() const
+{
+  JointAngles q;
+  for (size_t i = 0; i < joints.size(); ++i)
+    q[i] = joints[i].start + joints[i].distance;
+  return q;
+}
+
+namespace TrajectoryPlanner
+{
+double minimumDuration(double distance, double velocity, double acceleration)
+{
+  const double d = std::abs(distance);
+  if (d <= 0.0)
+    return 0.0;
+
+  // Sin tiempo para llegar a la velocidad máxima el perfil es triangular
+  if (d <= velocity * velocity / acceleration)
+    return 2.0 * std::sqrt(d / acceleration);
+  return d / velocity + velocity / acceleration;
+}
+
+TrapezoidProfile planProfile(double distance, double velocity, double acceleration)
+{
+  velocity     = std::max(1e-6, velocity);
+  acceleration = std::max(1e-6, acceleration);
+  return synchronizedProfile(0.0, distance, acceleration, minimumDuration(distance, velocity, acceleration));
+}
+
+LinearPlan planLinearMove(const JointAngles& start, const LinearMove& move, const JointLimits& limits, const JointMotionLimits& motion,
+                          const RobotGeometry& geometry, const WorkspaceMap* workspace)
+{
+  LinearPlan plan;
+
+  const RobotKinematics::Transform pose   = RobotKinematics::effectorPose(start, geometry);
+  const cv::Point3d                origin = RobotKinematics::transformPoint(pose, cv::Point3d(0, 0, 0));
+  const cv::Point3d                delta  = move.target - origin;
+  const double                     length = cv::norm(delta);
+
+  // Tiempo de muestreo: el menor entre el periodo de control y el que deja LINEAR_MAX_STEP mm a la velocidad de crucero
+  const TrapezoidProfile profile = planProfile(length, move.speed, move.acceleration);
+  const double           period  = std::min(LINEAR_MAX_PERIOD, LINEAR_MAX_STEP / std::max(1e-6, move.speed));
+  const int              steps   = std::max(1, static_cast<int>(std::ceil(profile.duration / period)));
+  plan.trajectory.period         = profile.duration > 0.0 ? profile.duration / steps : period;
+  plan.trajectory.waypoints.reserve(size_t(steps) + 1);
+  plan.trajectory.waypoints.push_back(limits.clamp(start));
+
+  IkTarget target;
+  target.constrainPitch = move.keepPitch;
+  target.pitch          = start[1] + start[2] + start[4];
+
+  for (int k = 1; k <= steps; ++k) {
+    const double fraction = length > 0.0 ? profile.position(k * plan.trajectory.period) / length : 1.0;
+    target.position       = origin + delta * fraction;
+
+    if (workspace && !workspace->contains(target.position)) {
+      plan.status = LinearPlan::Unreachable;
+    }
+    else {
+      const JointAngles& previous = plan.trajectory.waypoints.back();
+      const IkResult     ik       = RobotKinematics::solveInverse(target, previous, limits, geometry);
+      if (!ik.converged) {
+        plan.status = LinearPlan::NoSolution;
+      }
+      else {
+        for (size_t i = 0; i < previous.size() && plan.status == LinearPlan::Ok; ++i) {
+          const double allowed = motion.velocity[i] * plan.trajectory.period * CONTINUITY_SLACK + 1e-3;
+          if (std::abs(ik.angles[i] - previous[i]) > allowed)
+            plan.status = LinearPlan::Discontinuity;
+        }
+        if (plan.status == LinearPlan::Ok)
+          plan.trajectory.waypoints.push_back(ik.angles);
+      }
+    }
+
+    if (plan.status != LinearPlan::Ok) {
+      plan.failedIndex    = k;
+      plan.failedPosition = target.position;
+      plan.trajectory.waypoints.clear();
+      return plan;
+    }
+  }
+  return plan;
+}
+
+JointTrajectory planJointMove(const JointAngles& start, const JointAngles& goal, const JointMotionLimits& limits)
+{
+  JointTrajectory trajectory;
+  for (size_t i = 0; i < start.size(); ++i)
+    trajectory.duration = std::max(trajectory.duration, minimumDuration(goal[i] - start[i], limits.velocity[i], limits.acceleration[i]));
+
+  // Cada articulación se estira hasta la duración común para que todas lleguen a la vez
+  for (size_t i = 0; i < start.size(); ++i)
+    trajectory.joints[i] = synchronizedProfile(start[i], goal[i] - start[i], limits.acceleration[i], trajectory.duration);
+  return trajectory;
+}
+} // namespace TrajectoryPlanner
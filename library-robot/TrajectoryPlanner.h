@@ -0,0 +1,117 @@
+#ifndef TRAJECTORYPLANNER_H
+#define TRAJECTORYPLANNER_H
+
+#include "RobotConfig.h"
+#include "RobotInverseKinematics.h"
+#include "RobotKinematics.h"
+#include <array>
+#include <opencv2/core.hpp>
+#include <vector>
+
+class WorkspaceMap;
+
+// Velocidad, aceleración y jerk máximos por articulación
+struct JointMotionLimits
+{
+  std::array<double, 6> velocity;     // grados/s
+  std::array<double, 6> acceleration; // grados/s²
+  std::array<double, 6> jerk;         // grados/s³
+
+  // MotorConfig::speed, MotorConfig::acceleration y MotorConfig::jerk
+  static JointMotionLimits fromSettings(const RobotConfig::RobotSettings& settings);
+  // Ventana del JerkLimitedFilter de cada articulación (aceleración / jerk)
+  std::array<double, 6> smoothingWindows() const;
+};
+
+// Perfil trapezoidal de velocidad de una articulación: acelera, crucero y frena
+struct TrapezoidProfile
+{
+  double start        = 0.0; // grados
+  double distance     = 0.0; // grados, con signo
+  double velocity     = 0.0; // Velocidad de crucero (grados/s, sin signo)
+  double acceleration = 0.0; // grados/s², sin signo
+  double accelTime    = 0.0; // Duración de la rampa de subida (y de la de bajada)
+  double duration     = 0.0;
+
+  double position(double t) const;
+  double speed(double t) const;
+};
+
+/**
+ * @brief Trayectoria articular punto a punto parametrizada en el tiempo.
+ * @details Todas las articulaciones comparten la duración de la más lenta, así que arrancan y
+ * llegan a la vez; fuera de [0, duration] la posición queda en el inicio o en el destino.
+ */
+struct JointTrajectory
+{
+  std::array<TrapezoidProfile, 6> joints;
+  double                          duration = 0.0; // s
+
+  JointAngles position(double t) const;
+  JointAngles velocity(double t) const;
+  JointAngles goal() const;
+};
+
+// Trayectoria dada por poses articulares equiespaciadas en el tiempo; entre dos se interpola linealmente
+struct WaypointTrajectory
+{
+  std::vector<JointAngles> waypoints;
+  double                   period = 0.0; // s entre waypoints
+
+  double      duration() const;
+  JointAngles position(double t) const;
+  JointAngles goal() const;
+};
+
+// Movimiento rectilíneo de la pinza hasta target
+struct LinearMove
+{
+  cv::Point3d target;
+  double      speed        = 50.0;  // mm/s
+  double      acceleration = 200.0; // mm/s²
+  bool        keepPitch    = false; // Mantener la inclinación de la pinza del punto de partida
+};
+
+struct LinearPlan
+{
+  enum Status
+  {
+    Ok,
+    Unreachable,  // Un waypoint cae fuera del mapa de alcance
+    NoSolution,   // La cinemática inversa no converge en un waypoint
+    Discontinuity // Dos soluciones seguidas exigen más velocidad articular de la permitida (cambio de rama o singularidad)
+  };
+
+  WaypointTrajectory trajectory;
+  Status             status      = Ok;
+  int                failedIndex = -1; // Waypoint donde falló
+  cv::Point3d        failedPosition;
+};
+
+namespace TrajectoryPlanner
+{
+// Perfil trapezoidal de tiempo mínimo para recorrer distance
+TrapezoidProfile planProfile(double distance, double velocity, double acceleration);
+
+/**
+ * @brief Recta desde la pose de la pinza en start hasta move.target, con perfil trapezoidal de
+ * velocidad sobre la longitud del camino.
+ * @details La recta se muestrea como mucho cada LINEAR_MAX_STEP mm y cada LINEAR_MAX_PERIOD s; cada
+ * waypoint se resuelve con la cinemática inversa partiendo del anterior, así que se mantiene la
+ * rama de la solución. Si dos soluciones seguidas se separan más de lo que permiten las
+ * velocidades articulares en ese intervalo, el plan se rechaza en lugar de dar un salto.
+ */
+LinearPlan planLinearMove(const JointAngles& start, const LinearMove& move, const JointLimits& limits, const JointMotionLimits& motion,
+                          const RobotGeometry& geometry, const WorkspaceMap* workspace = nullptr);
+
+const double LINEAR_MAX_STEP   = 2.0;  // mm entre waypoints
+const double LINEAR_MAX_PERIOD = 0.02; // s entre waypoints
+
+// Movimiento de reposo a reposo entre dos poses, con los límites de cada articulación
+JointTrajectory planJointMove(const JointAngles& start, const JointAngles& goal, const JointMotionLimits& limits);
+
+// Tiempo mínimo de una articulación que recorre distance grados con esos límites
+double minimumDuration(double distance, double velocity, double acceleration);
+} // namespace TrajectoryPlanner
+
+#endif // TRAJECTORYPLANNER_H
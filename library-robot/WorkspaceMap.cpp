@@ -0,0 +1,289 @@
+#include "WorkspaceMap.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+const size_t SAMPLE_BATCH     = 65536; // Configuraciones por llamada a forwardBatch
+const double RAD_TO_DEG       = 180.0 / M_PI;
+const int    PROFILE_DILATION = 2; // Celdas del perfil (medio vóxel cada una)
+
+struct FileHeader
+{
+  quint32 magic;
+  quint32 version;
+  double  geometry[4];
+  double  limitsMin[6];
+  double  limitsMax[6];
+  double  voxelSize;
+  qint32  dims[3];
+  quint32 reserved;
+};
+
+static_assert(sizeof(FileHeader) % 8 == 0, "FileHeader alineado a 8");
+
+void fillHeader(FileHeader& header, const RobotGeometry& geometry, const JointLimits& limits, double voxelSize, const cv::Vec3i& dims)
+{
+  std::memset(&header, 0, sizeof(header));
+  header.magic       = WorkspaceMap::MAGIC;
+  header.version     = WorkspaceMap::VERSION;
+  header.geometry[0] = geometry.a1;
+  header.geometry[1] = geometry.a2;
+  header.geometry[2] = geometry.a3;
+  header.geometry[3] = geometry.a5;
+  for (int i = 0; i < 6; ++i) {
+    header.limitsMin[i] = limits.min[i];
+    header.limitsMax[i] = limits.max[i];
+  }
+  header.voxelSize = voxelSize;
+  header.dims[0]   = dims[0];
+  header.dims[1]   = dims[1];
+  header.dims[2]   = dims[2];
+}
+
+// Caja que contiene todo el alcance; los vóxeles se centran en los puntos de la rejilla
+void gridFor(const RobotGeometry& geometry, double voxelSize, cv::Point3d& origin, cv::Vec3i& dims)
+{
+  const double reach = geometry.a2 + geometry.a3 + geometry.a5;
+  const int    count = static_cast<int>(std::ceil(2.0 * reach / voxelSize)) + 1;
+  origin             = cv::Point3d(-reach, -reach, geometry.a1 - reach);
+  dims               = cv::Vec3i(count, count, count);
+}
+
+size_t wordCount(const cv::Vec3i& dims)
+{
+  return (size_t(dims[0]) * dims[1] * dims[2] + 63) / 64;
+}
+
+// Perfil (r, z) alcanzable con q1 = 0, en celdas de la mitad del vóxel
+struct Profile
+{
+  double            rMin;
+  double            zMin;
+  double            cell;
+  int               width;
+  int               height;
+  std::vector<char> reachable;
+
+  bool at(double r, double z) const
+  {
+    const int i = static_cast<int>(std::floor((r - rMin) / cell));
+    const int j = static_cast<int>(std::floor((z - zMin) / cell));
+    return i >= 0 && j >= 0 && i < width && j < height && reachable[size_t(j) * width + i];
+  }
+};
+
+// Pasos necesarios para que un giro de la articulación no mueva la pinza más de una celda
+int sampleCount(double minAngle, double maxAngle, double lever, double cell)
+{
+  return std::max(2, static_cast<int>(std::ceil((maxAngle - minAngle) / RAD_TO_DEG * lever / cell)) + 1);
+}
+
+double sampleAngle(double minAngle, double maxAngle, int index, int count)
+{
+  return minAngle + (maxAngle - minAngle) * index / (count - 1);
+}
+
+/**
+ * @brief Barre q2, q3 y q5 dentro de sus límites con forwardBatch y marca la celda (r, z) de
+ * cada configuración.
+ */
+Profile buildProfile(const RobotGeometry& geometry, const JointLimits& limits, double cell)
+{
+  const double reach = geometry.a2 + geometry.a3 + geometry.a5;
+
+  Profile profile;
+  profile.rMin   = -reach;
+  profile.zMin   = geometry.a1 - reach;
+  profile.cell   = cell;
+  profile.width  = static_cast<int>(std::ceil(2.0 * reach / cell)) + 1;
+  profile.height = profile.width;
+  profile.reachable.assign(size_t(profile.width) * profile.height, 0);
+
+  const int n2 = sampleCount(limits.min[1], limits.max[1], geometry.a2 + geometry.a3 + geometry.a5, cell);
+  const int n3 = sampleCount(limits.min[2], limits.max[2], geometry.a3 + geometry.a5, cell);
+  const int n5 = sampleCount(limits.min[4], limits.max[4], geometry.a5, cell);
+
+  JointBatch    joints;
+  EffectorBatch effectors;
+  joints.resize(SAMPLE_BATCH);
+  std::fill(joints.q1.begin(), joints.q1.end(), 0.0);
+
+  const size_t total = size_t(n2) * n3 * n5;
+  for (size_t begin = 0; begin < total; begin += SAMPLE_BATCH) {
+    const size_t count = std::min(SAMPLE_BATCH, total - begin);
+    joints.resize(count);
+    for (size_t k = 0; k < count; ++k) {
+      const size_t index = begin + k;
+      joints.q2[k]       = sampleAngle(limits.min[1], limits.max[1], static_cast<int>(index / (size_t(n3) * n5)), n2);
+      joints.q3[k]       = sampleAngle(limits.min[2], limits.max[2], static_cast<int>((index / n5) % n3), n3);
+      joints.q5[k]       = sampleAngle(limits.min[4], limits.max[4], static_cast<int>(index % n5), n5);
+    }
+
+    RobotKinematics::forwardBatch(joints, geometry, effectors);
+
+    for (size_t k = 0; k < count; ++k) {
+      const int i = static_cast<int>(std::floor((effectors.x[k] - profile.rMin) / cell));
+      const int j = static_cast<int>(std::floor((effectors.z[k] - profile.zMin) / cell));
+      if (i >= 0 && j >= 0 && i < profile.width && j < profile.height)
+        profile.reachable[size_t(j) * profile.width + i] = 1;
+    }
+  }
+
+  // Se dilata un vóxel para que el muestreo por centros no descarte puntos alcanzables del
+  // borde: es preferible dejar pasar alguno que la cinemática inversa acabe rechazando
+  const std::vector<char> sampled = profile.reachable;
+  for (int j = 0; j < profile.height; ++j) {
+    for (int i = 0; i < profile.width; ++i) {
+      if (!sampled[size_t(j) * profile.width + i])
+        continue;
+      for (int dj = -PROFILE_DILATION; dj <= PROFILE_DILATION; ++dj) {
+        for (int di = -PROFILE_DILATION; di <= PROFILE_DILATION; ++di) {
+          const int ni = i + di;
+          const int nj = j + dj;
+          if (ni >= 0 && nj >= 0 && ni < profile.width && nj < profile.height)
+            profile.reachable[size_t(nj) * profile.width + ni] = 1;
+        }
+      }
+    }
+  }
+  return profile;
+}
+
+bool insideRange(double angle, double minAngle, double maxAngle)
+{
+  return angle >= minAngle && angle <= maxAngle;
+}
+} // namespace
+
+/**
+ * @brief Construye el mapa; con los límites por defecto son unos 25 millones de configuraciones
+ * de cinemática directa, un par de segundos en un núcleo.
+ */
+std::shared_ptr<const WorkspaceMap> WorkspaceMap::build(const RobotGeometry& geometry, const JointLimits& limits, double voxelSize)
+{
+  std::shared_ptr<WorkspaceMap> map(new WorkspaceMap());
+  map->m_geometry  = geometry;
+  map->m_limits    = limits;
+  map->m_voxelSize = voxelSize;
+  gridFor(geometry, voxelSize, map->m_origin, map->m_dims);
+  map->m_bits.assign(wordCount(map->m_dims), 0);
+
+  const Profile profile = buildProfile(geometry, limits, voxelSize / 2.0);
+
+  size_t index = 0;
+  for (int k = 0; k < map->m_dims[2]; ++k) {
+    const double z = map->m_origin.z + k * voxelSize;
+    for (int j = 0; j < map->m_dims[1]; ++j) {
+      const double y = map->m_origin.y + j * voxelSize;
+      for (int i = 0; i < map->m_dims[0]; ++i, ++index) {
+        const double x       = map->m_origin.x + i * voxelSize;
+        const double radius  = std::hypot(x, y);
+        const double azimuth = std::atan2(y, x) * RAD_TO_DEG;
+
+        // q1 = acimut con el brazo hacia delante, o q1 = acimut +-180 con el brazo hacia atrás
+        const bool reachable =
+          (insideRange(azimuth, limits.min[0], limits.max[0]) && profile.at(radius, z)) ||
+          ((insideRange(azimuth + 180.0, limits.min[0], limits.max[0]) || insideRange(azimuth - 180.0, limits.min[0], limits.max[0])) &&
+           profile.at(-radius, z));
+        if (reachable)
+          map->m_bits[index / 64] |= quint64(1) << (index % 64);
+      }
+    }
+  }
+  return map;
+}
+
+std::shared_ptr<const WorkspaceMap> WorkspaceMap::load(const QString& filePath, const RobotGeometry& geometry, const JointLimits& limits,
+                                                       double voxelSize)
+{
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly))
+    return nullptr;
+
+  std::shared_ptr<WorkspaceMap> map(new WorkspaceMap());
+  map->m_geometry  = geometry;
+  map->m_limits    = limits;
+  map->m_voxelSize = voxelSize;
+  gridFor(geometry, voxelSize, map->m_origin, map->m_dims);
+
+  FileHeader expected;
+  fillHeader(expected, geometry, limits, voxelSize, map->m_dims);
+
+  const qint64 bitsSize = qint64(wordCount(map->m_dims) * sizeof(quint64));
+  if (file.size() != qint64(sizeof(FileHeader)) + bitsSize)
+    return nullptr;
+
+  FileHeader header;
+  if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) != qint64(sizeof(header)) || std::memcmp(&header, &expected, sizeof(header)) != 0)
+    return nullptr; // Otra geometría, otros límites u otra resolución
+
+  map->m_bits.resize(wordCount(map->m_dims));
+  if (file.read(reinterpret_cast<char*>(map->m_bits.data()), bitsSize) != bitsSize)
+    return nullptr;
+  return map;
+}
+
+bool WorkspaceMap::save(const QString& filePath) const
+{
+  QDir().mkpath(QFileInfo(filePath).absolutePath());
+
+  FileHeader header;
+  fillHeader(header, m_geometry, m_limits, m_voxelSize, m_dims);
+
+  QSaveFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(m_bits.data()), qint64(m_bits.size() * sizeof(quint64)));
+
+  if (!file.commit()) {
+    qWarning() << "No se pudo guardar el mapa del espacio de trabajo:" << file.errorString();
+    return false;
+  }
+  return true;
+}
+
+bool WorkspaceMap::contains(const cv::Point3d& position) const
+{
+  const int i = static_cast<int>(std::lround((position.x - m_origin.x) / m_voxelSize));
+  const int j = static_cast<int>(std::lround((position.y - m_origin.y) / m_voxelSize));
+  const int k = static_cast<int>(std::lround((position.z - m_origin.z) / m_voxelSize));
+  if (i < 0 || j < 0 || k < 0 || i >= m_dims[0] || j >= m_dims[1] || k >= m_dims[2])
+    return false;
+
+  const size_t index = (size_t(k) * m_dims[1] + j) * m_dims[0] + i;
+  return (m_bits[index / 64] >> (index % 64)) & 1;
+}
+
+const cv::Point3d& WorkspaceMap::origin() const
+{
+  return m_origin;
+}
+
+double WorkspaceMap::voxelSize() const
+{
+  return m_voxelSize;
+}
+
+const cv::Vec3i& WorkspaceMap::dims() const
+{
+  return m_dims;
+}
+
+size_t WorkspaceMap::reachableCount() const
+{
+  size_t count = 0;
+  for (quint64 word : m_bits) {
+    for (; word; word &= word - 1)
+      ++count;
+  }
+  return count;
+}
@@ -0,0 +1,52 @@
+#ifndef WORKSPACEMAP_H
+#define WORKSPACEMAP_H
+
+#include "RobotInverseKinematics.h"
+#include "RobotKinematics.h"
+#include <QString>
+#include <memory>
+#include <opencv2/core.hpp>
+#include <vector>
+
+/**
+ * @brief Mapa de vóxeles alcanzables por la pinza dentro de los límites articulares.
+ * @details El alcance es simétrico respecto al eje de la base salvo por el rango de q1, así que
+ * se construye en dos pasos: primero el perfil (r, z) que barren q2, q3 y q5 con la cinemática
+ * directa por lotes (r con signo: negativo es el brazo echado hacia atrás) y después cada vóxel
+ * se acepta si su acimut, o el opuesto con r negativo, cae dentro del rango de q1. El resultado
+ * es un bitset: contains() es O(1) y sirve para descartar objetivos antes de intentar la
+ * cinemática inversa. Se guarda junto a la tabla de cinemática inversa y, como ella, se descarta
+ * si cambia la geometría o los límites.
+ */
+class WorkspaceMap
+{
+public:
+  static std::shared_ptr<const WorkspaceMap> build(const RobotGeometry& geometry, const JointLimits& limits,
+                                                   double voxelSize = DEFAULT_VOXEL_SIZE);
+  static std::shared_ptr<const WorkspaceMap> load(const QString& filePath, const RobotGeometry& geometry, const JointLimits& limits,
+                                                  double voxelSize = DEFAULT_VOXEL_SIZE);
+  bool                                       save(const QString& filePath) const;
+
+  bool contains(const cv::Point3d& position) const;
+
+  const cv::Point3d& origin() const;
+  double             voxelSize() const;
+  const cv::Vec3i&   dims() const;
+  size_t             reachableCount() const;
+
+  static constexpr double DEFAULT_VOXEL_SIZE = 5.0; // mm
+  static const quint32    MAGIC              = 0x57535241; // "ARSW"
+  static const quint32    VERSION            = 1;
+
+private:
+  WorkspaceMap() = default;
+
+  RobotGeometry        m_geometry;
+  JointLimits          m_limits;
+  cv::Point3d          m_origin;
+  double               m_voxelSize = DEFAULT_VOXEL_SIZE;
+  cv::Vec3i            m_dims;
+  std::vector<quint64> m_bits; // Un bit por vóxel, x varía más rápido
+};
+
+#endif // WORKSPACEMAP_H
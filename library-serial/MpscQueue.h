@@ -0,0 +1,71 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+
+/**
+ * @brief Cola sin bloqueos de varios productores y un único consumidor.
+ * @details Lista enlazada con nodo centinela (esquema de Vyukov): push cuesta un exchange
+ * atómico sobre la cabeza y un store en el nodo anterior, sin mutex ni reintentos, así que un
+ * productor nunca espera a otro ni al consumidor. pop solo se puede llamar desde un hilo.
+ * Mientras un productor está entre sus dos pasos pop puede devolver false aunque haya elementos
+ * detrás; el productor todavía no ha terminado push, así que su aviso llega después y no se
+ * pierde nada.
+ */
+template <typename T>
+class MpscQueue
+{
+public:
+  MpscQueue()
+  {
+    Node* stub = new Node();
+    m_head.store(stub, std::memory_order_relaxed);
+    m_tail = stub;
+  }
+
+  ~MpscQueue()
+  {
+    T value;
+    while (pop(value)) {
+    }
+    delete m_tail;
+  }
+
+  MpscQueue(const MpscQueue&)            = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  // Cualquier hilo
+  void push(T value)
+  {
+    Node* node  = new Node();
+    node->value = std::move(value);
+    Node* prev  = m_head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  // Solo el hilo consumidor
+  bool pop(T& value)
+  {
+    Node* tail = m_tail;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (!next)
+      return false;
+    value  = std::move(next->value);
+    m_tail = next;
+    delete tail;
+    return true;
+  }
+
+private:
+  struct Node
+  {
+    std::atomic<Node*> next{nullptr};
+    T                  value{};
+  };
+
+  std::atomic<Node*> m_head;
+  Node*              m_tail;
+};
+
+#endif // MPSCQUEUE_H
@@ -0,0 +1,125 @@
+#include "SerialCommandScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+const double NS_PER_S = 1e9;
+}
+
+void SerialCommandScheduler::setLink(qint32 baudRate)
+{
+  m_baudRate = std::max(1, baudRate);
+}
+
+void SerialCommandScheduler::setLimits(int flushRateHz, double budget)
+{
+  m_flushRateHz = std::clamp(flushRateHz, 1, 1000);
+  m_budget      = std::clamp(budget, 0.05, 1.0);
+}
+
+int SerialCommandScheduler::flushRateHz() const
+{
+  return m_flushRateHz;
+}
+
+double SerialCommandScheduler::budget() const
+{
+  return m_budget;
+}
+
+void SerialCommandScheduler::updateServos(const QVector<int>& angles, int changedMask)
+{
+  ++m_stats.servoUpdates;
+  if (m_pendingMask)
+    ++m_stats.coalescedUpdates;
+
+  for (int i = 0; i < angles.size() && i < int(m_pending.size()); ++i)
+    m_pending[i] = angles[i];
+  m_pendingMask |= changedMask;
+}
+
+bool SerialCommandScheduler::hasPendingServos() const
+{
+  return m_pendingMask != 0;
+}
+
+int SerialCommandScheduler::pendingMask() const
+{
+  return m_pendingMask;
+}
+
+QVector<int> SerialCommandScheduler::pendingServos() const
+{
+  return QVector<int>(m_pending.begin(), m_pending.end());
+}
+
+int SerialCommandScheduler::poseDelayMs(int cost, qint64 nowNs)
+{
+  refill(nowNs);
+
+  double waitS = 0.0;
+  if (m_flushed)
+    waitS = (double(m_lastFlushNs - nowNs) + NS_PER_S / m_flushRateHz) / NS_PER_S;
+  if (m_tokens < cost)
+    waitS = std::max(waitS, (cost - m_tokens) / bytesPerSecond());
+  return waitS > 0.0 ? std::max(1, int(std::ceil(waitS * 1000.0))) : 0;
+}
+
+void SerialCommandScheduler::commitServos(int cost, qint64 nowNs)
+{
+  consume(cost, nowNs);
+  m_pendingMask = 0;
+  m_lastFlushNs = nowNs;
+  m_flushed     = true;
+  ++m_stats.poseFlushes;
+}
+
+void SerialCommandScheduler::consume(int bytes, qint64 nowNs)
+{
+  refill(nowNs);
+  // Puede quedar en negativo: las líneas no se retienen, la deuda la paga la siguiente pose
+  m_tokens -= bytes;
+  m_windowBytes += quint64(bytes);
+  m_stats.bytesSent += quint64(bytes);
+}
+
+void SerialCommandScheduler::reset(qint64 nowNs)
+{
+  m_pendingMask   = 0;
+  m_flushed       = false;
+  m_tokens        = burst();
+  m_refillNs      = nowNs;
+  m_stats         = SerialLinkStats();
+  m_windowBytes   = 0;
+  m_windowStartNs = nowNs;
+}
+
+SerialLinkStats SerialCommandScheduler::takeStats(qint64 nowNs)
+{
+  const double windowS     = double(nowNs - m_windowStartNs) / NS_PER_S;
+  const double capacity    = m_baudRate / 10.0; // 8N1: 10 bits por byte
+  m_stats.baudRate         = m_baudRate;
+  m_stats.budgetBytesPerS  = bytesPerSecond();
+  m_stats.utilization      = windowS > 0.0 ? double(m_windowBytes) / (capacity * windowS) : 0.0;
+  m_windowBytes            = 0;
+  m_windowStartNs          = nowNs;
+  return m_stats;
+}
+
+double SerialCommandScheduler::bytesPerSecond() const
+{
+  return m_budget * m_baudRate / 10.0;
+}
+
+double SerialCommandScheduler::burst() const
+{
+  // Dos periodos de envío, y al menos una pose completa para que un enlace lento no se bloquee
+  return std::max(2.0 * bytesPerSecond() / m_flushRateHz, double(MAX_POSE_BYTES));
+}
+
+void SerialCommandScheduler::refill(qint64 nowNs)
+{
+  m_tokens   = std::min(burst(), m_tokens + bytesPerSecond() * double(nowNs - m_refillNs) / NS_PER_S);
+  m_refillNs = nowNs;
+}
@@ -0,0 +1,84 @@
+#ifndef SERIALCOMMANDSCHEDULER_H
+#define SERIALCOMMANDSCHEDULER_H
+
+#include <QMetaType>
+#include <QVector>
+#include <QtGlobal>
+#include <array>
+
+// Uso del enlace serie, publicado una vez por segundo mientras el puerto está abierto
+struct SerialLinkStats
+{
+  qint32  baudRate         = 0;
+  double  budgetBytesPerS  = 0.0; // Parte de la capacidad que pueden usar las poses de los servos
+  double  utilization      = 0.0; // Bytes enviados / capacidad del enlace en el último segundo (0..1)
+  quint64 bytesSent        = 0;
+  quint64 servoUpdates     = 0; // Poses recibidas de los productores
+  quint64 coalescedUpdates = 0; // Poses sustituidas por otra más reciente antes de salir
+  quint64 poseFlushes      = 0; // Envíos reales de poses
+};
+Q_DECLARE_METATYPE(SerialLinkStats)
+
+/**
+ * @brief Planificador de los comandos de servo salientes.
+ * @details Guarda solo el último objetivo pendiente de cada servo y lo deja salir con dos
+ * límites: como mucho flushRateHz envíos de pose por segundo y un cubo de fichas de bytes que
+ * se rellena a budget · baudios / 10 bytes/s. Si un productor (un slider, el hilo de control)
+ * genera poses más deprisa, las intermedias se sustituyen en lugar de acumularse, así que ni el
+ * enlace se satura ni el firmware arrastra una cola de comandos viejos. Las líneas de texto no
+ * se descartan nunca: salen en orden y descuentan fichas, lo que retrasa la siguiente pose.
+ *
+ * No es thread-safe: vive en el hilo de E/S.
+ */
+class SerialCommandScheduler
+{
+public:
+  static constexpr int    DEFAULT_FLUSH_RATE_HZ = 50; // Periodo típico del PWM de los servos
+  static constexpr double DEFAULT_BUDGET        = 0.8;
+  static constexpr int    MAX_POSE_BYTES        = 128; // Pose completa en ASCII, con margen
+
+  void   setLink(qint32 baudRate);
+  void   setLimits(int flushRateHz, double budget);
+  int    flushRateHz() const;
+  double budget() const;
+
+  // angles es la pose completa; changedMask marca los servos que han cambiado
+  void updateServos(const QVector<int>& angles, int changedMask);
+  bool hasPendingServos() const;
+  int  pendingMask() const;
+  // Pose pendiente completa, sin sacarla
+  QVector<int> pendingServos() const;
+
+  // Milisegundos hasta que se pueda enviar una pose de cost bytes (0: ya)
+  int poseDelayMs(int cost, qint64 nowNs);
+  // Marca la pose pendiente como enviada y descuenta cost bytes
+  void commitServos(int cost, qint64 nowNs);
+  // Bytes que no son poses: siempre salen, pero cuentan para el presupuesto
+  void consume(int bytes, qint64 nowNs);
+
+  void            reset(qint64 nowNs);
+  SerialLinkStats takeStats(qint64 nowNs); // Cierra la ventana de utilización
+
+private:
+  qint32 m_baudRate    = 115200;
+  int    m_flushRateHz = DEFAULT_FLUSH_RATE_HZ;
+  double m_budget      = DEFAULT_BUDGET;
+
+  std::array<int, 6> m_pending{};
+  int                m_pendingMask = 0;
+
+  double m_tokens      = 0.0;
+  qint64 m_refillNs    = 0;
+  qint64 m_lastFlushNs = 0;
+  bool   m_flushed     = false;
+
+  SerialLinkStats m_stats;
+  quint64         m_windowBytes   = 0;
+  qint64          m_windowStartNs = 0;
+
+  double bytesPerSecond() const;
+  double burst() const;
+  void   refill(qint64 nowNs);
+};
+
+#endif // SERIALCOMMANDSCHEDULER_H
@@ -15,10 +15,15 @@ SerialConnectionSetupDialog::SerialConnectionSetupDialog(QWidget* parent) : QDia
 
   refreshPorts();
 
-  int portIndex = ui->comboBoxPort->findText(lastPort);
+  // Con el separador detrás, COM3 no se confunde con COM30
+  int portIndex = lastPort.isEmpty() ? -1 : ui->comboBoxPort->findText(lastPort + " - ", Qt::MatchStartsWith);
   if (portIndex != -1) {
     ui->comboBoxPort->setCurrentIndex(portIndex);
   }
+  else if (!lastPort.isEmpty()) {
+    // Puerto que no aparece en la lista (p. ej. el pty del simulador): se recupera la ruta escrita
+    ui->comboBoxPort->setEditText(lastPort);
+  }
   ui->comboBoxBaudRate->setCurrentText(QString::number(lastBaudRate));
 }
 
@@ -29,6 +34,7 @@ SerialConnectionSetupDialog::~SerialConnectionSetupDialog()
 
 void SerialConnectionSetupDialog::refreshPorts()
 {
+  const QString typedPort = ui->comboBoxPort->currentText();
   ui->comboBoxPort->clear();
   const auto ports       = QSerialPortInfo::availablePorts();
   int        serialIndex = -1;
@@ -48,11 +54,15 @@ void SerialConnectionSetupDialog::refreshPorts()
   if (serialIndex != -1) {
     ui->comboBoxPort->setCurrentIndex(serialIndex);
   }
+
+  // Una ruta escrita a mano no se pierde al refrescar tras un intento fallido
+  if (!typedPort.isEmpty() && ui->comboBoxPort->findText(typedPort) == -1)
+    ui->comboBoxPort->setEditText(typedPort);
 }
 
 void SerialConnectionSetupDialog::on_pushButtonConnect_clicked()
 {
-  QString portName = ui->comboBoxPort->currentText().split(" - ")[0];
+  QString portName = ui->comboBoxPort->currentText().split(" - ")[0].trimmed();
   qint32  baudRate = ui->comboBoxBaudRate->currentText().toInt();
 
   if (portName.isEmpty()) {
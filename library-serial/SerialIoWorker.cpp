@@ -0,0 +1,381 @@
+#include "SerialIoWorker.h"
+#include <QDebug>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+qint64 steadyNowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+} // namespace
+
+SerialIoWorker::SerialIoWorker(QObject* parent) : QObject(parent)
+{
+  // Hijos del worker: se mueven con él al hilo de E/S
+  m_serial           = new QSerialPort(this);
+  m_negotiationTimer = new QTimer(this);
+  m_poseTimer        = new QTimer(this);
+  m_statsTimer       = new QTimer(this);
+  m_requestTimer     = new QTimer(this);
+
+  connect(m_serial, &QSerialPort::readyRead, this, &SerialIoWorker::handleReadyRead);
+  connect(m_serial, &QSerialPort::errorOccurred, this, &SerialIoWorker::handleError);
+
+  // Sin respuesta al PROBE: el firmware solo habla ASCII
+  m_negotiationTimer->setSingleShot(true);
+  m_negotiationTimer->setInterval(NEGOTIATION_TIMEOUT_MS);
+  connect(m_negotiationTimer, &QTimer::timeout, this, [this]() {
+    m_negotiating = false;
+    qDebug() << "[Serial] Firmware without binary protocol, using ASCII";
+    dispatchRequests();
+  });
+
+  m_poseTimer->setSingleShot(true);
+  connect(m_poseTimer, &QTimer::timeout, this, [this]() { flushServos(); });
+  m_statsTimer->setInterval(STATS_INTERVAL_MS);
+  connect(m_statsTimer, &QTimer::timeout, this, &SerialIoWorker::publishStats);
+  m_requestTimer->setSingleShot(true);
+  connect(m_requestTimer, &QTimer::timeout, this, &SerialIoWorker::expireRequests);
+}
+
+void SerialIoWorker::enqueue(SerialTxItem item)
+{
+  m_txQueue.push(std::move(item));
+  if (!m_flushScheduled.exchange(true))
+    QMetaObject::invokeMethod(this, "flushTx", Qt::QueuedConnection);
+}
+
+bool SerialIoWorker::isConnected() const
+{
+  return m_connected;
+}
+
+SerialProtocol::Mode SerialIoWorker::protocolMode() const
+{
+  return SerialProtocol::Mode(m_mode.load());
+}
+
+SerialLinkStats SerialIoWorker::linkStats() const
+{
+  QMutexLocker locker(&m_statsMutex);
+  return m_publishedStats;
+}
+
+void SerialIoWorker::setLinkLimits(int flushRateHz, double budget)
+{
+  QMetaObject::invokeMethod(this, [this, flushRateHz, budget]() { m_scheduler.setLimits(flushRateHz, budget); }, Qt::QueuedConnection);
+}
+
+void SerialIoWorker::submitRequest(const SerialRequest& request, SerialRequestManager::Promise promise)
+{
+  QMetaObject::invokeMethod(
+    this,
+    [this, request, promise]() {
+      if (!m_serial->isOpen()) {
+        SerialReply reply;
+        reply.error = "Serial port not connected";
+        promise->addResult(reply);
+        promise->finish();
+        return;
+      }
+      m_requests.submit(request, promise);
+      dispatchRequests();
+    },
+    Qt::QueuedConnection);
+}
+
+SerialRttStats SerialIoWorker::roundTripStats() const
+{
+  QMutexLocker locker(&m_statsMutex);
+  return m_publishedRtt;
+}
+
+bool SerialIoWorker::open(const QString& portName, qint32 baudRate)
+{
+  if (m_serial->isOpen())
+    return true;
+
+  m_serial->setPortName(portName);
+  m_serial->setBaudRate(baudRate);
+  m_serial->setDataBits(QSerialPort::Data8);
+  m_serial->setParity(QSerialPort::NoParity);
+  m_serial->setStopBits(QSerialPort::OneStop);
+  m_serial->setFlowControl(QSerialPort::NoFlowControl);
+
+  if (!m_serial->open(QIODevice::ReadWrite)) {
+    emit errorOccurred(m_serial->errorString());
+    return false;
+  }
+
+  m_connected = true;
+  emit connectionStatusChanged(true);
+
+  m_scheduler.setLink(baudRate);
+  m_scheduler.reset(steadyNowNs());
+  m_statsTimer->start();
+
+  setMode(SerialProtocol::Mode::Ascii);
+  m_lineParser.clear();
+  m_negotiating = true;
+  writeLines(SerialProtocol::PROBE);
+  m_negotiationTimer->start();
+  return true;
+}
+
+bool SerialIoWorker::close()
+{
+  if (!m_serial->isOpen())
+    return false;
+
+  m_serial->close();
+  m_connected = false;
+  m_negotiationTimer->stop();
+  m_poseTimer->stop();
+  m_statsTimer->stop();
+  m_requestTimer->stop();
+  m_requests.failAll("Serial port closed");
+  m_negotiating = false;
+  setMode(SerialProtocol::Mode::Ascii);
+  m_scheduler.reset(steadyNowNs());
+
+  // Lo encolado para un puerto cerrado no se envía al siguiente
+  SerialTxItem discarded;
+  while (m_txQueue.pop(discarded)) {
+  }
+  emit connectionStatusChanged(false);
+  return true;
+}
+
+void SerialIoWorker::flushTx()
+{
+  // El aviso se rearma antes de vaciar: un push posterior programa otro flushTx
+  m_flushScheduled = false;
+
+  // Las poses solo actualizan el objetivo pendiente; sale una, la última, cuando el presupuesto lo
+  // permite. Una línea de texto no adelanta a la pose encolada antes que ella: esa sale primero
+  SerialTxItem item;
+  while (m_txQueue.pop(item)) {
+    if (!m_serial->isOpen())
+      continue;
+    if (item.kind == SerialTxItem::ServoAngles)
+      m_scheduler.updateServos(item.angles, item.changedMask);
+    else {
+      flushServos(true);
+      writeLines(item.data);
+    }
+  }
+  flushServos();
+}
+
+void SerialIoWorker::setMode(SerialProtocol::Mode mode)
+{
+  m_decoder.clear();
+  if (int(mode) == m_mode)
+    return;
+  m_mode = int(mode);
+  emit protocolChanged(mode);
+}
+
+void SerialIoWorker::writeLines(const QByteArray& data)
+{
+  QList<QByteArray> lines = data.split('\n'); // Dividir los datos en líneas
+  for (const QByteArray& line : lines) {
+    if (protocolMode() == SerialProtocol::Mode::Binary) {
+      if (!line.trimmed().isEmpty())
+        writeFrame(SerialProtocol::frameFromLine(line, m_sequence), line);
+      continue;
+    }
+    m_serial->write(line + '\n'); // Enviar cada línea seguida de un salto de línea
+    m_scheduler.consume(line.size() + 1, steadyNowNs());
+    emit dataSent(line); // Emitir señal para cada línea enviada
+  }
+}
+
+void SerialIoWorker::flushServos(bool force)
+{
+  if (!m_serial->isOpen() || !m_scheduler.hasPendingServos())
+    return;
+
+  const QVector<int> angles = m_scheduler.pendingServos();
+  const int          mask   = m_scheduler.pendingMask();
+
+  // Las seis articulaciones en una trama (el firmware las aplica a la vez) o una línea por servo cambiado
+  QList<QByteArray> chunks, texts;
+  if (protocolMode() == SerialProtocol::Mode::Binary) {
+    const SerialProtocol::Frame frame{SerialProtocol::SetAllServos, m_sequence, SerialProtocol::allServosPayload(angles)};
+    chunks << SerialProtocol::encodeFrame(frame.type, frame.sequence, frame.payload);
+    texts << SerialProtocol::frameToLine(frame);
+  }
+  else {
+    for (int i = 0; i < angles.size() && i < SerialProtocol::SERVO_COUNT; ++i) {
+      if (!(mask & (1 << i)))
+        continue;
+      texts << "SETUP:SERVO" + QByteArray::number(i + 1) + ':' + QByteArray::number(angles[i]);
+      chunks << texts.back() + '\n';
+    }
+  }
+
+  int cost = 0;
+  for (const QByteArray& chunk : chunks)
+    cost += chunk.size();
+
+  const qint64 now   = steadyNowNs();
+  const int    delay = force ? 0 : m_scheduler.poseDelayMs(cost, now);
+  if (delay > 0) {
+    if (!m_poseTimer->isActive())
+      m_poseTimer->start(delay);
+    return;
+  }
+  m_poseTimer->stop();
+
+  for (const QByteArray& chunk : chunks)
+    m_serial->write(chunk);
+  if (protocolMode() == SerialProtocol::Mode::Binary)
+    m_sequence = SerialProtocol::nextSequence(m_sequence);
+  m_scheduler.commitServos(cost, now);
+  for (const QByteArray& text : texts)
+    emit dataSent(text);
+}
+
+void SerialIoWorker::writeFrame(const QByteArray& frame, const QByteArray& text)
+{
+  m_serial->write(frame);
+  m_scheduler.consume(frame.size(), steadyNowNs());
+  m_sequence = SerialProtocol::nextSequence(m_sequence);
+  emit dataSent(text);
+}
+
+void SerialIoWorker::publishStats()
+{
+  const SerialLinkStats stats = m_scheduler.takeStats(steadyNowNs());
+  {
+    QMutexLocker locker(&m_statsMutex);
+    m_publishedStats = stats;
+  }
+  emit linkStatsUpdated(stats);
+}
+
+void SerialIoWorker::processLines()
+{
+  SerialLineParser::Event event;
+  while (protocolMode() == SerialProtocol::Mode::Ascii && m_lineParser.next(event)) {
+    switch (event.type) {
+      case SerialLineParser::Event::ProbeReply:
+        if (!m_negotiating)
+          break;
+        // La respuesta al PROBE es la última línea ASCII: lo que venga detrás ya son tramas
+        m_negotiating = false;
+        m_negotiationTimer->stop();
+        setMode(SerialProtocol::Mode::Binary);
+        m_decoder.feed(m_lineParser.takeRemaining());
+        qDebug() << "[Serial] Binary protocol negotiated";
+        processFrames();
+        dispatchRequests();
+        return;
+      case SerialLineParser::Event::Overflow:
+        qDebug() << "[Serial] Line longer than" << SerialLineParser::MAX_LINE << "bytes discarded";
+        continue;
+      default:
+        break;
+    }
+
+    // La copia es solo para el monitor y el registro; la telemetría sale del evento sin reservar memoria
+    emit dataReceived(QByteArray(event.text, event.length));
+
+    SerialProtocol::Telemetry telemetry;
+    if (SerialProtocol::telemetryFromEvent(event, telemetry))
+      publishTelemetry(telemetry);
+  }
+}
+
+void SerialIoWorker::processFrames()
+{
+  SerialProtocol::Frame frame;
+  while (m_decoder.next(frame)) {
+    emit dataReceived(SerialProtocol::frameToLine(frame));
+    for (const SerialProtocol::Telemetry& telemetry : SerialProtocol::frameTelemetry(frame))
+      publishTelemetry(telemetry);
+  }
+}
+
+void SerialIoWorker::publishTelemetry(SerialProtocol::Telemetry telemetry)
+{
+  telemetry.receivedNs = m_arrivalNs;
+  emit telemetryReceived(telemetry);
+
+  // Tras la señal: quien espera el QFuture encuentra el dato ya aplicado por los receptores directos
+  if (m_requests.handleTelemetry(telemetry)) {
+    publishRoundTrip();
+    dispatchRequests();
+  }
+}
+
+void SerialIoWorker::dispatchRequests()
+{
+  if (!m_serial->isOpen() || m_negotiating)
+    return;
+
+  const bool binary = protocolMode() == SerialProtocol::Mode::Binary;
+  quint32    id     = 0;
+  QByteArray command;
+  while (m_requests.nextToSend(binary, id, command)) {
+    // writeLines numera la trama Command con la secuencia actual
+    const quint8 sequence = m_sequence;
+    writeLines(command);
+    m_requests.markSent(id, binary ? sequence : -1, steadyNowNs());
+  }
+
+  const qint64 deadline = m_requests.nextDeadlineNs();
+  if (deadline < 0) {
+    m_requestTimer->stop();
+    return;
+  }
+  const qint64 remainingNs = std::max<qint64>(0, deadline - steadyNowNs());
+  m_requestTimer->start(int((remainingNs + 999999) / 1000000));
+}
+
+void SerialIoWorker::expireRequests()
+{
+  if (m_requests.expire(steadyNowNs()))
+    publishRoundTrip();
+  dispatchRequests();
+}
+
+void SerialIoWorker::publishRoundTrip()
+{
+  QMutexLocker locker(&m_statsMutex);
+  m_publishedRtt = m_requests.stats();
+}
+
+void SerialIoWorker::handleReadyRead()
+{
+  // Todo lo que sale de esta lectura lleva el instante de llegada, no el de su análisis
+  m_arrivalNs = steadyNowNs();
+
+  // En ASCII el puerto escribe directamente en el anillo del analizador, sin QByteArray por línea
+  while (protocolMode() == SerialProtocol::Mode::Ascii && m_serial->bytesAvailable() > 0) {
+    int          span   = 0;
+    char*        target = m_lineParser.writeSpan(span);
+    const qint64 read   = span > 0 ? m_serial->read(target, span) : 0;
+    if (read <= 0)
+      break;
+    m_lineParser.commit(int(read));
+    processLines();
+  }
+
+  if (protocolMode() == SerialProtocol::Mode::Binary) {
+    m_decoder.feed(m_serial->readAll());
+    processFrames();
+  }
+}
+
+void SerialIoWorker::handleError(QSerialPort::SerialPortError error)
+{
+  if (error != QSerialPort::NoError) {
+    emit errorOccurred(m_serial->errorString());
+  }
+}
@@ -0,0 +1,119 @@
+#ifndef SERIALIOWORKER_H
+#define SERIALIOWORKER_H
+
+#include "MpscQueue.h"
+#include "SerialCommandScheduler.h"
+#include "SerialLineParser.h"
+#include "SerialProtocol.h"
+#include "SerialRequestManager.h"
+#include <QMutex>
+#include <QObject>
+#include <QSerialPort>
+#include <QTimer>
+#include <QVector>
+#include <atomic>
+
+// Envío pendiente; se codifica en el hilo de E/S según el protocolo negociado
+struct SerialTxItem
+{
+  enum Kind
+  {
+    Lines,      // Líneas de texto separadas por '\n'
+    ServoAngles // Pose completa con la máscara de servos cambiados
+  };
+
+  Kind         kind = Lines;
+  QByteArray   data;
+  QVector<int> angles;
+  int          changedMask = 0;
+};
+
+/**
+ * @brief Dueño del QSerialPort en su propio hilo.
+ * @details Lectura, análisis de líneas y tramas, negociación del protocolo y escritura ocurren
+ * en el hilo de E/S, así que el pintado y los registros de la interfaz no retrasan el puerto.
+ * Los productores encolan con enqueue desde cualquier hilo sobre una MpscQueue; solo el primer
+ * envío tras un vaciado programa flushTx, de modo que una ráfaga de comandos cuesta un evento.
+ * Las poses de los servos pasan por SerialCommandScheduler, que las agrupa y limita al
+ * presupuesto del enlace, salvo que detrás venga una línea de texto: el orden en el cable es el
+ * de la cola. La telemetría sale con la marca de tiempo monotónica tomada al llegar los bytes,
+ * y antes de publicarse completa las peticiones de SerialRequestManager que espera.
+ * Las peticiones no salen mientras se negocia el protocolo, para que su respuesta llegue ya en
+ * el formato definitivo.
+ */
+class SerialIoWorker : public QObject
+{
+  Q_OBJECT
+public:
+  explicit SerialIoWorker(QObject* parent = nullptr);
+
+  // Cualquier hilo
+  void                 enqueue(SerialTxItem item);
+  bool                 isConnected() const;
+  SerialProtocol::Mode protocolMode() const;
+  SerialLinkStats      linkStats() const;
+  void                 setLinkLimits(int flushRateHz, double budget);
+  void                 submitRequest(const SerialRequest& request, SerialRequestManager::Promise promise);
+  SerialRttStats       roundTripStats() const;
+
+  static const int NEGOTIATION_TIMEOUT_MS = 500;
+  static const int STATS_INTERVAL_MS      = 1000;
+
+public slots:
+  bool open(const QString& portName, qint32 baudRate);
+  bool close();
+  void flushTx();
+
+signals:
+  void dataReceived(const QByteArray& data);
+  void dataSent(const QByteArray& data);
+  void telemetryReceived(const SerialProtocol::Telemetry& telemetry);
+  void protocolChanged(SerialProtocol::Mode mode);
+  void connectionStatusChanged(bool connected);
+  void errorOccurred(const QString& error);
+  void linkStatsUpdated(const SerialLinkStats& stats);
+
+private:
+  QSerialPort* m_serial;
+  QTimer*      m_negotiationTimer;
+  QTimer*      m_poseTimer; // Siguiente intento de enviar la pose retenida
+  QTimer*      m_statsTimer;
+  QTimer*      m_requestTimer; // Vencimiento más próximo de las peticiones en vuelo
+
+  MpscQueue<SerialTxItem> m_txQueue;
+  std::atomic<bool>       m_flushScheduled{false};
+  std::atomic<bool>       m_connected{false};
+  std::atomic<int>        m_mode{int(SerialProtocol::Mode::Ascii)};
+
+  // Solo en el hilo de E/S
+  bool                         m_negotiating = false;
+  SerialProtocol::FrameDecoder m_decoder;
+  SerialLineParser             m_lineParser;
+  quint8                       m_sequence  = 0;
+  qint64                       m_arrivalNs = 0;
+  SerialCommandScheduler       m_scheduler;
+  SerialRequestManager         m_requests;
+
+  mutable QMutex  m_statsMutex;
+  SerialLinkStats m_publishedStats;
+  SerialRttStats  m_publishedRtt;
+
+  void setMode(SerialProtocol::Mode mode);
+  void writeLines(const QByteArray& data);
+  // force: sale ya aunque supere el presupuesto, para no adelantarla con una línea posterior
+  void flushServos(bool force = false);
+  void writeFrame(const QByteArray& frame, const QByteArray& text);
+  void publishStats();
+  void dispatchRequests();
+  void expireRequests();
+  void publishRoundTrip();
+  void processLines();
+  void processFrames();
+  void publishTelemetry(SerialProtocol::Telemetry telemetry);
+
+private slots:
+  void handleReadyRead();
+  void handleError(QSerialPort::SerialPortError error);
+};
+
+#endif // SERIALIOWORKER_H
@@ -0,0 +1,203 @@
+#include "SerialLineParser.h"
+#include "SerialProtocol.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+const quint64 MASK = SerialLineParser::CAPACITY - 1;
+
+const char ANGLE_PREFIX[]  = "ANGLE_WITH_OFFSET:SERVO";
+const char OFFSET_PREFIX[] = "OFFSET:SERVO";
+
+bool isSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool hasPrefix(const char* text, int length, const char* prefix, int prefixLength)
+{
+  return length >= prefixLength && std::memcmp(text, prefix, size_t(prefixLength)) == 0;
+}
+
+// Entero decimal con signo opcional; avanza p y falla si no hay ningún dígito
+bool parseInt(const char*& p, const char* end, int& value)
+{
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+'))
+    negative = *p++ == '-';
+
+  const char* digits = p;
+  int         result = 0;
+  while (p < end && *p >= '0' && *p <= '9' && p - digits < 9)
+    result = result * 10 + (*p++ - '0');
+  if (p == digits)
+    return false;
+  value = negative ? -result : result;
+  return true;
+}
+
+// "n:valor" hasta el final exacto de la línea
+bool parseServoValue(const char* p, const char* end, int& servo, int& value)
+{
+  if (!parseInt(p, end, servo) || p == end || *p++ != ':')
+    return false;
+  return parseInt(p, end, value) && p == end && servo >= 1 && servo <= SerialProtocol::SERVO_COUNT;
+}
+} // namespace
+
+char* SerialLineParser::writeSpan(int& size)
+{
+  const quint64 free  = CAPACITY - (m_head - m_tail);
+  const quint64 index = m_head & MASK;
+  size                = int(std::min<quint64>(free, CAPACITY - index));
+  return m_ring + index;
+}
+
+void SerialLineParser::commit(int size)
+{
+  m_head += quint64(size);
+}
+
+int SerialLineParser::write(const char* data, int size)
+{
+  int written = 0;
+  while (written < size) {
+    int   span   = 0;
+    char* target = writeSpan(span);
+    if (span == 0)
+      break;
+    const int chunk = std::min(span, size - written);
+    std::memcpy(target, data + written, size_t(chunk));
+    commit(chunk);
+    written += chunk;
+  }
+  return written;
+}
+
+bool SerialLineParser::next(Event& event)
+{
+  for (;;) {
+    // Búsqueda del '\n' por tramos contiguos del anillo, continuando donde se dejó
+    const char* newline = nullptr;
+    while (m_scan < m_head) {
+      const quint64 index = m_scan & MASK;
+      const quint64 span  = std::min<quint64>(m_head - m_scan, CAPACITY - index);
+      newline             = static_cast<const char*>(std::memchr(m_ring + index, '\n', size_t(span)));
+      if (newline) {
+        m_scan += quint64(newline - (m_ring + index));
+        break;
+      }
+      m_scan += span;
+    }
+
+    if (!newline) {
+      if (m_discarding) {
+        m_tail = m_scan = m_head;
+        return false;
+      }
+      if (m_head - m_tail <= quint64(MAX_LINE))
+        return false;
+      // Sin fin de línea a la vista: se tira lo acumulado para no bloquear el anillo, y el resto
+      // de la línea cuando llegue
+      m_tail = m_scan = m_head;
+      m_discarding    = true;
+      ++m_overflows;
+      event      = Event();
+      event.type = Event::Overflow;
+      return true;
+    }
+
+    const quint64 start  = m_tail;
+    int           length = int(m_scan - start);
+    m_tail = m_scan = m_scan + 1;
+
+    // Final de una línea desbordada: ya se informó con su Overflow
+    if (m_discarding) {
+      m_discarding = false;
+      continue;
+    }
+
+    if (length > MAX_LINE) {
+      ++m_overflows;
+      event      = Event();
+      event.type = Event::Overflow;
+      return true;
+    }
+
+    // Contigua: se analiza en el anillo; si da la vuelta, se junta en m_line
+    const char*   text  = m_ring + (start & MASK);
+    const quint64 first = CAPACITY - (start & MASK);
+    if (quint64(length) > first) {
+      std::memcpy(m_line, text, size_t(first));
+      std::memcpy(m_line + first, m_ring, size_t(length - int(first)));
+      text = m_line;
+    }
+
+    while (length > 0 && isSpace(*text)) {
+      ++text;
+      --length;
+    }
+    while (length > 0 && isSpace(text[length - 1]))
+      --length;
+    if (length == 0)
+      continue;
+
+    classify(text, length, event);
+    return true;
+  }
+}
+
+QByteArray SerialLineParser::takeRemaining()
+{
+  QByteArray remaining;
+  remaining.reserve(pending());
+  while (m_tail < m_head) {
+    const quint64 index = m_tail & MASK;
+    const quint64 span  = std::min<quint64>(m_head - m_tail, CAPACITY - index);
+    remaining.append(m_ring + index, int(span));
+    m_tail += span;
+  }
+  m_scan       = m_tail;
+  m_discarding = false;
+  return remaining;
+}
+
+void SerialLineParser::clear()
+{
+  m_tail = m_scan = m_head;
+  m_discarding    = false;
+}
+
+bool SerialLineParser::classify(const char* text, int length, Event& event)
+{
+  static const int ANGLE_LENGTH  = int(sizeof(ANGLE_PREFIX)) - 1;
+  static const int OFFSET_LENGTH = int(sizeof(OFFSET_PREFIX)) - 1;
+  static const int PROBE_LENGTH  = int(std::strlen(SerialProtocol::PROBE_REPLY));
+
+  event.text   = text;
+  event.length = length;
+  event.servo  = 0;
+  event.value  = 0;
+  event.type   = Event::Text;
+  if (length == 0)
+    return false;
+
+  switch (text[0]) {
+    case 'A':
+      if (hasPrefix(text, length, ANGLE_PREFIX, ANGLE_LENGTH) && parseServoValue(text + ANGLE_LENGTH, text + length, event.servo, event.value))
+        event.type = Event::AngleWithOffset;
+      break;
+    case 'O':
+      if (hasPrefix(text, length, OFFSET_PREFIX, OFFSET_LENGTH) && parseServoValue(text + OFFSET_LENGTH, text + length, event.servo, event.value))
+        event.type = Event::Offset;
+      break;
+    case 'P':
+      if (length == PROBE_LENGTH && hasPrefix(text, length, SerialProtocol::PROBE_REPLY, PROBE_LENGTH))
+        event.type = Event::ProbeReply;
+      break;
+    default:
+      break;
+  }
+  return event.type != Event::Text;
+}
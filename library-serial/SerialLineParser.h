@@ -0,0 +1,71 @@
+#ifndef SERIALLINEPARSER_H
+#define SERIALLINEPARSER_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+/**
+ * @brief Analizador incremental de las líneas ASCII del firmware sobre un buffer circular fijo.
+ * @details El puerto lee directamente en el hueco libre del anillo (writeSpan/commit), y next
+ * busca el siguiente '\n' desde donde se quedó la búsqueda anterior, así que cada byte se mira
+ * una vez aunque la línea llegue a trozos. El tipo se decide con un switch sobre el primer
+ * carácter y una comparación del prefijo, y los números se leen a mano: ni QByteArray por
+ * línea, ni QString, ni sscanf. El texto del evento apunta al propio anillo, o a un buffer fijo
+ * si la línea da la vuelta, y solo es válido hasta la siguiente llamada a next.
+ *
+ * Una línea de más de MAX_LINE bytes sin '\n' se descarta entera y produce un evento Overflow:
+ * lo que llegue después se sigue tirando hasta su '\n', sin tomar el resto por una línea nueva.
+ */
+class SerialLineParser
+{
+public:
+  static constexpr int CAPACITY = 4096; // Potencia de dos
+  static constexpr int MAX_LINE = 256;
+
+  struct Event
+  {
+    enum Type
+    {
+      AngleWithOffset, // ANGLE_WITH_OFFSET:SERVOn:valor
+      Offset,          // OFFSET:SERVOn:valor
+      ProbeReply,      // SerialProtocol::PROBE_REPLY
+      Text,            // Cualquier otra línea
+      Overflow         // Línea demasiado larga, descartada
+    };
+
+    Type        type   = Text;
+    int         servo  = 0;
+    int         value  = 0;
+    const char* text   = nullptr; // Línea sin '\r' ni '\n' ni espacios en los extremos
+    int         length = 0;
+  };
+
+  // Hueco contiguo donde escribir sin copiar; size 0 si el anillo está lleno
+  char* writeSpan(int& size);
+  void  commit(int size);
+  // Copia data en el anillo; devuelve los bytes aceptados
+  int write(const char* data, int size);
+
+  bool next(Event& event);
+
+  // Bytes recibidos y todavía sin consumir (al cambiar a tramas binarias)
+  QByteArray takeRemaining();
+  void       clear();
+
+  int     pending() const { return int(m_head - m_tail); }
+  quint64 overflows() const { return m_overflows; }
+
+  // Clasifica una línea ya separada; devuelve false si es Text
+  static bool classify(const char* text, int length, Event& event);
+
+private:
+  char    m_ring[CAPACITY];
+  char    m_line[MAX_LINE];
+  quint64 m_head       = 0; // Bytes escritos desde el inicio
+  quint64 m_tail       = 0; // Bytes consumidos
+  quint64 m_scan       = 0; // Hasta aquí ya se ha buscado '\n'
+  quint64 m_overflows  = 0;
+  bool    m_discarding = false; // Resto de una línea desbordada, se tira hasta su '\n'
+};
+
+#endif // SERIALLINEPARSER_H
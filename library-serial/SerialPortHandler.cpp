@@ -1,6 +1,8 @@
 // serialmanager.cpp
 #include "SerialPortHandler.h"
 #include <QDebug>
+#include <QMetaObject>
+#include <memory>
 
 SerialPortHandler& SerialPortHandler::instance()
 {
@@ -10,8 +12,34 @@ SerialPortHandler& SerialPortHandler::instance()
 
 SerialPortHandler::SerialPortHandler(QObject* parent) : QObject(parent)
 {
-  connect(&m_serial, &QSerialPort::readyRead, this, &SerialPortHandler::handleReadyRead);
-  connect(&m_serial, &QSerialPort::errorOccurred, this, &SerialPortHandler::handleError);
+  qRegisterMetaType<SerialProtocol::Telemetry>();
+  qRegisterMetaType<SerialProtocol::Mode>();
+  qRegisterMetaType<SerialLinkStats>();
+  qRegisterMetaType<SerialRttStats>();
+
+  m_ioThread = new QThread(this);
+  m_worker   = new SerialIoWorker();
+  m_worker->moveToThread(m_ioThread);
+
+  // Señal a señal en directo: se reemiten en el hilo de E/S y cada receptor decide si va en cola
+  connect(m_ioThread, &QThread::finished, m_worker, &QObject::deleteLater);
+  connect(m_worker, &SerialIoWorker::dataReceived, this, &SerialPortHandler::dataReceived, Qt::DirectConnection);
+  connect(m_worker, &SerialIoWorker::dataSent, this, &SerialPortHandler::dataSent, Qt::DirectConnection);
+  connect(m_worker, &SerialIoWorker::telemetryReceived, this, &SerialPortHandler::telemetryReceived, Qt::DirectConnection);
+  connect(m_worker, &SerialIoWorker::protocolChanged, this, &SerialPortHandler::protocolChanged, Qt::DirectConnection);
+  connect(m_worker, &SerialIoWorker::connectionStatusChanged, this, &SerialPortHandler::connectionStatusChanged, Qt::DirectConnection);
+  connect(m_worker, &SerialIoWorker::errorOccurred, this, &SerialPortHandler::errorOccurred, Qt::DirectConnection);
+  connect(m_worker, &SerialIoWorker::linkStatsUpdated, this, &SerialPortHandler::linkStatsUpdated, Qt::DirectConnection);
+
+  m_ioThread->start(QThread::HighPriority);
+}
+
+SerialPortHandler::~SerialPortHandler()
+{
+  if (m_ioThread && m_ioThread->isRunning()) {
+    m_ioThread->quit();
+    m_ioThread->wait();
+  }
 }
 
 void SerialPortHandler::configurePort(const QString& portName, qint32 baudRate)
@@ -24,17 +52,13 @@ void SerialPortHandler::configurePort(const QString& portName, qint32 baudRate)
     emit errorOccurred("Invalid baud rate specified.");
     return;
   }
-  m_serial.setPortName(portName);
-  m_serial.setBaudRate(baudRate);
-  m_serial.setDataBits(QSerialPort::Data8);
-  m_serial.setParity(QSerialPort::NoParity);
-  m_serial.setStopBits(QSerialPort::OneStop);
-  m_serial.setFlowControl(QSerialPort::NoFlowControl);
+  m_portName = portName;
+  m_baudRate = baudRate;
 }
 
 bool SerialPortHandler::connectSerial()
 {
-  if (m_serial.isOpen()) {
+  if (isConnected()) {
     return true;
   }
 
@@ -44,68 +68,96 @@ bool SerialPortHandler::connectSerial()
     return false;
   }
 
-  if (m_serial.baudRate() == 0) {
+  if (m_baudRate == 0) {
     emit errorOccurred("Baud rate is not set.");
     return false;
   }
 
-  if (m_serial.open(QIODevice::ReadWrite)) {
-    emit connectionStatusChanged(true);
-    return true;
-  }
-  else {
-    emit errorOccurred(m_serial.errorString());
-    return false;
-  }
+  // La apertura se hace en el hilo de E/S; se espera el resultado para conservar la llamada síncrona
+  bool opened = false;
+  QMetaObject::invokeMethod(m_worker, "open", Qt::BlockingQueuedConnection, Q_RETURN_ARG(bool, opened), Q_ARG(QString, portName),
+                            Q_ARG(qint32, m_baudRate));
+  return opened;
 }
 
 bool SerialPortHandler::disconnectSerial()
 {
-  if (m_serial.isOpen()) {
-    m_serial.close();
-    emit connectionStatusChanged(false);
-    return true;
-  }
-  return false;
+  bool closed = false;
+  QMetaObject::invokeMethod(m_worker, "close", Qt::BlockingQueuedConnection, Q_RETURN_ARG(bool, closed));
+  return closed;
 }
 
 void SerialPortHandler::sendData(const QByteArray& data)
 {
-  if (m_serial.isOpen()) {
-    QList<QByteArray> lines = data.split('\n'); // Dividir los datos en líneas
-    for (const QByteArray& line : lines) {
-      m_serial.write(line + '\n'); // Enviar cada línea seguida de un salto de línea
-      emit dataSent(line);         // Emitir señal para cada línea enviada
-    }
-  }
+  if (!isConnected())
+    return;
+
+  SerialTxItem item;
+  item.kind = SerialTxItem::Lines;
+  item.data = data;
+  m_worker->enqueue(std::move(item));
+}
+
+void SerialPortHandler::sendServoAngles(const QVector<int>& angles, int changedMask)
+{
+  if (!isConnected() || changedMask == 0)
+    return;
+
+  SerialTxItem item;
+  item.kind        = SerialTxItem::ServoAngles;
+  item.angles      = angles;
+  item.changedMask = changedMask;
+  m_worker->enqueue(std::move(item));
 }
 
 bool SerialPortHandler::isConnected() const
 {
-  return m_serial.isOpen();
+  return m_worker->isConnected();
 }
 
 QString SerialPortHandler::getPortName() const
 {
-  return m_serial.portName();
+  return m_portName;
 }
 
 int SerialPortHandler::getBaudRate() const
 {
-  return m_serial.baudRate();
+  return m_baudRate;
 }
 
-void SerialPortHandler::handleReadyRead()
+SerialProtocol::Mode SerialPortHandler::protocolMode() const
 {
-  while (m_serial.canReadLine()) {
-    QByteArray line = m_serial.readLine(); // Leer línea por línea
-    emit       dataReceived(line);         // Emitir señal para cada línea recibida
-  }
+  return m_worker->protocolMode();
+}
+
+SerialLinkStats SerialPortHandler::linkStats() const
+{
+  return m_worker->linkStats();
+}
+
+void SerialPortHandler::setLinkLimits(int flushRateHz, double budget)
+{
+  m_worker->setLinkLimits(flushRateHz, budget);
 }
 
-void SerialPortHandler::handleError(QSerialPort::SerialPortError error)
+QFuture<SerialReply> SerialPortHandler::request(const SerialRequest& request)
 {
-  if (error != QSerialPort::NoError) {
-    emit errorOccurred(m_serial.errorString());
+  auto                 promise = std::make_shared<QPromise<SerialReply>>();
+  QFuture<SerialReply> future  = promise->future();
+  promise->start();
+
+  if (!isConnected()) {
+    SerialReply reply;
+    reply.error = "Serial port not connected";
+    promise->addResult(reply);
+    promise->finish();
+    return future;
   }
+  m_worker->submitRequest(request, promise);
+  return future;
+}
+
+SerialRttStats SerialPortHandler::roundTripStats() const
+{
+  return m_worker->roundTripStats();
 }
@@ -1,36 +1,66 @@
 #ifndef SERIALPORTHANDLER_H
 #define SERIALPORTHANDLER_H
 
+#include "SerialIoWorker.h"
+#include "SerialProtocol.h"
+#include "SerialRequestManager.h"
+#include <QFuture>
 #include <QObject>
 #include <QSerialPort>
 #include <QSerialPortInfo>
+#include <QThread>
+#include <QVector>
 
+/**
+ * @brief Punto de acceso al puerto serie; el puerto en sí vive en el hilo de E/S de SerialIoWorker.
+ * @details sendData y sendServoAngles se pueden llamar desde cualquier hilo y no esperan a la
+ * escritura. Las señales se emiten desde el hilo de E/S: las conexiones normales llegan en cola
+ * al hilo del receptor, y una Qt::DirectConnection recibe la telemetría sin pasar por la interfaz.
+ * request es la alternativa a sendData para las lecturas: devuelve un QFuture que se completa con
+ * la respuesta, o con el error tras agotar los reintentos, sin que el que llama tenga que
+ * emparejar las líneas que van llegando.
+ */
 class SerialPortHandler : public QObject {
   Q_OBJECT
 public:
   static SerialPortHandler& instance();
+  ~SerialPortHandler();
 
   void    configurePort(const QString& portName, qint32 baudRate);
   bool    connectSerial();
   bool    disconnectSerial();
   void    sendData(const QByteArray& data);
+  // Pose completa: una trama SetAllServos en binario, o una línea SETUP:SERVO por servo de changedMask en ASCII
+  void    sendServoAngles(const QVector<int>& angles, int changedMask);
   bool    isConnected() const;
   QString getPortName() const;
   int     getBaudRate() const;
 
+  SerialProtocol::Mode protocolMode() const;
+  SerialLinkStats      linkStats() const;
+  // Envíos de pose por segundo y fracción de la capacidad del enlace que pueden usar
+  void setLinkLimits(int flushRateHz, double budget);
+
+  // Cualquier hilo; el QFuture se completa desde el hilo de E/S, también si el puerto se cierra antes
+  QFuture<SerialReply> request(const SerialRequest& request);
+  SerialRttStats       roundTripStats() const;
+
 signals:
-  void dataReceived(const QByteArray& data); 
+  void dataReceived(const QByteArray& data); // En binario, la trama ya traducida a texto
   void dataSent(const QByteArray& data);
+  void telemetryReceived(const SerialProtocol::Telemetry& telemetry);
+  void protocolChanged(SerialProtocol::Mode mode);
   void connectionStatusChanged(bool connected);
   void errorOccurred(const QString& error);
+  void linkStatsUpdated(const SerialLinkStats& stats); // Una vez por segundo con el puerto abierto
 
 private:
   explicit SerialPortHandler(QObject* parent = nullptr);
-  QSerialPort m_serial;
 
-private slots:
-  void handleReadyRead();
-  void handleError(QSerialPort::SerialPortError error);
+  QThread*        m_ioThread = nullptr;
+  SerialIoWorker* m_worker   = nullptr;
+  QString         m_portName;
+  qint32          m_baudRate = 0;
 };
 
 #endif // SERIALPORTHANDLER_H
@@ -0,0 +1,236 @@
+#include "SerialProtocol.h"
+#include <array>
+#include <cstdio>
+
+namespace SerialProtocol
+{
+namespace
+{
+std::array<quint16, 256> makeCrcTable()
+{
+  std::array<quint16, 256> table{};
+  for (int i = 0; i < 256; ++i) {
+    quint16 crc = quint16(i << 8);
+    for (int bit = 0; bit < 8; ++bit)
+      crc = (crc & 0x8000) ? quint16((crc << 1) ^ 0x1021) : quint16(crc << 1);
+    table[i] = crc;
+  }
+  return table;
+}
+
+void appendInt16(QByteArray& out, int value)
+{
+  const qint16 v = qint16(qBound(-32768, value, 32767));
+  out.append(char(quint16(v) & 0xFF));
+  out.append(char(quint16(v) >> 8));
+}
+
+int readInt16(const QByteArray& data, int offset)
+{
+  return qint16(quint16(quint8(data[offset])) | quint16(quint8(data[offset + 1]) << 8));
+}
+
+QByteArray servoValuePayload(int servo, int value)
+{
+  QByteArray payload;
+  payload.append(char(quint8(servo)));
+  appendInt16(payload, value);
+  return payload;
+}
+} // namespace
+
+quint16 crc16(const char* data, int size)
+{
+  static const std::array<quint16, 256> TABLE = makeCrcTable();
+
+  quint16 crc = 0xFFFF;
+  for (int i = 0; i < size; ++i)
+    crc = quint16((crc << 8) ^ TABLE[((crc >> 8) ^ quint8(data[i])) & 0xFF]);
+  return crc;
+}
+
+QByteArray encodeFrame(quint8 type, quint8 sequence, const QByteArray& payload)
+{
+  QByteArray frame;
+  frame.reserve(HEADER_SIZE + payload.size() + CRC_SIZE);
+  frame.append(char(SOF));
+  frame.append(char(quint8(payload.size())));
+  frame.append(char(type));
+  frame.append(char(sequence));
+  frame.append(payload);
+
+  const quint16 crc = crc16(frame.constData() + 1, frame.size() - 1);
+  frame.append(char(crc & 0xFF));
+  frame.append(char(crc >> 8));
+  return frame;
+}
+
+QByteArray allServosPayload(const QVector<int>& angles)
+{
+  QByteArray payload;
+  payload.reserve(2 * SERVO_COUNT);
+  for (int i = 0; i < SERVO_COUNT; ++i)
+    appendInt16(payload, i < angles.size() ? angles[i] : 0);
+  return payload;
+}
+
+QByteArray frameFromLine(const QByteArray& line, quint8 sequence)
+{
+  const QByteArray text  = line.trimmed();
+  int              servo = 0, value = 0;
+  char             tail  = 0;
+
+  // %c comprueba que no sobra nada detrás del número
+  if (std::sscanf(text.constData(), "SETUP:SERVO%d:%d%c", &servo, &value, &tail) == 2 && servo >= 1 && servo <= SERVO_COUNT)
+    return encodeFrame(SetServo, sequence, servoValuePayload(servo, value));
+  if (std::sscanf(text.constData(), "SETUP:OFFSET%d:%d%c", &servo, &value, &tail) == 2 && servo >= 1 && servo <= SERVO_COUNT)
+    return encodeFrame(SetOffset, sequence, servoValuePayload(servo, value));
+  return encodeFrame(Command, sequence, text.left(MAX_PAYLOAD));
+}
+
+QByteArray frameToLine(const Frame& frame)
+{
+  const QByteArray& p = frame.payload;
+  switch (frame.type) {
+    case SetServo:
+      if (p.size() == 3)
+        return "SETUP:SERVO" + QByteArray::number(quint8(p[0])) + ':' + QByteArray::number(readInt16(p, 1));
+      break;
+    case SetOffset:
+      if (p.size() == 3)
+        return "SETUP:OFFSET" + QByteArray::number(quint8(p[0])) + ':' + QByteArray::number(readInt16(p, 1));
+      break;
+    case SetAllServos:
+    case AllServoAngles:
+      if (p.size() == 2 * SERVO_COUNT) {
+        QByteArray line = frame.type == SetAllServos ? "SETUP:ALL:" : "ANGLES_WITH_OFFSET:";
+        for (int i = 0; i < SERVO_COUNT; ++i) {
+          if (i)
+            line += ',';
+          line += QByteArray::number(readInt16(p, 2 * i));
+        }
+        return line;
+      }
+      break;
+    case ServoAngle:
+      if (p.size() == 3)
+        return "ANGLE_WITH_OFFSET:SERVO" + QByteArray::number(quint8(p[0])) + ':' + QByteArray::number(readInt16(p, 1));
+      break;
+    case ServoOffset:
+      if (p.size() == 3)
+        return "OFFSET:SERVO" + QByteArray::number(quint8(p[0])) + ':' + QByteArray::number(readInt16(p, 1));
+      break;
+    case Command:
+    case Text:
+      return p;
+  }
+  return "FRAME:0x" + QByteArray::number(frame.type, 16) + ':' + p.toHex();
+}
+
+bool parseTelemetryLine(const QByteArray& line, Telemetry& telemetry)
+{
+  const char* text   = line.constData();
+  int         length = line.size();
+  while (length > 0 && (*text == ' ' || *text == '\t' || *text == '\r' || *text == '\n')) {
+    ++text;
+    --length;
+  }
+  while (length > 0 && (text[length - 1] == ' ' || text[length - 1] == '\t' || text[length - 1] == '\r' || text[length - 1] == '\n'))
+    --length;
+
+  SerialLineParser::Event event;
+  SerialLineParser::classify(text, length, event);
+  return telemetryFromEvent(event, telemetry);
+}
+
+bool telemetryFromEvent(const SerialLineParser::Event& event, Telemetry& telemetry)
+{
+  if (event.type != SerialLineParser::Event::AngleWithOffset && event.type != SerialLineParser::Event::Offset)
+    return false;
+  telemetry.kind  = event.type == SerialLineParser::Event::AngleWithOffset ? Telemetry::AngleWithOffset : Telemetry::Offset;
+  telemetry.servo = event.servo;
+  telemetry.value = event.value;
+  return true;
+}
+
+std::vector<Telemetry> frameTelemetry(const Frame& frame)
+{
+  std::vector<Telemetry> result;
+  const QByteArray&      p = frame.payload;
+  if ((frame.type == ServoAngle || frame.type == ServoOffset) && p.size() == 3) {
+    Telemetry telemetry;
+    telemetry.kind  = frame.type == ServoAngle ? Telemetry::AngleWithOffset : Telemetry::Offset;
+    telemetry.servo = quint8(p[0]);
+    telemetry.value = readInt16(p, 1);
+    if (telemetry.servo >= 1 && telemetry.servo <= SERVO_COUNT)
+      result.push_back(telemetry);
+  }
+  else if (frame.type == AllServoAngles && p.size() == 2 * SERVO_COUNT) {
+    result.reserve(SERVO_COUNT);
+    for (int i = 0; i < SERVO_COUNT; ++i)
+      result.push_back({Telemetry::AngleWithOffset, i + 1, readInt16(p, 2 * i)});
+  }
+  else if (frame.type == Text) {
+    Telemetry telemetry;
+    if (parseTelemetryLine(p, telemetry))
+      result.push_back(telemetry);
+  }
+  for (Telemetry& telemetry : result)
+    telemetry.sequence = frame.sequence;
+  return result;
+}
+
+void FrameDecoder::feed(const QByteArray& data)
+{
+  m_buffer.append(data);
+}
+
+bool FrameDecoder::next(Frame& frame)
+{
+  while (!m_buffer.isEmpty()) {
+    const int start = m_buffer.indexOf(char(SOF));
+    if (start < 0) {
+      m_discardedBytes += quint64(m_buffer.size());
+      m_buffer.clear();
+      return false;
+    }
+    if (start > 0) {
+      m_discardedBytes += quint64(start);
+      m_buffer.remove(0, start);
+    }
+    if (m_buffer.size() < HEADER_SIZE)
+      return false;
+
+    const int length = quint8(m_buffer[1]);
+    if (length > MAX_PAYLOAD) {
+      ++m_discardedBytes;
+      m_buffer.remove(0, 1);
+      continue;
+    }
+
+    const int total = HEADER_SIZE + length + CRC_SIZE;
+    if (m_buffer.size() < total)
+      return false;
+
+    const quint16 expected = quint16(quint8(m_buffer[total - 2]) | (quint8(m_buffer[total - 1]) << 8));
+    if (crc16(m_buffer.constData() + 1, total - 1 - CRC_SIZE) != expected) {
+      ++m_crcErrors;
+      ++m_discardedBytes;
+      m_buffer.remove(0, 1);
+      continue;
+    }
+
+    frame.type     = quint8(m_buffer[2]);
+    frame.sequence = quint8(m_buffer[3]);
+    frame.payload  = m_buffer.mid(HEADER_SIZE, length);
+    m_buffer.remove(0, total);
+    return true;
+  }
+  return false;
+}
+
+void FrameDecoder::clear()
+{
+  m_buffer.clear();
+}
+} // namespace SerialProtocol
@@ -0,0 +1,130 @@
+#ifndef SERIALPROTOCOL_H
+#define SERIALPROTOCOL_H
+
+#include "SerialLineParser.h"
+#include <QByteArray>
+#include <QMetaType>
+#include <QVector>
+#include <QtGlobal>
+#include <vector>
+
+/**
+ * @brief Protocolo con el firmware: líneas ASCII o tramas binarias con CRC.
+ * @details Al abrir el puerto se envía la línea PROBE; si el firmware contesta PROBE_REPLY ambos
+ * extremos pasan a tramas binarias, y si no contesta se sigue con el protocolo ASCII de siempre.
+ *
+ * Trama: SOF | longitud | tipo | secuencia | payload (longitud bytes) | CRC-16 (LE)
+ *
+ * El CRC es CRC-16/CCITT-FALSE (polinomio 0x1021, inicial 0xFFFF) sobre longitud, tipo,
+ * secuencia y payload. Los ángulos van como int16 little-endian en grados. SetAllServos fija las
+ * seis articulaciones a la vez en una trama de 18 bytes, frente a seis líneas SETUP:SERVO.
+ * Las tramas que contestan a un Command (READ:OFFSETS...) repiten su secuencia, lo que permite
+ * a SerialRequestManager saber a qué petición pertenecen. El host numera sus tramas en los 7 bits
+ * bajos; las que el firmware envía sin que se le pidan llevan el bit UNSOLICITED y su propio
+ * contador, así que nunca se confunden con una respuesta.
+ */
+namespace SerialProtocol
+{
+const quint8 SOF         = 0xA5;
+const int    HEADER_SIZE = 4; // SOF, longitud, tipo, secuencia
+const int    CRC_SIZE    = 2;
+const int    MAX_PAYLOAD = 64;
+const int    SERVO_COUNT = 6;
+
+const quint8 SEQUENCE_MASK = 0x7F;
+const quint8 UNSOLICITED   = 0x80; // Tramas del firmware que no contestan a nada
+
+const char* const PROBE       = "PROTO:BIN?";
+const char* const PROBE_REPLY = "PROTO:BIN:1";
+
+enum class Mode
+{
+  Ascii,
+  Binary
+};
+
+enum FrameType : quint8
+{
+  // Host -> firmware
+  SetServo     = 0x01, // servo (u8), ángulo (i16)
+  SetAllServos = 0x02, // SERVO_COUNT x ángulo (i16)
+  SetOffset    = 0x03, // servo (u8), offset (i16)
+  Command      = 0x10, // Línea ASCII sin equivalente binario (READ:OFFSETS...)
+
+  // Firmware -> host
+  ServoAngle     = 0x81, // servo (u8), ángulo con offset (i16)
+  AllServoAngles = 0x82, // SERVO_COUNT x ángulo con offset (i16)
+  ServoOffset    = 0x83, // servo (u8), offset (i16)
+  Text           = 0x90  // Línea ASCII libre (mensajes de depuración del firmware)
+};
+
+struct Frame
+{
+  quint8     type     = 0;
+  quint8     sequence = 0;
+  QByteArray payload;
+};
+
+// Dato de un servo leído del firmware, venga de una línea o de una trama
+struct Telemetry
+{
+  enum Kind
+  {
+    AngleWithOffset, // ANGLE_WITH_OFFSET:SERVOn:valor
+    Offset           // OFFSET:SERVOn:valor
+  };
+
+  Kind   kind       = AngleWithOffset;
+  int    servo      = 0; // 1..SERVO_COUNT
+  int    value      = 0;
+  qint64 receivedNs = 0;  // steady_clock al llegar los bytes al puerto
+  int    sequence   = -1; // Secuencia de la trama que lo trae; -1 en ASCII
+};
+
+// Siguiente secuencia dentro del mismo rango (host o UNSOLICITED)
+inline quint8 nextSequence(quint8 sequence)
+{
+  return quint8((sequence & UNSOLICITED) | ((sequence + 1) & SEQUENCE_MASK));
+}
+
+quint16    crc16(const char* data, int size);
+QByteArray encodeFrame(quint8 type, quint8 sequence, const QByteArray& payload);
+QByteArray allServosPayload(const QVector<int>& angles);
+
+// Traduce una línea ASCII de comando a su trama; las que no tienen tipo propio van como Command
+QByteArray frameFromLine(const QByteArray& line, quint8 sequence);
+// Representación ASCII de una trama, para el monitor serie y el registro
+QByteArray frameToLine(const Frame& frame);
+
+// Lectura directa sobre los bytes con SerialLineParser::classify, sin pasar por QString
+bool parseTelemetryLine(const QByteArray& line, Telemetry& telemetry);
+bool telemetryFromEvent(const SerialLineParser::Event& event, Telemetry& telemetry);
+// Una trama AllServoAngles produce SERVO_COUNT entradas
+std::vector<Telemetry> frameTelemetry(const Frame& frame);
+
+/**
+ * @brief Separa tramas de un flujo de bytes que llega a trozos.
+ * @details Si la longitud es imposible o el CRC no cuadra, se descarta solo el byte SOF y se
+ * busca el siguiente, así que un byte perdido cuesta una trama y no desincroniza el resto.
+ */
+class FrameDecoder
+{
+public:
+  void feed(const QByteArray& data);
+  bool next(Frame& frame);
+  void clear();
+
+  quint64 crcErrors() const { return m_crcErrors; }
+  quint64 discardedBytes() const { return m_discardedBytes; }
+
+private:
+  QByteArray m_buffer;
+  quint64    m_crcErrors      = 0;
+  quint64    m_discardedBytes = 0;
+};
+} // namespace SerialProtocol
+
+Q_DECLARE_METATYPE(SerialProtocol::Telemetry)
+Q_DECLARE_METATYPE(SerialProtocol::Mode)
+
+#endif // SERIALPROTOCOL_H
@@ -0,0 +1,206 @@
+#include "SerialRequestManager.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+const qint64 NS_PER_MS  = 1000000;
+const int    ALL_SERVOS = (1 << SerialProtocol::SERVO_COUNT) - 1;
+} // namespace
+
+QByteArray SerialRequest::command() const
+{
+  return kind == ReadAngles ? "READ:ANGLES_WITH_OFFSET" : "READ:OFFSETS";
+}
+
+SerialProtocol::Telemetry::Kind SerialRequest::replyKind() const
+{
+  return kind == ReadAngles ? SerialProtocol::Telemetry::AngleWithOffset : SerialProtocol::Telemetry::Offset;
+}
+
+void SerialRequestManager::submit(const SerialRequest& request, Promise promise)
+{
+  Entry entry;
+  entry.id      = m_nextId++;
+  entry.request = request;
+  entry.promise = std::move(promise);
+  entry.values  = QVector<int>(SerialProtocol::SERVO_COUNT, 0);
+  m_entries.push_back(std::move(entry));
+}
+
+bool SerialRequestManager::nextToSend(bool binary, quint32& id, QByteArray& command)
+{
+  // Las canceladas desde su QFuture ni se envían ni se esperan
+  for (auto it = m_entries.begin(); it != m_entries.end();)
+    it = it->promise->isCanceled() ? m_entries.erase(it) : it + 1;
+
+  int inFlight = 0, busyKinds = 0;
+  for (const Entry& entry : m_entries) {
+    if (entry.inFlight) {
+      ++inFlight;
+      busyKinds |= 1 << entry.request.kind;
+    }
+  }
+  if (inFlight >= MAX_IN_FLIGHT)
+    return false;
+
+  for (const Entry& entry : m_entries) {
+    if (entry.inFlight)
+      continue;
+    // Sin secuencia en las respuestas ASCII, dos peticiones del mismo tipo no se distinguirían
+    if (!binary && (busyKinds & (1 << entry.request.kind)))
+      continue;
+    id      = entry.id;
+    command = entry.request.command();
+    return true;
+  }
+  return false;
+}
+
+void SerialRequestManager::markSent(quint32 id, int sequence, qint64 nowNs)
+{
+  for (Entry& entry : m_entries) {
+    if (entry.id != id)
+      continue;
+    entry.inFlight = true;
+    ++entry.attempts;
+    // Una respuesta no puede mezclar servos de dos intentos (dos poses distintas del brazo)
+    if (entry.attempts > 1) {
+      entry.receivedMask = 0;
+      entry.values.fill(0);
+    }
+    entry.sequence   = sequence;
+    entry.sentNs     = nowNs;
+    entry.deadlineNs = nowNs + qint64(timeoutMs(entry)) * NS_PER_MS;
+    return;
+  }
+}
+
+bool SerialRequestManager::handleTelemetry(const SerialProtocol::Telemetry& telemetry)
+{
+  if (telemetry.servo < 1 || telemetry.servo > SerialProtocol::SERVO_COUNT)
+    return false;
+
+  // Con secuencia, solo la petición que la lleva: una trama UNSOLICITED no contesta a ninguna.
+  // Sin ella (ASCII), la más antigua que espera este tipo de dato
+  auto target = m_entries.end();
+  for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+    // Las reencoladas para reintento siguen aceptando las respuestas tardías del intento anterior
+    if (it->attempts == 0 || it->request.replyKind() != telemetry.kind)
+      continue;
+    if (telemetry.sequence < 0 || it->sequence == telemetry.sequence) {
+      target = it;
+      break;
+    }
+  }
+  if (target == m_entries.end())
+    return false;
+
+  // El firmware contesta de SERVO1 a SERVOn: SERVO1 o un servo repetido abren otra respuesta. En
+  // ASCII es lo único que separa la tardía del intento anterior de la del reenvío
+  const int servoBit = 1 << (telemetry.servo - 1);
+  if (telemetry.servo == 1 || (target->receivedMask & servoBit))
+    target->receivedMask = 0;
+  target->values[telemetry.servo - 1] = telemetry.value;
+  target->receivedMask |= servoBit;
+  if (target->receivedMask != ALL_SERVOS)
+    return false;
+
+  SerialReply reply;
+  reply.ok       = true;
+  reply.values   = target->values;
+  reply.attempts = target->attempts;
+  reply.rttMs    = std::max(0.0, double(telemetry.receivedNs - target->sentNs) / NS_PER_MS);
+  if (target->attempts == 1)
+    addSample(reply.rttMs);
+  ++m_stats.completed;
+  finish(target, reply);
+  return true;
+}
+
+bool SerialRequestManager::expire(qint64 nowNs)
+{
+  bool changed = false;
+  for (auto it = m_entries.begin(); it != m_entries.end();) {
+    if (!it->inFlight || it->deadlineNs > nowNs) {
+      ++it;
+      continue;
+    }
+    changed = true;
+    if (it->attempts <= it->request.retries) {
+      // Vuelve a la cola y sale en el siguiente nextToSend, con el doble de tiempo
+      it->inFlight = false;
+      ++m_stats.retries;
+      ++it;
+      continue;
+    }
+
+    ++m_stats.timeouts;
+    SerialReply reply;
+    reply.values   = it->values;
+    reply.attempts = it->attempts;
+    reply.error    = QString("%1 timed out after %2 attempts").arg(QString::fromLatin1(it->request.command())).arg(it->attempts);
+    it             = finish(it, reply);
+  }
+  return changed;
+}
+
+qint64 SerialRequestManager::nextDeadlineNs() const
+{
+  qint64 deadline = -1;
+  for (const Entry& entry : m_entries) {
+    if (entry.inFlight && (deadline < 0 || entry.deadlineNs < deadline))
+      deadline = entry.deadlineNs;
+  }
+  return deadline;
+}
+
+void SerialRequestManager::failAll(const QString& error)
+{
+  SerialReply reply;
+  reply.error = error;
+  for (auto it = m_entries.begin(); it != m_entries.end();) {
+    reply.attempts = it->attempts;
+    it             = finish(it, reply);
+  }
+}
+
+SerialRttStats SerialRequestManager::stats() const
+{
+  SerialRttStats stats = m_stats;
+  if (stats.samples == 0)
+    stats.timeoutMs = INITIAL_TIMEOUT_MS;
+  return stats;
+}
+
+int SerialRequestManager::timeoutMs(const Entry& entry) const
+{
+  const int base = entry.request.timeoutMs > 0 ? entry.request.timeoutMs : int(std::ceil(stats().timeoutMs));
+  // Retroceso exponencial: cada reintento espera el doble que el anterior
+  const int shift = std::clamp(entry.attempts - 1, 0, 4);
+  return std::min(base << shift, std::max(base, int(MAX_TIMEOUT_MS)));
+}
+
+void SerialRequestManager::addSample(double rttMs)
+{
+  if (m_stats.samples == 0) {
+    m_stats.smoothedMs  = rttMs;
+    m_stats.variationMs = rttMs / 2.0;
+    m_stats.minMs       = rttMs;
+  }
+  else {
+    m_stats.variationMs = 0.75 * m_stats.variationMs + 0.25 * std::abs(m_stats.smoothedMs - rttMs);
+    m_stats.smoothedMs  = 0.875 * m_stats.smoothedMs + 0.125 * rttMs;
+    m_stats.minMs       = std::min(m_stats.minMs, rttMs);
+  }
+  m_stats.lastMs    = rttMs;
+  m_stats.timeoutMs = std::clamp(m_stats.smoothedMs + 4.0 * m_stats.variationMs, double(MIN_TIMEOUT_MS), double(MAX_TIMEOUT_MS));
+  ++m_stats.samples;
+}
+
+std::deque<SerialRequestManager::Entry>::iterator SerialRequestManager::finish(std::deque<Entry>::iterator it, const SerialReply& reply)
+{
+  it->promise->addResult(reply);
+  it->promise->finish();
+  return m_entries.erase(it);
+}
@@ -0,0 +1,124 @@
+#ifndef SERIALREQUESTMANAGER_H
+#define SERIALREQUESTMANAGER_H
+
+#include "SerialProtocol.h"
+#include <QByteArray>
+#include <QFuture>
+#include <QPromise>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+#include <deque>
+#include <memory>
+
+// Lectura que el firmware contesta con una línea o trama por servo
+struct SerialRequest
+{
+  enum Kind
+  {
+    ReadOffsets, // READ:OFFSETS -> OFFSET:SERVOn:valor
+    ReadAngles   // READ:ANGLES_WITH_OFFSET -> ANGLE_WITH_OFFSET:SERVOn:valor
+  };
+
+  Kind kind      = ReadOffsets;
+  int  timeoutMs = 0; // Por intento; 0 usa el calculado a partir del RTT medido
+  int  retries   = 2; // Reenvíos tras agotar el tiempo del primer intento
+
+  QByteArray                      command() const;
+  SerialProtocol::Telemetry::Kind replyKind() const;
+};
+
+struct SerialReply
+{
+  bool         ok       = false;
+  QVector<int> values;         // Índice servo - 1
+  int          attempts = 0;
+  double       rttMs    = 0.0; // Desde el último envío hasta la llegada de la última respuesta
+  QString      error;
+};
+
+// Tiempos de ida y vuelta medidos sobre las peticiones contestadas al primer intento
+struct SerialRttStats
+{
+  double  lastMs      = 0.0;
+  double  minMs       = 0.0;
+  double  smoothedMs  = 0.0;
+  double  variationMs = 0.0;
+  double  timeoutMs   = 0.0; // Tiempo límite actual para las peticiones sin uno propio
+  quint64 samples     = 0;
+  quint64 completed   = 0;
+  quint64 retries     = 0;
+  quint64 timeouts    = 0; // Peticiones fallidas tras agotar los reintentos
+};
+Q_DECLARE_METATYPE(SerialRttStats)
+
+/**
+ * @brief Peticiones con respuesta sobre el puerto serie: correlación, reintentos y RTT.
+ * @details Cada petición lleva un identificador y, en binario, la secuencia de la trama Command
+ * que la transporta; el firmware repite esa secuencia en las tramas de respuesta. En binario una
+ * respuesta va solo a la petición con su secuencia, y las tramas UNSOLICITED (informes del
+ * movimiento) no completan ninguna ni aportan muestras de RTT. En ASCII no hay secuencia y la
+ * respuesta va a la más antigua que espera ese tipo de dato, por eso solo puede haber una
+ * petición de cada tipo en vuelo; en binario, hasta MAX_IN_FLIGHT a la vez.
+ *
+ * El tiempo límite de cada intento sale del RTT medido como en TCP (RFC 6298): media suavizada
+ * más cuatro veces la variación, entre MIN_TIMEOUT_MS y MAX_TIMEOUT_MS, y se dobla en cada
+ * reintento. Solo cuentan como muestra las peticiones contestadas al primer intento, así que un
+ * reenvío no falsea la medida con la respuesta del intento anterior (algoritmo de Karn). Por la
+ * misma razón los valores de una respuesta salen siempre de un único intento: al reenviar se
+ * descartan los servos ya recibidos.
+ *
+ * No es thread-safe: vive en el hilo de E/S. Los QFuture se completan desde ese hilo.
+ */
+class SerialRequestManager
+{
+public:
+  using Promise = std::shared_ptr<QPromise<SerialReply>>;
+
+  static constexpr int MAX_IN_FLIGHT      = 4;
+  static constexpr int INITIAL_TIMEOUT_MS = 500; // Sin ninguna muestra todavía
+  static constexpr int MIN_TIMEOUT_MS     = 50;
+  static constexpr int MAX_TIMEOUT_MS     = 3000;
+
+  void submit(const SerialRequest& request, Promise promise);
+
+  // Siguiente petición que puede salir ya; tras escribirla se llama a markSent con su id
+  bool nextToSend(bool binary, quint32& id, QByteArray& command);
+  // sequence es la de la trama Command en binario, -1 en ASCII
+  void markSent(quint32 id, int sequence, qint64 nowNs);
+
+  // Devuelve true si la telemetría completa alguna petición
+  bool handleTelemetry(const SerialProtocol::Telemetry& telemetry);
+  // Reencola o da por fallidas las peticiones sin respuesta a tiempo; true si ha cambiado algo
+  bool expire(qint64 nowNs);
+  // Próximo vencimiento en steady_clock, -1 si no hay nada en vuelo
+  qint64 nextDeadlineNs() const;
+
+  void           failAll(const QString& error);
+  SerialRttStats stats() const;
+
+private:
+  struct Entry
+  {
+    quint32       id           = 0;
+    SerialRequest request;
+    Promise       promise;
+    bool          inFlight     = false;
+    int           attempts     = 0;
+    int           sequence     = -1;
+    qint64        sentNs       = 0;
+    qint64        deadlineNs   = 0;
+    int           receivedMask = 0;
+    QVector<int>  values;
+  };
+
+  std::deque<Entry> m_entries; // Por orden de llegada
+  quint32           m_nextId = 1;
+  SerialRttStats    m_stats;
+
+  int                         timeoutMs(const Entry& entry) const;
+  void                        addSample(double rttMs);
+  std::deque<Entry>::iterator finish(std::deque<Entry>::iterator it, const SerialReply& reply);
+};
+
+#endif // SERIALREQUESTMANAGER_H
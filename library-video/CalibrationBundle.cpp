@@ -0,0 +1,295 @@
+#include "CalibrationBundle.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <cstring>
+#include <map>
+
+namespace
+{
+const int    MAX_DIST_COEFFS = 14; // Modelo completo de OpenCV (racional + prisma + inclinación)
+const int    STAMP_SIZE      = 20; // SHA-1
+const qint64 BLOB_ALIGNMENT  = 64;
+
+struct FileHeader
+{
+  quint32 magic;
+  quint32 version;
+  quint32 profileCount;
+  quint32 mapCount;
+  char    stamp[STAMP_SIZE];
+  quint32 reserved;
+};
+
+struct ProfileRecord
+{
+  qint32 width;
+  qint32 height;
+  double cameraMatrix[9];
+  double newCameraMatrix[9];
+  double distCoeffs[MAX_DIST_COEFFS];
+  qint32 distCount;
+  qint32 roi[4];
+  qint32 reserved;
+};
+
+struct MapRecord
+{
+  ProfileRecord profile; // Perfil ya escalado a la resolución del mapa
+  qint32        width;
+  qint32        height;
+  quint64       map1Offset; // CV_16SC2: width * height * 4 bytes
+  quint64       map2Offset; // CV_16UC1: width * height * 2 bytes
+};
+
+static_assert(sizeof(FileHeader) == 40, "FileHeader sin relleno");
+static_assert(sizeof(ProfileRecord) % 8 == 0, "ProfileRecord alineado a 8");
+static_assert(sizeof(MapRecord) % 8 == 0, "MapRecord alineado a 8");
+
+qint64 alignUp(qint64 value)
+{
+  return (value + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT;
+}
+
+qint64 map1Bytes(const MapRecord& record)
+{
+  return qint64(record.width) * record.height * 4;
+}
+
+qint64 map2Bytes(const MapRecord& record)
+{
+  return qint64(record.width) * record.height * 2;
+}
+
+bool copyMatrix(const cv::Mat& source, double* target, int count)
+{
+  cv::Mat values;
+  source.convertTo(values, CV_64F);
+  if (values.total() != size_t(count))
+    return false;
+  values = values.reshape(1, 1);
+  std::memcpy(target, values.ptr<double>(), sizeof(double) * count);
+  return true;
+}
+
+bool toRecord(const CalibrationProfile& profile, ProfileRecord& record)
+{
+  std::memset(&record, 0, sizeof(record));
+  record.width     = profile.imageSize.width;
+  record.height    = profile.imageSize.height;
+  record.distCount = static_cast<qint32>(profile.distCoeffs.total());
+  record.roi[0]    = profile.roi.x;
+  record.roi[1]    = profile.roi.y;
+  record.roi[2]    = profile.roi.width;
+  record.roi[3]    = profile.roi.height;
+
+  if (record.distCount > MAX_DIST_COEFFS)
+    return false;
+  return copyMatrix(profile.cameraMatrix, record.cameraMatrix, 9) && copyMatrix(profile.newCameraMatrix, record.newCameraMatrix, 9) &&
+         copyMatrix(profile.distCoeffs, record.distCoeffs, record.distCount);
+}
+
+// Versiones del paquete de una cámara en la carpeta, por número de versión
+std::map<int, QString> bundleVersions(const QString& directoryPath, const std::string& cameraName)
+{
+  const QString            safeName = CalibrationProfile::safeCameraName(cameraName);
+  const QRegularExpression pattern("^" + QRegularExpression::escape(safeName) + "\\.(\\d+)\\.calib$");
+
+  std::map<int, QString> versions;
+  const QFileInfoList    fileList = QDir(directoryPath).entryInfoList({safeName + ".*.calib"}, QDir::Files);
+  for (const QFileInfo& fileInfo : fileList) {
+    const QRegularExpressionMatch match = pattern.match(fileInfo.fileName());
+    if (match.hasMatch())
+      versions[match.captured(1).toInt()] = fileInfo.absoluteFilePath();
+  }
+  return versions;
+}
+
+CalibrationProfile fromRecord(const ProfileRecord& record, const std::string& cameraName)
+{
+  CalibrationProfile profile;
+  profile.cameraName      = cameraName;
+  profile.imageSize       = cv::Size(record.width, record.height);
+  profile.cameraMatrix    = cv::Mat(3, 3, CV_64F, const_cast<double*>(record.cameraMatrix)).clone();
+  profile.newCameraMatrix = cv::Mat(3, 3, CV_64F, const_cast<double*>(record.newCameraMatrix)).clone();
+  profile.distCoeffs      = cv::Mat(1, record.distCount, CV_64F, const_cast<double*>(record.distCoeffs)).clone();
+  profile.roi             = cv::Rect(record.roi[0], record.roi[1], record.roi[2], record.roi[3]);
+  return profile;
+}
+} // namespace
+
+QString CalibrationBundle::filePath(const QString& directoryPath, const std::string& cameraName, int version)
+{
+  return QDir(directoryPath).filePath(QString("%1.%2.calib").arg(CalibrationProfile::safeCameraName(cameraName)).arg(version));
+}
+
+/**
+ * @brief Huella de los perfiles de la carpeta a partir de sus metadatos, sin abrir los ficheros.
+ */
+QByteArray CalibrationBundle::sourceStamp(const QString& directoryPath)
+{
+  QCryptographicHash  hash(QCryptographicHash::Sha1);
+  const QFileInfoList fileList = QDir(directoryPath).entryInfoList({"*.yml"}, QDir::Files, QDir::Name);
+  for (const QFileInfo& fileInfo : fileList) {
+    hash.addData(fileInfo.fileName().toUtf8());
+    hash.addData(QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch()));
+    hash.addData(QByteArray::number(fileInfo.size()));
+  }
+  return hash.result();
+}
+
+bool CalibrationBundle::load(const QString& directoryPath, const std::string& cameraName, std::vector<CalibrationProfile>& profiles,
+                             std::vector<std::shared_ptr<const UndistortionData>>& maps)
+{
+  const std::map<int, QString> versions = bundleVersions(directoryPath, cameraName);
+  if (versions.empty())
+    return false;
+
+  auto file = std::make_shared<QFile>(versions.rbegin()->second);
+  if (!file->open(QIODevice::ReadOnly))
+    return false;
+
+  const qint64 fileSize = file->size();
+  if (fileSize < qint64(sizeof(FileHeader)))
+    return false;
+
+  const uchar* base = file->map(0, fileSize);
+  if (!base)
+    return false;
+
+  FileHeader header;
+  std::memcpy(&header, base, sizeof(header));
+  if (header.magic != MAGIC || header.version != VERSION)
+    return false;
+  if (QByteArray(header.stamp, STAMP_SIZE) != sourceStamp(directoryPath))
+    return false; // Los perfiles han cambiado desde que se generó el paquete
+
+  const qint64 recordsEnd = qint64(sizeof(FileHeader)) + qint64(header.profileCount) * sizeof(ProfileRecord) + qint64(header.mapCount) * sizeof(MapRecord);
+  if (recordsEnd > fileSize)
+    return false;
+
+  std::vector<CalibrationProfile>                      loadedProfiles;
+  std::vector<std::shared_ptr<const UndistortionData>> loadedMaps;
+
+  const uchar* cursor = base + sizeof(FileHeader);
+  for (quint32 i = 0; i < header.profileCount; ++i, cursor += sizeof(ProfileRecord)) {
+    ProfileRecord record;
+    std::memcpy(&record, cursor, sizeof(record));
+    if (record.distCount <= 0 || record.distCount > MAX_DIST_COEFFS)
+      return false;
+    loadedProfiles.push_back(fromRecord(record, cameraName));
+  }
+
+  for (quint32 i = 0; i < header.mapCount; ++i, cursor += sizeof(MapRecord)) {
+    MapRecord record;
+    std::memcpy(&record, cursor, sizeof(record));
+    if (record.width <= 0 || record.height <= 0 || record.map1Offset % BLOB_ALIGNMENT || record.map2Offset % BLOB_ALIGNMENT)
+      return false;
+    if (qint64(record.map1Offset) + map1Bytes(record) > fileSize || qint64(record.map2Offset) + map2Bytes(record) > fileSize)
+      return false;
+
+    auto data     = std::make_shared<UndistortionData>();
+    data->mapSize = cv::Size(record.width, record.height);
+    data->storage = file; // El mapeo se libera cuando ningún fotograma usa ya estos mapas
+
+    // Una entrada sin distorsión registrada indica una resolución sin calibración aplicable
+    if (record.profile.distCount > 0 && record.profile.distCount <= MAX_DIST_COEFFS) {
+      data->profile = fromRecord(record.profile, cameraName);
+      data->map1    = cv::Mat(record.height, record.width, CV_16SC2, const_cast<uchar*>(base + record.map1Offset));
+      data->map2    = cv::Mat(record.height, record.width, CV_16UC1, const_cast<uchar*>(base + record.map2Offset));
+    }
+    loadedMaps.push_back(data);
+  }
+
+  profiles = loadedProfiles;
+  maps     = loadedMaps;
+  return true;
+}
+
+bool CalibrationBundle::save(const QString& directoryPath, const std::string& cameraName, const std::vector<CalibrationProfile>& profiles,
+                             const std::vector<std::shared_ptr<const UndistortionData>>& maps)
+{
+  FileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.magic        = MAGIC;
+  header.version      = VERSION;
+  header.profileCount = static_cast<quint32>(profiles.size());
+  header.mapCount     = static_cast<quint32>(maps.size());
+  QByteArray stamp    = sourceStamp(directoryPath);
+  std::memcpy(header.stamp, stamp.constData(), STAMP_SIZE);
+
+  std::vector<ProfileRecord> profileRecords(profiles.size());
+  for (size_t i = 0; i < profiles.size(); ++i) {
+    if (!toRecord(profiles[i], profileRecords[i]))
+      return false;
+  }
+
+  // Las tablas van detrás de todos los registros, cada una alineada a 64 bytes
+  std::vector<MapRecord> mapRecords(maps.size());
+  qint64 offset = qint64(sizeof(FileHeader)) + qint64(profiles.size()) * sizeof(ProfileRecord) + qint64(maps.size()) * sizeof(MapRecord);
+  for (size_t i = 0; i < maps.size(); ++i) {
+    MapRecord& record = mapRecords[i];
+    std::memset(&record, 0, sizeof(record));
+    record.width  = maps[i]->mapSize.width;
+    record.height = maps[i]->mapSize.height;
+
+    if (maps[i]->profile.isValid() && !maps[i]->map1.empty()) {
+      if (!toRecord(maps[i]->profile, record.profile))
+        return false;
+      offset            = alignUp(offset);
+      record.map1Offset = offset;
+      offset += map1Bytes(record);
+      offset            = alignUp(offset);
+      record.map2Offset = offset;
+      offset += map2Bytes(record);
+    }
+  }
+
+  // Serializado: dos tareas no pueden elegir la misma versión ni borrar la que otra acaba de escribir
+  static QMutex                saveMutex;
+  QMutexLocker                 locker(&saveMutex);
+  const std::map<int, QString> versions = bundleVersions(directoryPath, cameraName);
+  const int                    version  = versions.empty() ? 1 : versions.rbegin()->first + 1;
+
+  QSaveFile file(filePath(directoryPath, cameraName, version));
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  for (const ProfileRecord& record : profileRecords)
+    file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+  for (const MapRecord& record : mapRecords)
+    file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+
+  for (size_t i = 0; i < maps.size(); ++i) {
+    const MapRecord& record = mapRecords[i];
+    if (record.map1Offset == 0)
+      continue;
+
+    const cv::Mat map1 = maps[i]->map1.isContinuous() ? maps[i]->map1 : maps[i]->map1.clone();
+    const cv::Mat map2 = maps[i]->map2.isContinuous() ? maps[i]->map2 : maps[i]->map2.clone();
+
+    file.write(QByteArray(int(record.map1Offset - file.pos()), '\0'));
+    file.write(reinterpret_cast<const char*>(map1.data), map1Bytes(record));
+    file.write(QByteArray(int(record.map2Offset - file.pos()), '\0'));
+    file.write(reinterpret_cast<const char*>(map2.data), map2Bytes(record));
+  }
+
+  if (!file.commit()) {
+    qWarning() << "No se pudo guardar el paquete de calibración:" << file.errorString();
+    return false;
+  }
+
+  // Una versión anterior aún mapeada no se puede borrar en Windows: queda para el siguiente guardado
+  for (const auto& previous : versions)
+    QFile::remove(previous.second);
+  QFile::remove(QDir(directoryPath).filePath(CalibrationProfile::safeCameraName(cameraName) + ".calib")); // Formato sin versión
+  return true;
+}
@@ -0,0 +1,52 @@
+#ifndef CALIBRATIONBUNDLE_H
+#define CALIBRATIONBUNDLE_H
+
+#include "CalibrationProfile.h"
+#include <QByteArray>
+#include <QString>
+#include <memory>
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+
+// Mapas de corrección para una resolución. Es inmutable una vez publicado.
+struct UndistortionData
+{
+  CalibrationProfile          profile; // Ya escalado a mapSize; inválido si no hay calibración aplicable
+  cv::Size                    mapSize;
+  cv::Mat                     map1;    // Mapas de cv::remap en punto fijo (CV_16SC2 + CV_16UC1)
+  cv::Mat                     map2;
+  std::shared_ptr<const void> storage; // Fichero mapeado al que apuntan map1/map2, si procede
+};
+
+/**
+ * @brief Paquete binario con los perfiles de una cámara y sus mapas de corrección ya generados.
+ * @details Se guarda como `<carpeta>/<cámara>.<n>.calib` y se abre con QFile::map: los mapas se
+ * usan directamente sobre la memoria del fichero, sin copiarlos ni volver a generarlos. Lleva una
+ * huella de los .yml de la carpeta (nombre, fecha y tamaño); si alguno cambia, el paquete se
+ * ignora y se reconstruye a partir de los perfiles.
+ *
+ * Cada guardado escribe una versión n nueva y load abre la más alta, así nunca se reemplaza un
+ * fichero que puede estar mapeado (en Windows no se puede). Las versiones anteriores se borran al
+ * guardar si ya nadie las tiene mapeadas; si no, en un guardado posterior. Los guardados van de
+ * uno en uno aunque los lancen varias tareas del pool.
+ *
+ * Formato (orden de bytes nativo, versión 1):
+ *   FileHeader | ProfileRecord x profileCount | MapRecord x mapCount | tablas alineadas a 64 bytes
+ */
+class CalibrationBundle
+{
+public:
+  static QString    filePath(const QString& directoryPath, const std::string& cameraName, int version);
+  static QByteArray sourceStamp(const QString& directoryPath);
+
+  static bool load(const QString& directoryPath, const std::string& cameraName, std::vector<CalibrationProfile>& profiles,
+                   std::vector<std::shared_ptr<const UndistortionData>>& maps);
+  static bool save(const QString& directoryPath, const std::string& cameraName, const std::vector<CalibrationProfile>& profiles,
+                   const std::vector<std::shared_ptr<const UndistortionData>>& maps);
+
+  static const quint32 MAGIC   = 0x42434152; // "RACB"
+  static const quint32 VERSION = 1;
+};
+
+#endif // CALIBRATIONBUNDLE_H
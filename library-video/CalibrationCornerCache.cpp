@@ -0,0 +1,185 @@
+#include "CalibrationCornerCache.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
+
+namespace
+{
+const quint32 CACHE_MAGIC   = 0x52414343; // "RACC"
+const quint16 CACHE_VERSION = 2; // v2: identificadores de punto y tipo de patrón
+const int     HASH_SIZE     = 20; // SHA-1
+
+// Bytes mínimos en disco, para acotar los contadores leídos antes de reservar memoria
+const qint64 MIN_ENTRY_BYTES = 4 + 1 + 4 + 4 + 4; // Longitud de la clave, found, tamaño y nº de puntos
+const qint64 CORNER_BYTES    = 4 + 4 + 4;         // x, y (float) e identificador
+} // namespace
+
+const QString CalibrationCornerCache::CACHE_FILE_NAME = ".corners.cache";
+
+CalibrationCornerCache::CalibrationCornerCache(const QString& directoryPath) : m_cachePath(QDir(directoryPath).filePath(CACHE_FILE_NAME))
+{
+}
+
+/**
+ * @brief Hash del contenido del fichero (se lee por bloques, sin decodificar la imagen).
+ */
+QByteArray CalibrationCornerCache::hashFile(const QString& filePath)
+{
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly))
+    return QByteArray();
+
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  if (!hash.addData(&file))
+    return QByteArray();
+  return hash.result();
+}
+
+// El tamaño del cuadrado no influye en las esquinas detectadas, solo en los puntos objeto,
+// por eso la clave incluye el patrón y sus dimensiones. En ChArUco sí influyen el diccionario y
+// la proporción marcador/casilla, que el detector usa para interpolar las esquinas.
+QByteArray CalibrationCornerCache::makeKey(const QByteArray& contentHash, const CalibrationTarget& target)
+{
+  qint32 fields[5] = {static_cast<qint32>(target.pattern), target.boardSize.width, target.boardSize.height, 0, 0};
+  if (target.pattern == CalibrationPattern::ChArUco) {
+    fields[3] = target.dictionary;
+    fields[4] = qRound(1000.0 * target.markerSize / target.squareSize);
+  }
+
+  QByteArray key = contentHash;
+  key.append(reinterpret_cast<const char*>(fields), sizeof(fields));
+  return key;
+}
+
+bool CalibrationCornerCache::load()
+{
+  m_entries.clear();
+  m_dirty = false;
+
+  QFile file(m_cachePath);
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_15);
+  in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+  quint32 magic   = 0;
+  quint16 version = 0;
+  quint32 count   = 0;
+  in >> magic >> version >> count;
+  if (magic != CACHE_MAGIC || version != CACHE_VERSION) {
+    qWarning() << "Caché de esquinas con formato desconocido, se ignorará:" << m_cachePath;
+    return false;
+  }
+
+  // Un fichero truncado o corrupto no puede pedir más entradas ni puntos de los que caben en él
+  if (qint64(count) > (file.size() - file.pos()) / MIN_ENTRY_BYTES) {
+    qWarning() << "Caché de esquinas corrupta, se descartará:" << m_cachePath;
+    return false;
+  }
+  m_entries.reserve(count);
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+    QByteArray       key;
+    CornerCacheEntry entry;
+    qint32           width = 0, height = 0;
+    quint32          nCorners = 0;
+
+    in >> key >> entry.found >> width >> height >> nCorners;
+    if (in.status() != QDataStream::Ok || qint64(nCorners) > (file.size() - file.pos()) / CORNER_BYTES) {
+      in.setStatus(QDataStream::ReadCorruptData);
+      break;
+    }
+    entry.imageSize = cv::Size(width, height);
+    entry.corners.resize(nCorners);
+    entry.ids.resize(nCorners);
+    for (size_t k = 0; k < nCorners; ++k) {
+      qint32 id = 0;
+      in >> entry.corners[k].x >> entry.corners[k].y >> id;
+      entry.ids[k] = id;
+    }
+
+    m_entries.insert(key, entry);
+  }
+
+  if (in.status() != QDataStream::Ok) {
+    qWarning() << "Caché de esquinas corrupta, se descartará:" << m_cachePath;
+    m_entries.clear();
+    return false;
+  }
+  return true;
+}
+
+bool CalibrationCornerCache::save()
+{
+  if (!m_dirty)
+    return true;
+
+  // QSaveFile escribe en un temporal y lo renombra: nunca queda una caché a medias
+  QSaveFile file(m_cachePath);
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_5_15);
+  out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+  out << CACHE_MAGIC << CACHE_VERSION << quint32(m_entries.size());
+  for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+    const CornerCacheEntry& entry = it.value();
+    out << it.key() << entry.found << qint32(entry.imageSize.width) << qint32(entry.imageSize.height) << quint32(entry.corners.size());
+    for (size_t k = 0; k < entry.corners.size(); ++k)
+      out << entry.corners[k].x << entry.corners[k].y << qint32(k < entry.ids.size() ? entry.ids[k] : int(k));
+  }
+
+  if (!file.commit())
+    return false;
+
+  m_dirty = false;
+  return true;
+}
+
+bool CalibrationCornerCache::lookup(const QByteArray& contentHash, const CalibrationTarget& target, CornerCacheEntry& entry) const
+{
+  if (contentHash.isEmpty())
+    return false;
+
+  auto it = m_entries.constFind(makeKey(contentHash, target));
+  if (it == m_entries.cend())
+    return false;
+
+  entry = it.value();
+  return true;
+}
+
+void CalibrationCornerCache::insert(const QByteArray& contentHash, const CalibrationTarget& target, const CornerCacheEntry& entry)
+{
+  if (contentHash.isEmpty())
+    return;
+
+  m_entries.insert(makeKey(contentHash, target), entry);
+  m_dirty = true;
+}
+
+void CalibrationCornerCache::retainOnly(const QList<QByteArray>& contentHashes)
+{
+  QSet<QByteArray> alive(contentHashes.cbegin(), contentHashes.cend());
+
+  for (auto it = m_entries.begin(); it != m_entries.end();) {
+    if (!alive.contains(it.key().left(HASH_SIZE))) {
+      it      = m_entries.erase(it);
+      m_dirty = true;
+    }
+    else
+      ++it;
+  }
+}
+
+int CalibrationCornerCache::size() const
+{
+  return m_entries.size();
+}
@@ -0,0 +1,61 @@
+#ifndef CALIBRATIONCORNERCACHE_H
+#define CALIBRATIONCORNERCACHE_H
+
+#include "CalibrationTarget.h"
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include <opencv2/core/types.hpp>
+#include <vector>
+
+// Resultado de la detección de esquinas de una imagen
+struct CornerCacheEntry
+{
+  bool                     found = false;
+  cv::Size                 imageSize;
+  std::vector<cv::Point2f> corners;
+  std::vector<int>         ids; // Identificador de cada punto en el patrón
+};
+Q_DECLARE_METATYPE(CornerCacheEntry)
+
+/**
+ * @brief Caché persistente de esquinas detectadas para la calibración incremental.
+ * @details Se guarda como un fichero binario junto a las imágenes. Cada entrada se indexa por el
+ * hash del contenido de la imagen y los parámetros del patrón, de forma que renombrar o mover
+ * una captura no invalida su resultado y cambiar de patrón no reutiliza esquinas incorrectas.
+ * También se guardan las imágenes sin tablero para no volver a procesarlas.
+ *
+ * load/insert/save no son atómicos entre sí: la caché de una carpeta solo la escribe
+ * CalibrationWorker, desde su hilo.
+ */
+class CalibrationCornerCache
+{
+public:
+  explicit CalibrationCornerCache(const QString& directoryPath);
+
+  bool load();
+  bool save();
+
+  bool lookup(const QByteArray& contentHash, const CalibrationTarget& target, CornerCacheEntry& entry) const;
+  void insert(const QByteArray& contentHash, const CalibrationTarget& target, const CornerCacheEntry& entry);
+
+  // Elimina las entradas cuyas imágenes ya no están en la carpeta
+  void retainOnly(const QList<QByteArray>& contentHashes);
+
+  int size() const;
+
+  static QByteArray hashFile(const QString& filePath);
+
+  static const QString CACHE_FILE_NAME;
+
+private:
+  QString                              m_cachePath;
+  QHash<QByteArray, CornerCacheEntry> m_entries;
+  bool                                 m_dirty = false;
+
+  static QByteArray makeKey(const QByteArray& contentHash, const CalibrationTarget& target);
+};
+
+#endif // CALIBRATIONCORNERCACHE_H
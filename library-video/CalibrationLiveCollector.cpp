@@ -0,0 +1,279 @@
+#include "CalibrationLiveCollector.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <cmath>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace
+{
+const int    DETECTION_WIDTH     = 640;   // La búsqueda del tablero se hace sobre una copia reducida
+const double MIN_SHARPNESS       = 150.0; // Varianza mínima del Laplaciano dentro del tablero
+const double DUPLICATE_TOLERANCE = 0.02;  // Desplazamiento medio del contorno (fracción de la diagonal)
+const double TILT_THRESHOLD      = 0.05;  // Diferencia relativa entre lados opuestos del tablero
+const int    MAX_ACCEPTED_FRAMES = 40;
+
+int bucket3(double value, double low, double high)
+{
+  if (value < low)
+    return 0;
+  if (value > high)
+    return 2;
+  return 1;
+}
+
+// Libera el flag de ocupado al salir de processFrame por cualquier camino
+struct BusyGuard
+{
+  std::atomic<bool>& busy;
+  ~BusyGuard()
+  {
+    busy.store(false, std::memory_order_release);
+  }
+};
+} // namespace
+
+CalibrationLiveCollector::CalibrationLiveCollector(QObject* parent) : QObject(parent)
+{
+  qRegisterMetaType<PoseCoverage>();
+  qRegisterMetaType<CalibrationTarget>();
+  qRegisterMetaType<CornerCacheEntry>();
+}
+
+bool CalibrationLiveCollector::tryAcquire()
+{
+  bool expected = false;
+  return m_busy.compare_exchange_strong(expected, true, std::memory_order_acq_rel);
+}
+
+void CalibrationLiveCollector::start(const QString& directoryPath, const CalibrationTarget& target)
+{
+  if (!CalibrationTargetDetector::isPatternAvailable(target.pattern)) {
+    qWarning() << "Patrón de calibración no disponible:" << target.name();
+    return;
+  }
+
+  m_directoryPath = directoryPath;
+  m_target        = target;
+  m_detector      = std::make_unique<CalibrationTargetDetector>(target);
+  m_poseKeys.clear();
+  m_positions.clear();
+  m_scales.clear();
+  m_tilts.clear();
+  m_acceptedOutlines.clear();
+  m_running = true;
+}
+
+void CalibrationLiveCollector::stop()
+{
+  if (!m_running)
+    return;
+  m_running = false;
+  emit collectionFinished(coverage());
+}
+
+void CalibrationLiveCollector::processFrame(const QImage& frame)
+{
+  BusyGuard guard{m_busy};
+
+  if (!m_running || frame.isNull())
+    return;
+
+  QImage  rgb = frame.convertToFormat(QImage::Format_RGB888);
+  cv::Mat rgbMat(rgb.height(), rgb.width(), CV_8UC3, const_cast<uchar*>(rgb.constBits()), rgb.bytesPerLine());
+  cv::Mat gray;
+  cv::cvtColor(rgbMat, gray, cv::COLOR_RGB2GRAY);
+
+  std::vector<cv::Point2f> corners;
+  std::vector<int>         ids;
+  if (!detectBoard(gray, corners, ids))
+    return; // Sin tablero a la vista: no se informa para no saturar la interfaz
+
+  std::vector<cv::Point2f> outline;
+  if (!projectOutline(corners, ids, outline))
+    return;
+
+  double sharpness = boardSharpness(gray, corners);
+  if (sharpness < MIN_SHARPNESS) {
+    emit frameRejected(tr("Tablero borroso (nitidez %1)").arg(sharpness, 0, 'f', 0));
+    return;
+  }
+
+  PoseKey pose = classifyPose(outline, gray.size());
+  int     key  = ((pose.position * 3 + pose.scale) * 3 + pose.tiltX) * 3 + pose.tiltY;
+  if (m_poseKeys.contains(key)) {
+    emit frameRejected(tr("Pose ya cubierta"));
+    return;
+  }
+  if (isDuplicate(outline, gray.size())) {
+    emit frameRejected(tr("Vista duplicada"));
+    return;
+  }
+
+  QString filePath = saveFrame(frame, corners, ids, gray.size());
+  if (filePath.isEmpty()) {
+    emit frameRejected(tr("No se pudo guardar la captura"));
+    return;
+  }
+
+  m_poseKeys.insert(key);
+  m_positions.insert(pose.position);
+  m_scales.insert(pose.scale);
+  m_tilts.insert(pose.tiltX * 3 + pose.tiltY);
+  m_acceptedOutlines.push_back(outline);
+
+  emit frameAccepted(filePath, coverage());
+
+  if (static_cast<int>(m_acceptedOutlines.size()) >= MAX_ACCEPTED_FRAMES)
+    stop();
+}
+
+/**
+ * @brief Busca el patrón en una copia reducida (en modo rápido, que descarta enseguida los
+ * fotogramas sin patrón) y refina las esquinas sobre la imagen completa. Los centros de los
+ * círculos no se refinan: cornerSubPix solo tiene sentido en esquinas.
+ */
+bool CalibrationLiveCollector::detectBoard(const cv::Mat& gray, std::vector<cv::Point2f>& corners, std::vector<int>& ids) const
+{
+  double  scale = std::min(1.0, double(DETECTION_WIDTH) / gray.cols);
+  cv::Mat small;
+  if (scale < 1.0)
+    cv::resize(gray, small, cv::Size(), scale, scale, cv::INTER_AREA);
+  else
+    small = gray;
+
+  if (!m_detector || !m_detector->detect(small, corners, ids, true))
+    return false;
+
+  for (cv::Point2f& pt : corners)
+    pt *= 1.0 / scale;
+
+  if (m_target.pattern != CalibrationPattern::AsymmetricCircles) {
+    cv::cornerSubPix(gray, corners, cv::Size(11, 11), cv::Size(-1, -1),
+                     cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::MAX_ITER, 30, 0.001));
+  }
+  return true;
+}
+
+/**
+ * @brief Proyecta el contorno completo del patrón sobre la imagen mediante la homografía
+ * tablero-imagen. Así la pose se mide igual aunque solo se vea una parte del tablero (ChArUco)
+ * o aunque el patrón no tenga vértices en las esquinas (círculos).
+ */
+bool CalibrationLiveCollector::projectOutline(const std::vector<cv::Point2f>& corners, const std::vector<int>& ids,
+                                              std::vector<cv::Point2f>& outline) const
+{
+  const std::vector<cv::Point3f> objectPoints = m_target.objectPoints(ids);
+  if (objectPoints.size() != corners.size() || corners.size() < 4)
+    return false;
+
+  std::vector<cv::Point2f> planePoints;
+  planePoints.reserve(objectPoints.size());
+  for (const cv::Point3f& pt : objectPoints)
+    planePoints.emplace_back(pt.x, pt.y);
+
+  cv::Mat homography = cv::findHomography(planePoints, corners);
+  if (homography.empty())
+    return false;
+
+  std::vector<cv::Point2f> planeOutline;
+  for (const cv::Point3f& pt : m_target.outline())
+    planeOutline.emplace_back(pt.x, pt.y);
+  cv::perspectiveTransform(planeOutline, outline, homography);
+  return true;
+}
+
+/**
+ * @brief Clasifica la vista por posición del centro (3x3), área aparente (3) e inclinación
+ * horizontal y vertical (3x3), estimadas a partir de los cuatro vértices del contorno.
+ */
+CalibrationLiveCollector::PoseKey CalibrationLiveCollector::classifyPose(const std::vector<cv::Point2f>& outline, cv::Size imageSize) const
+{
+  cv::Point2f tl = outline[0];
+  cv::Point2f tr = outline[1];
+  cv::Point2f br = outline[2];
+  cv::Point2f bl = outline[3];
+
+  cv::Point2f center = (tl + tr + br + bl) * 0.25f;
+
+  int col = std::min(2, std::max(0, int(3.0 * center.x / imageSize.width)));
+  int row = std::min(2, std::max(0, int(3.0 * center.y / imageSize.height)));
+
+  std::vector<cv::Point2f> quad = {tl, tr, br, bl};
+  double                   area = cv::contourArea(quad) / double(imageSize.area());
+
+  double top    = cv::norm(tr - tl);
+  double bottom = cv::norm(br - bl);
+  double left   = cv::norm(bl - tl);
+  double right  = cv::norm(br - tr);
+
+  PoseKey key;
+  key.position = row * 3 + col;
+  key.scale    = bucket3(area, 0.08, 0.25);
+  key.tiltX    = bucket3((top - bottom) / (top + bottom), -TILT_THRESHOLD, TILT_THRESHOLD);
+  key.tiltY    = bucket3((left - right) / (left + right), -TILT_THRESHOLD, TILT_THRESHOLD);
+  return key;
+}
+
+double CalibrationLiveCollector::boardSharpness(const cv::Mat& gray, const std::vector<cv::Point2f>& corners) const
+{
+  cv::Rect roi = cv::boundingRect(corners) & cv::Rect(0, 0, gray.cols, gray.rows);
+  if (roi.empty())
+    return 0.0;
+
+  cv::Mat laplacian;
+  cv::Laplacian(gray(roi), laplacian, CV_64F);
+
+  cv::Scalar mean, stddev;
+  cv::meanStdDev(laplacian, mean, stddev);
+  return stddev[0] * stddev[0];
+}
+
+bool CalibrationLiveCollector::isDuplicate(const std::vector<cv::Point2f>& outline, cv::Size imageSize) const
+{
+  const double tolerance = DUPLICATE_TOLERANCE * std::hypot(imageSize.width, imageSize.height);
+
+  for (const std::vector<cv::Point2f>& accepted : m_acceptedOutlines) {
+    double sum = 0.0;
+    for (size_t i = 0; i < outline.size(); ++i)
+      sum += cv::norm(outline[i] - accepted[i]);
+    if (sum / outline.size() < tolerance)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Guarda el fotograma junto a las capturas manuales y entrega sus esquinas para la caché,
+ * así la calibración posterior no tiene que volver a buscarlas.
+ */
+QString CalibrationLiveCollector::saveFrame(const QImage& frame, const std::vector<cv::Point2f>& corners, const std::vector<int>& ids,
+                                            cv::Size imageSize)
+{
+  QDir().mkpath(m_directoryPath);
+
+  QString timestamp = QDateTime::currentDateTime().toString("dd_hhmmss_zzz");
+  QString filePath  = QDir(m_directoryPath).filePath(QString("auto_%1.tiff").arg(timestamp));
+  if (!frame.save(filePath, "TIFF"))
+    return QString();
+
+  CornerCacheEntry entry;
+  entry.found     = true;
+  entry.imageSize = imageSize;
+  entry.corners   = corners;
+  entry.ids       = ids;
+
+  emit cornersDetected(filePath, m_target, entry);
+  return filePath;
+}
+
+PoseCoverage CalibrationLiveCollector::coverage() const
+{
+  PoseCoverage result;
+  result.positions      = m_positions.size();
+  result.scales         = m_scales.size();
+  result.tilts          = m_tilts.size();
+  result.acceptedFrames = static_cast<int>(m_acceptedOutlines.size());
+  return result;
+}
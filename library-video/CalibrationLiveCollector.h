@@ -0,0 +1,89 @@
+#ifndef CALIBRATIONLIVECOLLECTOR_H
+#define CALIBRATIONLIVECOLLECTOR_H
+
+#include "CalibrationCornerCache.h"
+#include "CalibrationTarget.h"
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include <opencv2/core.hpp>
+#include <vector>
+
+// Cobertura de poses acumulada por la captura automática
+struct PoseCoverage
+{
+  int positions      = 0; // Celdas de posición ocupadas (rejilla 3x3)
+  int scales         = 0; // Rangos de tamaño aparente ocupados (3)
+  int tilts          = 0; // Combinaciones de inclinación ocupadas (3x3)
+  int acceptedFrames = 0;
+
+  static const int TOTAL_POSITIONS = 9;
+  static const int TOTAL_SCALES    = 3;
+  static const int TOTAL_TILTS     = 9;
+};
+Q_DECLARE_METATYPE(PoseCoverage)
+
+/**
+ * @brief Selección automática de fotogramas de calibración sobre el vídeo en directo.
+ * @details Se ejecuta en su propio hilo. El diálogo le entrega fotogramas a baja frecuencia y
+ * solo si no está ocupado; cada fotograma con el patrón visible se clasifica por posición,
+ * escala e inclinación y únicamente se guarda si ocupa una combinación nueva. Se descartan los
+ * fotogramas borrosos y los que repiten una vista ya guardada.
+ */
+class CalibrationLiveCollector : public QObject
+{
+  Q_OBJECT
+public:
+  explicit CalibrationLiveCollector(QObject* parent = nullptr);
+
+  // Llamado desde el hilo de la GUI: false si todavía se está procesando el fotograma anterior
+  bool tryAcquire();
+
+public slots:
+  void start(const QString& directoryPath, const CalibrationTarget& target);
+  void stop();
+  void processFrame(const QImage& frame);
+
+signals:
+  void frameAccepted(const QString& filePath, const PoseCoverage& coverage);
+  // Esquinas de la captura guardada, para la caché (la escribe CalibrationWorker)
+  void cornersDetected(const QString& filePath, const CalibrationTarget& target, const CornerCacheEntry& entry);
+  void frameRejected(const QString& reason);
+  void collectionFinished(const PoseCoverage& coverage);
+
+private:
+  struct PoseKey
+  {
+    int position;
+    int scale;
+    int tiltX;
+    int tiltY;
+  };
+
+  std::atomic<bool> m_busy{false};
+  bool              m_running = false;
+
+  QString                                    m_directoryPath;
+  CalibrationTarget                          m_target;
+  std::unique_ptr<CalibrationTargetDetector> m_detector;
+
+  QSet<int>                             m_poseKeys;
+  QSet<int>                             m_positions;
+  QSet<int>                             m_scales;
+  QSet<int>                             m_tilts;
+  std::vector<std::vector<cv::Point2f>> m_acceptedOutlines; // Contorno proyectado de cada vista guardada
+
+  bool    detectBoard(const cv::Mat& gray, std::vector<cv::Point2f>& corners, std::vector<int>& ids) const;
+  bool    projectOutline(const std::vector<cv::Point2f>& corners, const std::vector<int>& ids, std::vector<cv::Point2f>& outline) const;
+  PoseKey classifyPose(const std::vector<cv::Point2f>& outline, cv::Size imageSize) const;
+  double  boardSharpness(const cv::Mat& gray, const std::vector<cv::Point2f>& corners) const;
+  bool    isDuplicate(const std::vector<cv::Point2f>& outline, cv::Size imageSize) const;
+  QString saveFrame(const QImage& frame, const std::vector<cv::Point2f>& corners, const std::vector<int>& ids, cv::Size imageSize);
+
+  PoseCoverage coverage() const;
+};
+
+#endif // CALIBRATIONLIVECOLLECTOR_H
@@ -0,0 +1,199 @@
+#include "CalibrationProfile.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <algorithm>
+#include <cmath>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/core/persistence.hpp>
+
+const QString CalibrationProfile::LEGACY_CAMERA_MATRIX_FILE = "camera_matrix.yml";
+const QString CalibrationProfile::LEGACY_DIST_COEFFS_FILE   = "dist_coeffs.yml";
+
+namespace
+{
+const double ASPECT_TOLERANCE = 0.01; // Diferencia relativa admitida entre relaciones de aspecto
+} // namespace
+
+bool CalibrationProfile::isValid() const
+{
+  return !cameraMatrix.empty() && !distCoeffs.empty() && !newCameraMatrix.empty();
+}
+
+bool CalibrationProfile::isLegacy() const
+{
+  return imageSize.empty();
+}
+
+/**
+ * @brief El escalado solo es exacto si la cámara no recorta el sensor, es decir, si la nueva
+ * resolución conserva la relación de aspecto de la calibrada.
+ */
+bool CalibrationProfile::canScaleTo(cv::Size size) const
+{
+  if (isLegacy() || size.empty())
+    return false;
+
+  double calibrated = double(imageSize.width) / imageSize.height;
+  double requested  = double(size.width) / size.height;
+  return std::abs(calibrated - requested) <= ASPECT_TOLERANCE * calibrated;
+}
+
+/**
+ * @brief Reescala los intrínsecos a otra resolución.
+ * @details Con centros de píxel en coordenadas enteras, x' = (x + 0.5)·s − 0.5, por lo que la
+ * focal se multiplica por s y el punto principal sigue esa misma relación. La distorsión está
+ * en coordenadas normalizadas y no cambia; la matriz óptima se recalcula para el nuevo tamaño.
+ */
+CalibrationProfile CalibrationProfile::scaledTo(cv::Size size) const
+{
+  if (isLegacy() || size == imageSize)
+    return *this;
+
+  const double sx = double(size.width) / imageSize.width;
+  const double sy = double(size.height) / imageSize.height;
+
+  cv::Mat k;
+  cameraMatrix.convertTo(k, CV_64F); // Copia propia: el perfil original no se modifica
+  k.at<double>(0, 0) *= sx;
+  k.at<double>(0, 1) *= sx;
+  k.at<double>(0, 2) = (k.at<double>(0, 2) + 0.5) * sx - 0.5;
+  k.at<double>(1, 1) *= sy;
+  k.at<double>(1, 2) = (k.at<double>(1, 2) + 0.5) * sy - 0.5;
+
+  CalibrationProfile scaled = *this;
+  scaled.imageSize          = size;
+  scaled.cameraMatrix       = k;
+  scaled.newCameraMatrix    = cv::getOptimalNewCameraMatrix(scaled.cameraMatrix, distCoeffs, size, 1, size, &scaled.roi);
+  return scaled;
+}
+
+bool CalibrationProfile::save(const QString& directoryPath) const
+{
+  if (!isValid() || isLegacy())
+    return false;
+
+  QDir().mkpath(directoryPath);
+  QString filePath = QDir(directoryPath).filePath(fileName(cameraName, imageSize));
+
+  cv::FileStorage fs(filePath.toStdString(), cv::FileStorage::WRITE);
+  if (!fs.isOpened()) {
+    qWarning() << "Error al abrir archivo de perfil de calibración:" << filePath;
+    return false;
+  }
+  fs << "camera_name" << cameraName;
+  fs << "image_width" << imageSize.width;
+  fs << "image_height" << imageSize.height;
+  fs << "m_cameraMatrix" << cameraMatrix;
+  fs << "m_distCoeffs" << distCoeffs;
+  fs << "m_newCameraMatrix" << newCameraMatrix;
+  fs << "roi" << roi;
+  fs.release();
+  return true;
+}
+
+QString CalibrationProfile::safeCameraName(const std::string& cameraName)
+{
+  // El nombre del dispositivo puede contener espacios, paréntesis o barras
+  QString safeName = QString::fromStdString(cameraName);
+  safeName.replace(QRegularExpression("[^A-Za-z0-9_-]+"), "_");
+  if (safeName.isEmpty())
+    safeName = "camera";
+  return safeName;
+}
+
+QString CalibrationProfile::fileName(const std::string& cameraName, cv::Size imageSize)
+{
+  return QString("%1_%2x%3.yml").arg(safeCameraName(cameraName)).arg(imageSize.width).arg(imageSize.height);
+}
+
+/**
+ * @brief Lee los perfiles de una cámara, de mayor a menor resolución, seguidos del perfil antiguo.
+ * @details Se compara el nombre guardado dentro del fichero, no el del fichero, que está saneado.
+ */
+std::vector<CalibrationProfile> CalibrationProfile::loadAll(const QString& directoryPath, const std::string& cameraName)
+{
+  std::vector<CalibrationProfile> profiles;
+
+  const QFileInfoList fileList = QDir(directoryPath).entryInfoList({"*.yml"}, QDir::Files, QDir::Name);
+  for (const QFileInfo& fileInfo : fileList) {
+    if (fileInfo.fileName() == LEGACY_CAMERA_MATRIX_FILE || fileInfo.fileName() == LEGACY_DIST_COEFFS_FILE)
+      continue;
+
+    cv::FileStorage fs(fileInfo.absoluteFilePath().toStdString(), cv::FileStorage::READ);
+    if (!fs.isOpened() || fs["camera_name"].empty())
+      continue;
+
+    CalibrationProfile profile;
+    fs["camera_name"] >> profile.cameraName;
+    if (profile.cameraName != cameraName)
+      continue;
+
+    fs["image_width"] >> profile.imageSize.width;
+    fs["image_height"] >> profile.imageSize.height;
+    fs["m_cameraMatrix"] >> profile.cameraMatrix;
+    fs["m_distCoeffs"] >> profile.distCoeffs;
+    fs["m_newCameraMatrix"] >> profile.newCameraMatrix;
+    fs["roi"] >> profile.roi;
+
+    if (profile.isValid() && !profile.isLegacy())
+      profiles.push_back(profile);
+    else
+      qWarning() << "Perfil de calibración incompleto:" << fileInfo.fileName();
+  }
+
+  std::sort(profiles.begin(), profiles.end(),
+            [](const CalibrationProfile& a, const CalibrationProfile& b) { return a.imageSize.area() > b.imageSize.area(); });
+
+  // El par antiguo no dice a qué cámara ni resolución corresponde: solo sirve a una cámara sin perfiles
+  if (profiles.empty()) {
+    CalibrationProfile legacy = loadLegacy(directoryPath);
+    if (legacy.isValid())
+      profiles.push_back(legacy);
+  }
+
+  return profiles;
+}
+
+CalibrationProfile CalibrationProfile::loadLegacy(const QString& directoryPath)
+{
+  CalibrationProfile profile;
+
+  cv::FileStorage fsCam(QDir(directoryPath).filePath(LEGACY_CAMERA_MATRIX_FILE).toStdString(), cv::FileStorage::READ);
+  cv::FileStorage fsDist(QDir(directoryPath).filePath(LEGACY_DIST_COEFFS_FILE).toStdString(), cv::FileStorage::READ);
+  if (!fsCam.isOpened() || !fsDist.isOpened())
+    return profile;
+
+  fsCam["m_cameraMatrix"] >> profile.cameraMatrix;
+  fsCam["m_newCameraMatrix"] >> profile.newCameraMatrix;
+  fsDist["m_distCoeffs"] >> profile.distCoeffs;
+  return profile;
+}
+
+/**
+ * @brief Elige el perfil para una resolución.
+ * @details Prioridad: perfil exacto; perfil escalable con la misma relación de aspecto (el de
+ * mayor resolución, que al reducirse pierde menos precisión); perfil antiguo tal cual, que loadAll
+ * solo devuelve cuando la cámara no tiene ningún perfil propio.
+ */
+CalibrationProfile CalibrationProfile::select(const std::vector<CalibrationProfile>& profiles, cv::Size size)
+{
+  for (const CalibrationProfile& profile : profiles) {
+    if (!profile.isLegacy() && profile.imageSize == size)
+      return profile;
+  }
+
+  // loadAll los deja ordenados de mayor a menor resolución
+  for (const CalibrationProfile& profile : profiles) {
+    if (profile.canScaleTo(size))
+      return profile.scaledTo(size);
+  }
+
+  for (const CalibrationProfile& profile : profiles) {
+    if (profile.isLegacy())
+      return profile;
+  }
+
+  return CalibrationProfile();
+}
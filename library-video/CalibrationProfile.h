@@ -0,0 +1,45 @@
+#ifndef CALIBRATIONPROFILE_H
+#define CALIBRATIONPROFILE_H
+
+#include <QString>
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Calibración de una cámara a una resolución concreta.
+ * @details Cada perfil se guarda en `<carpeta>/<cámara>_<ancho>x<alto>.yml`. El par antiguo
+ * camera_matrix.yml/dist_coeffs.yml ya no se escribe; se sigue leyendo como perfil sin resolución
+ * conocida solo cuando la cámara no tiene ningún perfil propio.
+ */
+struct CalibrationProfile
+{
+  std::string cameraName;
+  cv::Size    imageSize; // Vacío en el perfil antiguo
+  cv::Mat     cameraMatrix;
+  cv::Mat     distCoeffs;
+  cv::Mat     newCameraMatrix;
+  cv::Rect    roi;
+
+  bool isValid() const;
+  bool isLegacy() const;
+  bool canScaleTo(cv::Size size) const;
+
+  // Intrínsecos equivalentes a otra resolución con la misma relación de aspecto
+  CalibrationProfile scaledTo(cv::Size size) const;
+
+  bool save(const QString& directoryPath) const;
+
+  static QString                         safeCameraName(const std::string& cameraName);
+  static QString                         fileName(const std::string& cameraName, cv::Size imageSize);
+  static std::vector<CalibrationProfile> loadAll(const QString& directoryPath, const std::string& cameraName);
+  static CalibrationProfile              loadLegacy(const QString& directoryPath);
+
+  // Perfil aplicable a una resolución (ya escalado); inválido si no hay ninguno
+  static CalibrationProfile select(const std::vector<CalibrationProfile>& profiles, cv::Size size);
+
+  static const QString LEGACY_CAMERA_MATRIX_FILE;
+  static const QString LEGACY_DIST_COEFFS_FILE;
+};
+
+#endif // CALIBRATIONPROFILE_H
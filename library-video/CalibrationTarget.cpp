@@ -0,0 +1,219 @@
+#include "CalibrationTarget.h"
+#include <QDebug>
+#include <algorithm>
+#include <numeric>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/core/version.hpp>
+#include <opencv2/features2d.hpp>
+#include <opencv2/imgproc.hpp>
+
+// El detector ChArUco forma parte de objdetect desde OpenCV 4.7 (antes estaba en contrib)
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 7)
+#define ROBOTARM_HAVE_CHARUCO 1
+#include <opencv2/objdetect/charuco_detector.hpp>
+#else
+#define ROBOTARM_HAVE_CHARUCO 0
+#endif
+
+namespace
+{
+const int CHARUCO_MIN_POINTS = 6; // Vista parcial mínima: suficiente para la homografía y sin colinealidad típica
+} // namespace
+
+CalibrationTarget CalibrationTarget::defaults(CalibrationPattern pattern)
+{
+  CalibrationTarget target;
+  target.pattern = pattern;
+  switch (pattern) {
+    case CalibrationPattern::Chessboard:
+      target.boardSize  = cv::Size(9, 6);
+      target.squareSize = 10.0f;
+      break;
+    case CalibrationPattern::ChArUco:
+      target.boardSize  = cv::Size(7, 5);
+      target.squareSize = 30.0f;
+      target.markerSize = 22.0f;
+      target.dictionary = 5; // cv::aruco::DICT_5X5_100
+      break;
+    case CalibrationPattern::AsymmetricCircles:
+      target.boardSize  = cv::Size(4, 11);
+      target.squareSize = 20.0f;
+      break;
+  }
+  return target;
+}
+
+QString CalibrationTarget::name() const
+{
+  switch (pattern) {
+    case CalibrationPattern::Chessboard:
+      return QString("Chessboard %1x%2").arg(boardSize.width).arg(boardSize.height);
+    case CalibrationPattern::ChArUco:
+      return QString("ChArUco %1x%2").arg(boardSize.width).arg(boardSize.height);
+    case CalibrationPattern::AsymmetricCircles:
+      return QString("Circles %1x%2").arg(boardSize.width).arg(boardSize.height);
+  }
+  return QString();
+}
+
+int CalibrationTarget::pointCount() const
+{
+  if (pattern == CalibrationPattern::ChArUco)
+    return (boardSize.width - 1) * (boardSize.height - 1);
+  return boardSize.area();
+}
+
+int CalibrationTarget::minimumPoints() const
+{
+  return supportsPartialViews() ? std::min(CHARUCO_MIN_POINTS, pointCount()) : pointCount();
+}
+
+bool CalibrationTarget::supportsPartialViews() const
+{
+  return pattern == CalibrationPattern::ChArUco;
+}
+
+std::vector<cv::Point3f> CalibrationTarget::objectPoints() const
+{
+  std::vector<cv::Point3f> points;
+  points.reserve(pointCount());
+
+  switch (pattern) {
+    case CalibrationPattern::Chessboard:
+      for (int i = 0; i < boardSize.height; ++i) {
+        for (int j = 0; j < boardSize.width; ++j)
+          points.emplace_back(j * squareSize, i * squareSize, 0);
+      }
+      break;
+    case CalibrationPattern::ChArUco:
+      // Mismo orden que CharucoBoard::getChessboardCorners(): esquinas interiores por filas
+      for (int i = 1; i < boardSize.height; ++i) {
+        for (int j = 1; j < boardSize.width; ++j)
+          points.emplace_back(j * squareSize, i * squareSize, 0);
+      }
+      break;
+    case CalibrationPattern::AsymmetricCircles:
+      // Las filas impares están desplazadas media separación
+      for (int i = 0; i < boardSize.height; ++i) {
+        for (int j = 0; j < boardSize.width; ++j)
+          points.emplace_back((2 * j + i % 2) * squareSize, i * squareSize, 0);
+      }
+      break;
+  }
+  return points;
+}
+
+std::vector<cv::Point3f> CalibrationTarget::objectPoints(const std::vector<int>& ids) const
+{
+  const std::vector<cv::Point3f> all = objectPoints();
+
+  std::vector<cv::Point3f> points;
+  points.reserve(ids.size());
+  for (int id : ids) {
+    if (id >= 0 && id < static_cast<int>(all.size()))
+      points.push_back(all[id]);
+  }
+  return points;
+}
+
+std::vector<cv::Point3f> CalibrationTarget::outline() const
+{
+  const std::vector<cv::Point3f> all = objectPoints();
+
+  float minX = all.front().x, maxX = all.front().x, minY = all.front().y, maxY = all.front().y;
+  for (const cv::Point3f& pt : all) {
+    minX = std::min(minX, pt.x);
+    maxX = std::max(maxX, pt.x);
+    minY = std::min(minY, pt.y);
+    maxY = std::max(maxY, pt.y);
+  }
+  return {{minX, minY, 0}, {maxX, minY, 0}, {maxX, maxY, 0}, {minX, maxY, 0}};
+}
+
+#if ROBOTARM_HAVE_CHARUCO
+struct CalibrationTargetDetector::CharucoState
+{
+  cv::aruco::CharucoBoard    board;
+  cv::aruco::CharucoDetector detector;
+
+  explicit CharucoState(const CalibrationTarget& target)
+    : board(target.boardSize, target.squareSize, target.markerSize, cv::aruco::getPredefinedDictionary(target.dictionary)), detector(board)
+  {
+  }
+};
+#else
+struct CalibrationTargetDetector::CharucoState
+{
+};
+#endif
+
+CalibrationTargetDetector::CalibrationTargetDetector(const CalibrationTarget& target) : m_target(target)
+{
+#if ROBOTARM_HAVE_CHARUCO
+  if (target.pattern == CalibrationPattern::ChArUco)
+    m_charuco = std::make_unique<CharucoState>(target);
+#endif
+}
+
+CalibrationTargetDetector::~CalibrationTargetDetector() = default;
+
+const CalibrationTarget& CalibrationTargetDetector::target() const
+{
+  return m_target;
+}
+
+bool CalibrationTargetDetector::isPatternAvailable(CalibrationPattern pattern)
+{
+  return pattern != CalibrationPattern::ChArUco || ROBOTARM_HAVE_CHARUCO;
+}
+
+bool CalibrationTargetDetector::detect(const cv::Mat& gray, std::vector<cv::Point2f>& points, std::vector<int>& ids, bool fastCheck) const
+{
+  points.clear();
+  ids.clear();
+
+  bool found = false;
+  switch (m_target.pattern) {
+    case CalibrationPattern::Chessboard: {
+      int flags = cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_NORMALIZE_IMAGE;
+      if (fastCheck)
+        flags |= cv::CALIB_CB_FAST_CHECK;
+      found = cv::findChessboardCorners(gray, m_target.boardSize, points, flags);
+      if (found) {
+        cv::cornerSubPix(gray, points, cv::Size(11, 11), cv::Size(-1, -1),
+                         cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::MAX_ITER, 30, 0.001));
+      }
+      break;
+    }
+    case CalibrationPattern::AsymmetricCircles: {
+      // El detector por defecto limita el área de los círculos a 5000 px, poco para cámaras HD
+      cv::SimpleBlobDetector::Params params;
+      params.maxArea = static_cast<float>(gray.total()) / m_target.pointCount();
+      found          = cv::findCirclesGrid(gray, m_target.boardSize, points, cv::CALIB_CB_ASYMMETRIC_GRID, cv::SimpleBlobDetector::create(params));
+      break;
+    }
+    case CalibrationPattern::ChArUco: {
+#if ROBOTARM_HAVE_CHARUCO
+      // Los marcadores identifican cada esquina: basta una parte del tablero y la ausencia de
+      // marcadores descarta la imagen sin más búsqueda
+      m_charuco->detector.detectBoard(gray, points, ids);
+      found = static_cast<int>(ids.size()) >= m_target.minimumPoints();
+#else
+      qWarning() << "ChArUco requiere OpenCV 4.7 o posterior";
+#endif
+      break;
+    }
+  }
+
+  if (!found) {
+    points.clear();
+    ids.clear();
+    return false;
+  }
+
+  if (ids.empty()) {
+    ids.resize(points.size());
+    std::iota(ids.begin(), ids.end(), 0);
+  }
+  return true;
+}
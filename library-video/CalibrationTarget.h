@@ -0,0 +1,73 @@
+#ifndef CALIBRATIONTARGET_H
+#define CALIBRATIONTARGET_H
+
+#include <QMetaType>
+#include <QString>
+#include <memory>
+#include <opencv2/core.hpp>
+#include <vector>
+
+enum class CalibrationPattern
+{
+  Chessboard        = 0,
+  ChArUco           = 1,
+  AsymmetricCircles = 2,
+};
+
+/**
+ * @brief Descripción del patrón de calibración.
+ * @details El significado de boardSize depende del patrón:
+ *   - Chessboard: esquinas interiores (columnas x filas).
+ *   - ChArUco: casillas del tablero (columnas x filas); los puntos son sus esquinas interiores.
+ *   - AsymmetricCircles: círculos por fila x filas; squareSize es la distancia entre los centros
+ *     de filas consecutivas (la mitad de la separación dentro de una fila).
+ * Cada punto tiene un identificador fijo (su índice en objectPoints()), de forma que las vistas
+ * parciales de ChArUco se pueden emparejar con sus puntos objeto.
+ */
+struct CalibrationTarget
+{
+  CalibrationPattern pattern    = CalibrationPattern::Chessboard;
+  cv::Size           boardSize  = cv::Size(9, 6);
+  float              squareSize = 10.0f; // mm
+  float              markerSize = 0.0f;  // mm, solo ChArUco
+  int                dictionary = 0;     // cv::aruco::PredefinedDictionaryType, solo ChArUco
+
+  static CalibrationTarget defaults(CalibrationPattern pattern);
+
+  QString                  name() const;
+  int                      pointCount() const;
+  int                      minimumPoints() const; // Puntos necesarios para aceptar una vista
+  bool                     supportsPartialViews() const;
+  std::vector<cv::Point3f> objectPoints() const;
+  std::vector<cv::Point3f> objectPoints(const std::vector<int>& ids) const;
+  std::vector<cv::Point3f> outline() const; // Contorno exterior del patrón, en orden TL, TR, BR, BL
+};
+Q_DECLARE_METATYPE(CalibrationTarget)
+
+/**
+ * @brief Detector de los puntos de un patrón.
+ * @details Se construye una vez por sesión de calibración: el detector ChArUco prepara su
+ * diccionario y tablero en el constructor. detect() es const y se puede llamar desde varios
+ * hilos a la vez.
+ */
+class CalibrationTargetDetector
+{
+public:
+  explicit CalibrationTargetDetector(const CalibrationTarget& target);
+  ~CalibrationTargetDetector();
+
+  // fastCheck descarta enseguida las imágenes sin patrón (se usa en la captura en directo)
+  bool detect(const cv::Mat& gray, std::vector<cv::Point2f>& points, std::vector<int>& ids, bool fastCheck = false) const;
+
+  const CalibrationTarget& target() const;
+
+  static bool isPatternAvailable(CalibrationPattern pattern);
+
+private:
+  struct CharucoState;
+
+  CalibrationTarget             m_target;
+  std::unique_ptr<CharucoState> m_charuco;
+};
+
+#endif // CALIBRATIONTARGET_H
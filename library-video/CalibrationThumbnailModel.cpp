@@ -0,0 +1,297 @@
+#include "CalibrationThumbnailModel.h"
+#include <QBrush>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <algorithm>
+
+namespace
+{
+const char SOURCE_FILE_NAME[] = "source"; // Ruta de la carpeta de imágenes de cada subcarpeta
+
+QString sha1Hex(const QString& text)
+{
+  return QString::fromLatin1(QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Sha1).toHex());
+}
+} // namespace
+
+CalibrationThumbnailModel::CalibrationThumbnailModel(QObject* parent) : QAbstractListModel(parent)
+{
+  m_cacheDir = QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("thumbnails");
+  QDir().mkpath(m_cacheDir);
+
+  // Dejamos un núcleo libre para la GUI y el hilo de captura
+  m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+
+  m_placeholder = QPixmap(THUMBNAIL_SIZE, THUMBNAIL_SIZE);
+  m_placeholder.fill(Qt::darkGray);
+
+  const QString cacheRoot = m_cacheDir;
+  m_pool.start([cacheRoot]() { pruneCache(cacheRoot); });
+}
+
+CalibrationThumbnailModel::~CalibrationThumbnailModel()
+{
+  // Ninguna tarea del pool puede sobrevivir al modelo
+  m_pool.clear();
+  m_pool.waitForDone();
+}
+
+void CalibrationThumbnailModel::setDirectory(const QString& directoryPath, const QStringList& nameFilters)
+{
+  beginResetModel();
+
+  m_generation++;
+  m_pool.clear();
+  m_pending.clear();
+  m_items.clear();
+
+  // Solo se consultan los metadatos: ninguna imagen se abre aquí
+  const QFileInfoList fileList = QDir(directoryPath).entryInfoList(nameFilters, QDir::Files, QDir::Name);
+  m_items.reserve(fileList.size());
+  for (const QFileInfo& fileInfo : fileList) {
+    Item item;
+    item.filePath     = fileInfo.absoluteFilePath();
+    item.fileName     = fileInfo.fileName();
+    item.lastModified = fileInfo.lastModified();
+    item.fileSize     = fileInfo.size();
+    m_items.append(item);
+  }
+
+  endResetModel();
+
+  // Las miniaturas de esta carpeta que ya no corresponden a ningún fichero actual sobran
+  const QString cacheDir = cacheDirectory(directoryPath);
+  QDir().mkpath(cacheDir);
+  QFile source(QDir(cacheDir).filePath(SOURCE_FILE_NAME));
+  if (source.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    source.write(QDir(directoryPath).absolutePath().toUtf8());
+
+  QSet<QString> keep;
+  for (const Item& item : m_items)
+    keep.insert(QFileInfo(cacheFilePath(item)).fileName());
+  m_pool.start([cacheDir, keep]() { pruneDirectory(cacheDir, keep); });
+}
+
+/**
+ * @brief Añade (o refresca) un único fichero sin reconstruir el resto de la lista.
+ */
+void CalibrationThumbnailModel::addFile(const QString& filePath)
+{
+  QFileInfo fileInfo(filePath);
+  if (!fileInfo.exists())
+    return;
+
+  Item item;
+  item.filePath     = fileInfo.absoluteFilePath();
+  item.fileName     = fileInfo.fileName();
+  item.lastModified = fileInfo.lastModified();
+  item.fileSize     = fileInfo.size();
+
+  int existingRow = rowForPath(item.filePath);
+  if (existingRow >= 0) {
+    // Una miniatura de la versión anterior aún en el pool se ignorará al llegar: su clave no coincide
+    m_pending.remove(cacheFilePath(m_items[existingRow]));
+    m_items[existingRow] = item;
+    QModelIndex idx      = index(existingRow);
+    emit dataChanged(idx, idx);
+    return;
+  }
+
+  auto it  = std::lower_bound(m_items.begin(), m_items.end(), item, [](const Item& a, const Item& b) { return a.fileName < b.fileName; });
+  int  row = static_cast<int>(std::distance(m_items.begin(), it));
+
+  beginInsertRows(QModelIndex(), row, row);
+  m_items.insert(row, item);
+  endInsertRows();
+}
+
+void CalibrationThumbnailModel::setViewError(const QString& fileName, double error, bool rejected)
+{
+  int row = rowForName(fileName);
+  if (row < 0)
+    return;
+
+  m_items[row].viewError = error;
+  m_items[row].rejected  = rejected;
+  QModelIndex idx        = index(row);
+  emit dataChanged(idx, idx, {Qt::DisplayRole, Qt::ForegroundRole});
+}
+
+void CalibrationThumbnailModel::clearViewErrors()
+{
+  for (Item& item : m_items) {
+    item.viewError = -1.0;
+    item.rejected  = false;
+  }
+  if (!m_items.isEmpty())
+    emit dataChanged(index(0), index(m_items.size() - 1), {Qt::DisplayRole, Qt::ForegroundRole});
+}
+
+int CalibrationThumbnailModel::rowCount(const QModelIndex& parent) const
+{
+  return parent.isValid() ? 0 : m_items.size();
+}
+
+QVariant CalibrationThumbnailModel::data(const QModelIndex& index, int role) const
+{
+  if (!index.isValid() || index.row() >= m_items.size())
+    return QVariant();
+
+  const Item& item = m_items.at(index.row());
+  switch (role) {
+    case Qt::DisplayRole:
+      if (item.viewError < 0.0)
+        return item.fileName;
+      return QString("%1\n%2 px").arg(item.fileName).arg(item.viewError, 0, 'f', 2);
+    case Qt::ForegroundRole:
+      if (item.rejected)
+        return QBrush(Qt::red);
+      return QVariant();
+    case Qt::DecorationRole:
+      // La vista solo pide las filas visibles: ahí es donde se lanza la carga
+      if (!item.thumbnail.isNull())
+        return item.thumbnail;
+      requestThumbnail(item);
+      return m_placeholder;
+    case Qt::ToolTipRole:
+      return item.filePath;
+    case Qt::SizeHintRole:
+      return QSize(THUMBNAIL_SIZE + 10, THUMBNAIL_SIZE + 40);
+    default:
+      return QVariant();
+  }
+}
+
+void CalibrationThumbnailModel::requestThumbnail(const Item& item) const
+{
+  const QString cachePath = cacheFilePath(item);
+  if (m_pending.contains(cachePath))
+    return;
+  m_pending.insert(cachePath);
+
+  CalibrationThumbnailModel* self       = const_cast<CalibrationThumbnailModel*>(this);
+  const int                  generation = m_generation;
+  const QString              filePath   = item.filePath;
+
+  m_pool.start([self, generation, filePath, cachePath]() {
+    QImage image = loadThumbnail(filePath, cachePath);
+    QMetaObject::invokeMethod(
+      self, [self, generation, filePath, cachePath, image]() { self->onThumbnailReady(generation, filePath, cachePath, image); },
+      Qt::QueuedConnection);
+  });
+}
+
+void CalibrationThumbnailModel::onThumbnailReady(int generation, const QString& filePath, const QString& cachePath, const QImage& image)
+{
+  if (generation != m_generation)
+    return;
+  m_pending.remove(cachePath);
+
+  // Miniatura de una versión anterior del fichero (se volvió a guardar mientras se generaba)
+  int row = rowForPath(filePath);
+  if (row < 0 || cacheFilePath(m_items.at(row)) != cachePath)
+    return;
+
+  // Si la imagen no se puede leer se deja el marcador para no reintentarlo en cada repintado
+  m_items[row].thumbnail = image.isNull() ? m_placeholder : QPixmap::fromImage(image);
+  QModelIndex idx        = index(row);
+  emit dataChanged(idx, idx, {Qt::DecorationRole});
+}
+
+int CalibrationThumbnailModel::rowForPath(const QString& filePath) const
+{
+  for (int i = 0; i < m_items.size(); ++i) {
+    if (m_items.at(i).filePath == filePath)
+      return i;
+  }
+  return -1;
+}
+
+int CalibrationThumbnailModel::rowForName(const QString& fileName) const
+{
+  for (int i = 0; i < m_items.size(); ++i) {
+    if (m_items.at(i).fileName == fileName)
+      return i;
+  }
+  return -1;
+}
+
+QString CalibrationThumbnailModel::cacheFilePath(const Item& item) const
+{
+  const QString key = QString("%1|%2|%3").arg(item.fileName).arg(item.lastModified.toMSecsSinceEpoch()).arg(item.fileSize);
+  return QDir(cacheDirectory(QFileInfo(item.filePath).absolutePath())).filePath(sha1Hex(key) + ".png");
+}
+
+QString CalibrationThumbnailModel::cacheDirectory(const QString& directoryPath) const
+{
+  return QDir(m_cacheDir).filePath(sha1Hex(QDir(directoryPath).absolutePath()));
+}
+
+/**
+ * @brief Se ejecuta en el pool: borra las miniaturas de una carpeta que no están en keep.
+ */
+void CalibrationThumbnailModel::pruneDirectory(const QString& cacheDirectory, const QSet<QString>& keep)
+{
+  const QStringList names = QDir(cacheDirectory).entryList({"*.png"}, QDir::Files);
+  for (const QString& name : names) {
+    if (!keep.contains(name))
+      QFile::remove(QDir(cacheDirectory).filePath(name));
+  }
+}
+
+/**
+ * @brief Se ejecuta en el pool: borra las subcarpetas de carpetas de imágenes que ya no existen
+ * y las miniaturas sueltas del formato anterior, sin subcarpetas.
+ */
+void CalibrationThumbnailModel::pruneCache(const QString& cacheRoot)
+{
+  QDir root(cacheRoot);
+  for (const QString& name : root.entryList({"*.png"}, QDir::Files))
+    QFile::remove(root.filePath(name));
+
+  // Sin fichero source no se sabe de qué carpeta es (o setDirectory la está creando): se deja
+  for (const QString& name : root.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+    QFile source(QDir(root.filePath(name)).filePath(SOURCE_FILE_NAME));
+    if (!source.open(QIODevice::ReadOnly))
+      continue;
+    const QString directoryPath = QString::fromUtf8(source.readAll());
+    source.close();
+    if (!directoryPath.isEmpty() && !QDir(directoryPath).exists())
+      QDir(root.filePath(name)).removeRecursively();
+  }
+}
+
+/**
+ * @brief Se ejecuta en el pool: lee la miniatura de disco o la genera y la guarda.
+ */
+QImage CalibrationThumbnailModel::loadThumbnail(const QString& filePath, const QString& cachePath)
+{
+  QImage cached(cachePath);
+  if (!cached.isNull())
+    return cached;
+
+  QImageReader reader(filePath);
+  reader.setAutoTransform(true);
+  QSize fullSize = reader.size();
+  if (fullSize.isValid())
+    reader.setScaledSize(fullSize.scaled(THUMBNAIL_SIZE, THUMBNAIL_SIZE, Qt::KeepAspectRatio));
+
+  QImage thumbnail = reader.read();
+  if (thumbnail.isNull())
+    return QImage();
+  if (thumbnail.width() > THUMBNAIL_SIZE || thumbnail.height() > THUMBNAIL_SIZE)
+    thumbnail = thumbnail.scaled(THUMBNAIL_SIZE, THUMBNAIL_SIZE, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+  QDir().mkpath(QFileInfo(cachePath).absolutePath());
+  QSaveFile file(cachePath);
+  if (file.open(QIODevice::WriteOnly) && thumbnail.save(&file, "PNG"))
+    file.commit();
+
+  return thumbnail;
+}
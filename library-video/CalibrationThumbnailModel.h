@@ -0,0 +1,75 @@
+#ifndef CALIBRATIONTHUMBNAILMODEL_H
+#define CALIBRATIONTHUMBNAILMODEL_H
+
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <QImage>
+#include <QPixmap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+
+/**
+ * @brief Modelo de la lista de imágenes de calibración con miniaturas asíncronas.
+ * @details Solo lista los ficheros al cambiar de carpeta; las miniaturas se generan bajo
+ * demanda (cuando la vista pide una fila visible) en un pool de hilos propio y se guardan en
+ * disco indexadas por ruta, fecha de modificación y tamaño, de forma que reabrir una carpeta
+ * no vuelve a decodificar ninguna imagen completa.
+ *
+ * La caché de disco tiene una subcarpeta por carpeta de imágenes, con un fichero "source" que
+ * guarda su ruta. Al abrir una carpeta se borran las miniaturas de ficheros que ya no están o
+ * han cambiado, y al crear el modelo las subcarpetas de carpetas que ya no existen.
+ */
+class CalibrationThumbnailModel : public QAbstractListModel
+{
+  Q_OBJECT
+public:
+  explicit CalibrationThumbnailModel(QObject* parent = nullptr);
+  ~CalibrationThumbnailModel();
+
+  void setDirectory(const QString& directoryPath, const QStringList& nameFilters);
+  void addFile(const QString& filePath);
+
+  // Resultado de la última calibración, mostrado bajo cada miniatura
+  void setViewError(const QString& fileName, double error, bool rejected);
+  void clearViewErrors();
+
+  int      rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+  static const int THUMBNAIL_SIZE = 120;
+
+private:
+  struct Item
+  {
+    QString   filePath;
+    QString   fileName;
+    QDateTime lastModified;
+    qint64    fileSize = 0;
+    QPixmap   thumbnail;
+    double    viewError = -1.0; // < 0: sin resultado de calibración
+    bool      rejected  = false;
+  };
+
+  QVector<Item>         m_items;
+  mutable QSet<QString> m_pending; // Claves (cacheFilePath) solicitadas al pool y aún no recibidas
+  mutable QThreadPool   m_pool;
+  QPixmap               m_placeholder;
+  QString               m_cacheDir;
+  int                   m_generation = 0; // Invalida las respuestas de una carpeta anterior
+
+  void    requestThumbnail(const Item& item) const;
+  void    onThumbnailReady(int generation, const QString& filePath, const QString& cachePath, const QImage& image);
+  int     rowForPath(const QString& filePath) const;
+  int     rowForName(const QString& fileName) const;
+  QString cacheFilePath(const Item& item) const;
+  QString cacheDirectory(const QString& directoryPath) const;
+
+  static QImage loadThumbnail(const QString& filePath, const QString& cachePath);
+  static void   pruneDirectory(const QString& cacheDirectory, const QSet<QString>& keep);
+  static void   pruneCache(const QString& cacheRoot);
+};
+
+#endif // CALIBRATIONTHUMBNAILMODEL_H
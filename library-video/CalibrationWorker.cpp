@@ -0,0 +1,284 @@
+#include "CalibrationWorker.h"
+#include "CalibrationCornerCache.h"
+#include "CalibrationProfile.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+#include <opencv2/calib3d.hpp>          // cv::calibrateCamera, cv::getOptimalNewCameraMatrix
+#include <opencv2/imgcodecs.hpp>        // cv::imread
+#include <opencv2/imgproc.hpp>          // cv::cvtColor, cv::cornerSubPix
+
+const QString DEFAULT_CALIB_DIR = "calibration"; // Mantenemos el nombre de carpeta que usa la lógica de
+                                                 // guardado
+
+bool CalibrationWorker::processImageForCorners(const cv::Mat& image, const CalibrationTargetDetector& detector, std::vector<cv::Point2f>& corners,
+                                               std::vector<int>& ids) const
+{
+  cv::Mat gray;
+  if (image.channels() == 1)
+    gray = image;
+  else
+    cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+
+  return detector.detect(gray, corners, ids);
+}
+
+/**
+ * @brief Error RMS de reproyección de cada vista, calculado en paralelo.
+ */
+std::vector<double> CalibrationWorker::computeReprojectionErrors(const std::vector<std::vector<cv::Point3f>>& objectPoints,
+                                                                 const std::vector<std::vector<cv::Point2f>>& imagePoints,
+                                                                 const std::vector<cv::Mat>& rvecs, const std::vector<cv::Mat>& tvecs,
+                                                                 const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs) const
+{
+  std::vector<double> errors(objectPoints.size(), 0.0);
+
+  cv::parallel_for_(cv::Range(0, static_cast<int>(objectPoints.size())), [&](const cv::Range& range) {
+    std::vector<cv::Point2f> projected;
+    for (int i = range.start; i < range.end; ++i) {
+      cv::projectPoints(objectPoints[i], rvecs[i], tvecs[i], cameraMatrix, distCoeffs, projected);
+      double err = cv::norm(imagePoints[i], projected, cv::NORM_L2);
+      errors[i]  = std::sqrt(err * err / projected.size());
+    }
+  });
+
+  return errors;
+}
+
+/**
+ * @brief Calibra y descarta iterativamente las vistas con un error de reproyección anómalo.
+ * @details En cada ronda se eliminan las vistas cuyo error supera tanto un umbral absoluto como
+ * un múltiplo de la mediana, y se vuelve a resolver partiendo de los intrínsecos anteriores
+ * (CALIB_USE_INTRINSIC_GUESS), lo que converge en pocas iteraciones.
+ */
+bool CalibrationWorker::runCalibration(cv::Size imageSize, std::vector<std::vector<cv::Point2f>>& imagePoints,
+                                       std::vector<std::vector<cv::Point3f>>& objectPoints, const QStringList& viewNames, CalibrationResult& result)
+{
+  const int    MIN_VIEWS            = 5;
+  const int    MAX_REJECTION_ROUNDS = 3;
+  const double OUTLIER_MIN_ERROR    = 1.0; // px: por debajo nunca se descarta una vista
+  const double OUTLIER_MEDIAN_RATIO = 3.0; // Múltiplo de la mediana a partir del cual es atípica
+
+  if (static_cast<int>(imagePoints.size()) < MIN_VIEWS) {
+    return false;
+  }
+
+  std::vector<cv::Mat> rvecs, tvecs;
+
+  // 1. Definir Criterios de Terminación más estrictos
+  cv::TermCriteria criteria(cv::TermCriteria::EPS + cv::TermCriteria::MAX_ITER, 100, 1e-6);
+
+  // 2. Definir Banderas (Flags) de Calibración
+  // int flags = cv::CALIB_FIX_ASPECT_RATIO | cv::CALIB_RATIONAL_MODEL | cv::CALIB_ZERO_TANGENT_DIST | cv::CALIB_USE_LU;
+  int flags = cv::CALIB_USE_LU;
+
+  // Índices (sobre imagePoints) de las vistas que siguen participando en la calibración
+  std::vector<int> active(imagePoints.size());
+  for (size_t i = 0; i < active.size(); ++i)
+    active[i] = static_cast<int>(i);
+
+  result.viewErrors.clear();
+  result.viewErrors.resize(static_cast<int>(imagePoints.size()));
+  for (int i = 0; i < result.viewErrors.size(); ++i)
+    result.viewErrors[i].fileName = i < viewNames.size() ? viewNames[i] : QString::number(i);
+
+  std::vector<double> errors;
+  for (int round = 0;; ++round) {
+    std::vector<std::vector<cv::Point2f>> activeImagePoints;
+    std::vector<std::vector<cv::Point3f>> activeObjectPoints;
+    for (int idx : active) {
+      activeImagePoints.push_back(imagePoints[idx]);
+      activeObjectPoints.push_back(objectPoints[idx]);
+    }
+
+    // 3. Llamada a la función de calibración principal con Criterios y Banderas
+    result.rms = cv::calibrateCamera(activeObjectPoints, activeImagePoints, imageSize, result.cameraMatrix, result.distCoeffs, rvecs, tvecs, flags,
+                                     criteria);
+
+    errors = computeReprojectionErrors(activeObjectPoints, activeImagePoints, rvecs, tvecs, result.cameraMatrix, result.distCoeffs);
+    for (size_t k = 0; k < active.size(); ++k)
+      result.viewErrors[active[k]].error = errors[k];
+
+    if (round >= MAX_REJECTION_ROUNDS)
+      break;
+
+    std::vector<double> sorted = errors;
+    std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+    double threshold = std::max(OUTLIER_MIN_ERROR, OUTLIER_MEDIAN_RATIO * sorted[sorted.size() / 2]);
+
+    std::vector<int> kept;
+    for (size_t k = 0; k < active.size(); ++k) {
+      if (errors[k] > threshold)
+        result.viewErrors[active[k]].rejected = true;
+      else
+        kept.push_back(active[k]);
+    }
+
+    if (kept.size() == active.size())
+      break;
+    if (static_cast<int>(kept.size()) < MIN_VIEWS) {
+      // No quedarían vistas suficientes: se conserva la solución actual
+      for (int idx : active)
+        result.viewErrors[idx].rejected = false;
+      break;
+    }
+
+    active = kept;
+    flags |= cv::CALIB_USE_INTRINSIC_GUESS; // Re-solución arrancando de los intrínsecos actuales
+  }
+
+  result.rejectedCount = static_cast<int>(imagePoints.size() - active.size());
+
+  // 4. Calcular la Matriz de Cámara Óptima
+  result.newCameraMatrix = cv::getOptimalNewCameraMatrix(result.cameraMatrix, result.distCoeffs, imageSize, 1, imageSize, &result.roi);
+
+  return true;
+}
+
+void CalibrationWorker::storeCorners(const QString& filePath, const CalibrationTarget& target, const CornerCacheEntry& entry)
+{
+  const QString          directoryPath = QFileInfo(filePath).absolutePath();
+  CalibrationCornerCache cache(directoryPath);
+  cache.load();
+  cache.insert(CalibrationCornerCache::hashFile(filePath), target, entry);
+  if (!cache.save())
+    qWarning() << "No se pudo actualizar la caché de esquinas en" << directoryPath;
+}
+
+/**
+ * @brief Slot principal del worker: realiza la calibración.
+ */
+void CalibrationWorker::doCalibration(const QString& directoryPath, const CalibrationTarget& target, const QString& cameraName)
+{
+  QDir        directory(directoryPath);
+  QStringList nameFilters;
+  nameFilters << "*.tiff";
+  QFileInfoList fileList = directory.entryInfoList(nameFilters, QDir::Files, QDir::Name);
+
+  if (fileList.size() < 5) {
+    emit calibrationError(tr("Se necesitan al menos 5 imágenes válidas. Solo se encontraron %1.").arg(fileList.size()));
+    return;
+  }
+  emit progressUpdate(tr("Iniciando calibración con %1 imágenes (%2)...").arg(fileList.size()).arg(target.name()));
+
+  if (!CalibrationTargetDetector::isPatternAvailable(target.pattern)) {
+    emit calibrationError(tr("El patrón %1 no está disponible en esta versión de OpenCV.").arg(target.name()));
+    return;
+  }
+  CalibrationTargetDetector detector(target);
+
+  std::vector<std::vector<cv::Point2f>> imagePoints;
+  std::vector<std::vector<cv::Point3f>> objectPoints;
+  QStringList                           viewNames;
+  std::vector<cv::Size>                 viewSizes;
+  CalibrationResult                     result;
+
+  // Las esquinas ya detectadas en ejecuciones anteriores se reutilizan desde la caché
+  CalibrationCornerCache cache(directoryPath);
+  cache.load();
+  QList<QByteArray> liveHashes;
+
+  int cachedCount = 0;
+  for (const QFileInfo& fileInfo : fileList) {
+    // Comprobar si el hilo debe detenerse
+    if (QThread::currentThread()->isInterruptionRequested())
+      return;
+
+    QByteArray       contentHash = CalibrationCornerCache::hashFile(fileInfo.absoluteFilePath());
+    CornerCacheEntry entry;
+
+    if (cache.lookup(contentHash, target, entry)) {
+      cachedCount++;
+    }
+    else {
+      cv::Mat image = cv::imread(fileInfo.absoluteFilePath().toStdString());
+      if (image.empty()) {
+        emit progressUpdate(tr("Error al cargar imagen: %1").arg(fileInfo.fileName()));
+        continue;
+      }
+      entry.imageSize = image.size();
+      entry.found     = processImageForCorners(image, detector, entry.corners, entry.ids);
+      cache.insert(contentHash, target, entry);
+    }
+    liveHashes.append(contentHash);
+
+    if (entry.found) {
+      imagePoints.push_back(entry.corners);
+      objectPoints.push_back(target.objectPoints(entry.ids));
+      viewNames.append(fileInfo.fileName());
+      viewSizes.push_back(entry.imageSize);
+      emit progressUpdate(tr("Procesando imagen: %1").arg(fileInfo.fileName()));
+    }
+  }
+
+  cache.retainOnly(liveHashes);
+  if (!cache.save())
+    qWarning() << "No se pudo guardar la caché de esquinas en" << directoryPath;
+
+  if (cachedCount > 0)
+    emit progressUpdate(tr("%1 imágenes recuperadas de la caché, %2 procesadas de nuevo.").arg(cachedCount).arg(liveHashes.size() - cachedCount));
+
+  // calibrateCamera supone que todas las vistas tienen el tamaño que se le pasa: se calibra con la
+  // resolución más repetida y se descartan las demás
+  cv::Size imageSize;
+  int      imageSizeCount = 0;
+  for (const cv::Size& size : viewSizes) {
+    const int count = int(std::count(viewSizes.begin(), viewSizes.end(), size));
+    if (count > imageSizeCount) {
+      imageSize      = size;
+      imageSizeCount = count;
+    }
+  }
+  int processedCount = 0;
+  for (size_t i = 0; i < viewSizes.size(); ++i) {
+    if (viewSizes[i] != imageSize)
+      continue;
+    imagePoints[processedCount]  = std::move(imagePoints[i]);
+    objectPoints[processedCount] = std::move(objectPoints[i]);
+    viewNames[processedCount]    = viewNames[int(i)];
+    ++processedCount;
+  }
+  if (processedCount < int(viewSizes.size())) {
+    emit progressUpdate(tr("Se descartaron %1 imágenes con resolución distinta de %2x%3.")
+                          .arg(int(viewSizes.size()) - processedCount)
+                          .arg(imageSize.width)
+                          .arg(imageSize.height));
+    imagePoints.resize(processedCount);
+    objectPoints.resize(processedCount);
+    viewNames.erase(viewNames.begin() + processedCount, viewNames.end());
+  }
+  qDebug() << "Tamaño de imagen detectado para calibración:" << imageSize.width << "x" << imageSize.height;
+
+  result.processedCount = processedCount;
+
+  if (processedCount < 5) {
+    emit calibrationError(tr("Solo se pudieron encontrar esquinas en %1 imágenes. La calibración no se realizará.").arg(processedCount));
+    return;
+  }
+
+  emit progressUpdate(tr("Esquinas detectadas correctamente en %1 imágenes.\nEjecutando calibración...").arg(processedCount));
+
+  // Pasamos el imageSize a runCalibration 
+  if (runCalibration(imageSize, imagePoints, objectPoints, viewNames, result)) {
+    if (result.rejectedCount > 0)
+      emit progressUpdate(tr("Se descartaron %1 imágenes con error de reproyección anómalo.").arg(result.rejectedCount));
+    // Perfil de esta cámara y resolución
+    CalibrationProfile profile;
+    profile.cameraName      = cameraName.toStdString();
+    profile.imageSize       = imageSize;
+    profile.cameraMatrix    = result.cameraMatrix;
+    profile.distCoeffs      = result.distCoeffs;
+    profile.newCameraMatrix = result.newCameraMatrix;
+    profile.roi             = result.roi;
+    if (profile.save(DEFAULT_CALIB_DIR))
+      emit progressUpdate(tr("Perfil guardado: %1").arg(CalibrationProfile::fileName(profile.cameraName, imageSize)));
+    else
+      emit progressUpdate(tr("No se pudo guardar el perfil de calibración en la carpeta '%1'.").arg(DEFAULT_CALIB_DIR));
+    emit calibrationFinished(result);
+  }
+  else
+    emit calibrationError(tr("Falló la calibración. Se necesitan al menos 5 conjuntos de puntos válidos."));
+}
@@ -0,0 +1,76 @@
+#ifndef CALIBRATIONWORKER_H
+#define CALIBRATIONWORKER_H
+
+#include "CalibrationCornerCache.h"
+#include "CalibrationTarget.h"
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+
+extern const QString DEFAULT_CALIB_DIR; // Carpeta de perfiles y capturas de calibración
+
+// Error de reproyección de una imagen tras la calibración
+struct CalibrationViewError
+{
+  QString fileName;
+  double  error    = 0.0;   // RMS en píxeles
+  bool    rejected = false; // Descartada como atípica
+};
+
+struct CalibrationResult
+{
+  double                        rms = -1.0;
+  cv::Mat                       cameraMatrix;
+  cv::Mat                       distCoeffs;
+  cv::Mat                       newCameraMatrix; // Matriz óptima
+  cv::Rect                      roi;             // Región de interés
+  int                           processedCount = 0;
+  int                           rejectedCount  = 0;
+  QVector<CalibrationViewError> viewErrors;
+};
+Q_DECLARE_METATYPE(CalibrationResult)
+
+// Esta clase contiene la lógica de calibración que se ejecutará en segundo plano
+class CalibrationWorker : public QObject
+{
+  Q_OBJECT
+public:
+  CalibrationWorker(QObject* parent = nullptr) : QObject(parent)
+  {
+    qRegisterMetaType<CalibrationResult>();
+    qRegisterMetaType<CalibrationTarget>();
+    qRegisterMetaType<CornerCacheEntry>();
+  }
+
+  // Pasos de la calibración, públicos para poder medirlos por separado (benchmarks/CalibrationBenchmark.cpp)
+  bool processImageForCorners(const cv::Mat& image, const CalibrationTargetDetector& detector, std::vector<cv::Point2f>& corners,
+                              std::vector<int>& ids) const;
+  bool runCalibration(cv::Size imageSize, std::vector<std::vector<cv::Point2f>>& imagePoints, std::vector<std::vector<cv::Point3f>>& objectPoints,
+                      const QStringList& viewNames, CalibrationResult& result);
+
+public slots:
+  // Slot que será llamado por el hilo principal para iniciar la tarea
+  void doCalibration(const QString& directoryPath, const CalibrationTarget& target, const QString& cameraName);
+  // Esquinas de una captura automática: las añade a la caché de su carpeta. Único escritor de la
+  // caché, así no se pisa con doCalibration, que se ejecuta en este mismo hilo
+  void storeCorners(const QString& filePath, const CalibrationTarget& target, const CornerCacheEntry& entry);
+
+signals:
+  // Señales para enviar resultados al hilo principal (VideoCalibrationDialog)
+  void calibrationFinished(const CalibrationResult& result);
+  void calibrationError(const QString& message);
+  void progressUpdate(const QString& message); // Para mostrar el progreso
+
+private:
+  // Métodos de calibración movidos del VideoCalibrationDialog
+  std::vector<double> computeReprojectionErrors(const std::vector<std::vector<cv::Point3f>>& objectPoints,
+                                                const std::vector<std::vector<cv::Point2f>>& imagePoints, const std::vector<cv::Mat>& rvecs,
+                                                const std::vector<cv::Mat>& tvecs, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs) const;
+};
+
+#endif // CALIBRATIONWORKER_H
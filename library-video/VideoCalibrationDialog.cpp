@@ -7,11 +7,13 @@
 #include <QFile>
 #include <QFileDialog>
 #include <QFileInfo>
-#include <QLabel>
 #include <QMessageBox>
-#include <QVBoxLayout>
+#include <QSignalBlocker>
+#include <QStandardItemModel>
 
 // Headers de OpenCV y Standard
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
 #include <iostream>
 #include <opencv2/calib3d.hpp>          // cv::findChessboardCorners, cv::calibrateCamera
@@ -23,163 +25,6 @@
 
 namespace fs = std::filesystem;
 
-const QString DEFAULT_CALIB_DIR = "calibration"; // Mantenemos el nombre de carpeta que usa la lógica de
-                                                 // guardado
-
-std::vector<cv::Point3f> CalibrationWorker::createObjectPoints(cv::Size boardSize, float squareSize) const
-{
-  std::vector<cv::Point3f> obj;
-  for (int i = 0; i < boardSize.height; ++i) {
-    for (int j = 0; j < boardSize.width; ++j) {
-      obj.emplace_back(j * squareSize, i * squareSize, 0);
-    }
-  }
-  return obj;
-}
-
-bool CalibrationWorker::processImageForCorners(const cv::Mat& image, cv::Size boardSize, float squareSize,
-                                               std::vector<std::vector<cv::Point2f>>& imagePoints,
-                                               std::vector<std::vector<cv::Point3f>>& objectPoints)
-{
-  std::vector<cv::Point2f> corners;
-  bool                     found = cv::findChessboardCorners(image, boardSize, corners, cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_NORMALIZE_IMAGE);
-
-  if (found) {
-    cv::Mat gray;
-    cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
-    cv::cornerSubPix(gray, corners, cv::Size(11, 11), cv::Size(-1, -1),
-                     cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::MAX_ITER, 30, 0.001));
-
-    imagePoints.push_back(corners);
-    objectPoints.push_back(createObjectPoints(boardSize, squareSize));
-
-    return true;
-  }
-  return false;
-}
-
-bool CalibrationWorker::runCalibration(cv::Size boardSize, std::vector<std::vector<cv::Point2f>>& imagePoints,
-                                       std::vector<std::vector<cv::Point3f>>& objectPoints, CalibrationResult& result)
-{
-  if (imagePoints.size() < 5) {
-    return false;
-  }
-
-  std::vector<cv::Mat> rvecs, tvecs;
-
-  // 1. Definir Criterios de Terminación más estrictos
-  cv::TermCriteria criteria(cv::TermCriteria::EPS + cv::TermCriteria::MAX_ITER, 100, 1e-6);
-
-  // 2. Definir Banderas (Flags) de Calibración
-  // int flags = cv::CALIB_FIX_ASPECT_RATIO | cv::CALIB_RATIONAL_MODEL | cv::CALIB_ZERO_TANGENT_DIST | cv::CALIB_USE_LU;
-  int flags = cv::CALIB_USE_LU;
-
-  // 3. Llamada a la función de calibración principal con Criterios y Banderas
-  result.rms = cv::calibrateCamera(objectPoints, imagePoints, boardSize, result.cameraMatrix, result.distCoeffs, rvecs, tvecs, flags, criteria);
-
-  // 4. Calcular la Matriz de Cámara Óptima
-  result.newCameraMatrix = cv::getOptimalNewCameraMatrix(result.cameraMatrix, result.distCoeffs, boardSize, 1, boardSize, &result.roi);
-
-  return true;
-}
-
-/**
- * @brief Guarda la matriz de cámara y los coeficientes de distorsión.
- */
-void CalibrationWorker::saveCalibration(const std::string& cameraMatrixFile, const std::string& distCoeffsFile, const cv::Mat& cameraMatrix,
-                                        const cv::Mat& distCoeffs, const cv::Mat& newCameraMatrix) const
-{
-  QDir().mkpath(DEFAULT_CALIB_DIR);
-
-  std::string cameraMatrixPath = QDir(DEFAULT_CALIB_DIR).filePath(cameraMatrixFile.c_str()).toStdString();
-  std::string distCoeffsPath   = QDir(DEFAULT_CALIB_DIR).filePath(distCoeffsFile.c_str()).toStdString();
-
-  // Guardar matriz de cámara
-  cv::FileStorage fsCam(cameraMatrixPath, cv::FileStorage::WRITE);
-  if (!fsCam.isOpened()) {
-    qWarning() << "Error al abrir archivo para m_cameraMatrix:" << cameraMatrixPath.c_str();
-    return;
-  }
-  fsCam << "m_cameraMatrix" << cameraMatrix;
-  fsCam << "m_newCameraMatrix" << newCameraMatrix; // <-- AÑADIDO
-  fsCam.release();
-
-  // Guardar coeficientes de distorsión
-  cv::FileStorage fsDist(distCoeffsPath, cv::FileStorage::WRITE);
-  if (!fsDist.isOpened()) {
-    qWarning() << "Error al abrir archivo para m_distCoeffs:" << distCoeffsPath.c_str();
-    return;
-  }
-  fsDist << "m_distCoeffs" << distCoeffs;
-  fsDist.release();
-}
-
-/**
- * @brief Slot principal del worker: realiza la calibración.
- */
-void CalibrationWorker::doCalibration(const QString& directoryPath, cv::Size boardSize, float squareSize)
-{
-  QDir        directory(directoryPath);
-  QStringList nameFilters;
-  nameFilters << "*.tiff";
-  QFileInfoList fileList = directory.entryInfoList(nameFilters, QDir::Files, QDir::Name);
-
-  if (fileList.size() < 5) {
-    emit calibrationError(tr("Se necesitan al menos 5 imágenes válidas. Solo se encontraron %1.").arg(fileList.size()));
-    return;
-  }
-  emit progressUpdate(tr("Iniciando calibración con %1 imágenes...").arg(fileList.size()));
-
-  std::vector<std::vector<cv::Point2f>> imagePoints;
-  std::vector<std::vector<cv::Point3f>> objectPoints;
-  CalibrationResult                     result;
-
-  // Necesitamos el tamaño de la imagen para getOptimalNewCameraMatrix ---
-  cv::Size imageSize;
-
-  int processedCount = 0;
-  for (const QFileInfo& fileInfo : fileList) {
-    // Comprobar si el hilo debe detenerse
-    if (QThread::currentThread()->isInterruptionRequested())
-      return;
-
-    cv::Mat image = cv::imread(fileInfo.absoluteFilePath().toStdString());
-    if (image.empty()) {
-      emit progressUpdate(tr("Error al cargar imagen: %1").arg(fileInfo.fileName()));
-      continue;
-    }
-
-    // Guardar el tamaño de la primera imagen
-    if (processedCount == 0) {
-      imageSize = image.size();
-      qDebug() << "Tamaño de imagen detectado para calibración:" << imageSize.width << "x" << imageSize.height;
-    }
-    if (processImageForCorners(image, boardSize, squareSize, imagePoints, objectPoints)) {
-      processedCount++;
-      emit progressUpdate(tr("Procesando imagen: %1").arg(fileInfo.fileName()));
-    }
-  }
-
-  result.processedCount = processedCount;
-
-  if (processedCount < 5) {
-    emit calibrationError(tr("Solo se pudieron encontrar esquinas en %1 imágenes. La calibración no se realizará.").arg(processedCount));
-    return;
-  }
-
-  emit progressUpdate(tr("Esquinas detectadas correctamente en %1 imágenes.\nEjecutando calibración...").arg(processedCount));
-
-  // Pasamos el imageSize a runCalibration 
-  if (runCalibration(imageSize, imagePoints, objectPoints, result)) {
-    // Pasamos la newCameraMatrix a saveCalibration
-    saveCalibration("camera_matrix.yml", "dist_coeffs.yml", result.cameraMatrix, result.distCoeffs, result.newCameraMatrix);
-    emit progressUpdate(tr("Archivos de calibración guardados en la carpeta '%1'.").arg(DEFAULT_CALIB_DIR));
-    emit calibrationFinished(result);
-  }
-  else
-    emit calibrationError(tr("Falló la calibración. Se necesitan al menos 5 conjuntos de puntos válidos."));
-}
-
 VideoCalibrationDialog::VideoCalibrationDialog(QWidget* parent) : QDialog(parent), ui(new Ui::VideoCalibrationDialog)
 {
   ui->setupUi(this);
@@ -200,21 +45,39 @@ VideoCalibrationDialog::VideoCalibrationDialog(QWidget* parent) : QDialog(parent
 
   m_workerThread->start(); // Iniciar el hilo
 
+  // Hilo propio para la detección en directo, así no compite con la calibración
+  m_liveThread    = new QThread(this);
+  m_liveCollector = new CalibrationLiveCollector();
+  m_liveCollector->moveToThread(m_liveThread);
+
+  connect(m_liveThread, &QThread::finished, m_liveCollector, &QObject::deleteLater);
+  connect(m_liveCollector, &CalibrationLiveCollector::frameAccepted, this, &VideoCalibrationDialog::on_liveFrameAccepted);
+  connect(m_liveCollector, &CalibrationLiveCollector::frameRejected, this, &VideoCalibrationDialog::on_liveFrameRejected);
+  connect(m_liveCollector, &CalibrationLiveCollector::collectionFinished, this, &VideoCalibrationDialog::on_liveCollectionFinished);
+  // La caché de esquinas tiene un solo escritor: el worker, en su hilo
+  connect(m_liveCollector, &CalibrationLiveCollector::cornersDetected, m_worker, &CalibrationWorker::storeCorners);
+
+  m_liveThread->start(QThread::LowPriority);
+
   // Conexión para recibir nuevos pixmaps capturados (Temporal mientras el
   // diálogo está abierto)
   connect(&handler, &VideoCaptureHandler::newPixmapCaptured, this, [=](const QPixmap& pixmap) {
     m_currentPixmap = pixmap;
     updateVideoLabel();
   });
+  // Las capturas, manuales o automáticas, usan el fotograma sin corregir
+  connect(&handler, &VideoCaptureHandler::rawFrameCaptured, this, [=](const QImage& frame) {
+    m_rawFrame = frame;
+    submitLiveFrame();
+  });
 
-  // Configurar el layout para la lista de archivos.
-  QWidget* contentWidget = ui->scrollAreaWidgetContents;
-  if (!contentWidget->layout()) {
-    QVBoxLayout* layout = new QVBoxLayout(contentWidget);
-    layout->setAlignment(Qt::AlignTop);
-    layout->setContentsMargins(5, 5, 5, 5);
-    layout->setSpacing(2);
-  }
+  // Lista de archivos: vista virtualizada con miniaturas cargadas en segundo plano
+  m_thumbnailModel = new CalibrationThumbnailModel(this);
+  ui->listViewFiles->setModel(m_thumbnailModel);
+  ui->listViewFiles->setIconSize(QSize(CalibrationThumbnailModel::THUMBNAIL_SIZE, CalibrationThumbnailModel::THUMBNAIL_SIZE));
+  ui->listViewFiles->setGridSize(QSize(CalibrationThumbnailModel::THUMBNAIL_SIZE + 10, CalibrationThumbnailModel::THUMBNAIL_SIZE + 40));
+
+  populatePatterns();
 
   // Cargar calibración existente si está disponible
   loadExistingCalibration();
@@ -226,6 +89,7 @@ VideoCalibrationDialog::VideoCalibrationDialog(QWidget* parent) : QDialog(parent
 VideoCalibrationDialog::~VideoCalibrationDialog()
 {
   disconnect(&VideoCaptureHandler::instance(), SIGNAL(newPixmapCaptured(QPixmap)), this, nullptr);
+  disconnect(&VideoCaptureHandler::instance(), SIGNAL(rawFrameCaptured(QImage)), this, nullptr);
 
   if (m_workerThread && m_workerThread->isRunning()) {
     m_workerThread->requestInterruption();
@@ -236,9 +100,48 @@ VideoCalibrationDialog::~VideoCalibrationDialog()
     }
   }
 
+  if (m_liveThread && m_liveThread->isRunning()) {
+    m_liveThread->quit();
+    m_liveThread->wait();
+  }
+
   delete ui;
 }
 
+/**
+ * @brief Rellena el selector de patrón. Los patrones que la versión de OpenCV no soporta se
+ * muestran deshabilitados.
+ */
+void VideoCalibrationDialog::populatePatterns()
+{
+  const QSignalBlocker blocker(ui->comboBoxPattern);
+
+  const CalibrationPattern patterns[] = {CalibrationPattern::Chessboard, CalibrationPattern::ChArUco, CalibrationPattern::AsymmetricCircles};
+  for (CalibrationPattern pattern : patterns) {
+    ui->comboBoxPattern->addItem(CalibrationTarget::defaults(pattern).name(), static_cast<int>(pattern));
+    if (!CalibrationTargetDetector::isPatternAvailable(pattern)) {
+      auto* model = qobject_cast<QStandardItemModel*>(ui->comboBoxPattern->model());
+      if (model)
+        model->item(ui->comboBoxPattern->count() - 1)->setEnabled(false);
+    }
+  }
+  ui->comboBoxPattern->setCurrentIndex(ui->comboBoxPattern->findData(static_cast<int>(m_target.pattern)));
+}
+
+void VideoCalibrationDialog::on_comboBoxPattern_currentIndexChanged(int index)
+{
+  if (index < 0)
+    return;
+
+  m_target = CalibrationTarget::defaults(static_cast<CalibrationPattern>(ui->comboBoxPattern->itemData(index).toInt()));
+  ui->textEditInfo->append(tr("Patrón de calibración: %1").arg(m_target.name()));
+
+  // La captura automática sigue con el nuevo patrón; las poses cubiertas se reinician
+  if (m_autoCaptureEnabled)
+    QMetaObject::invokeMethod(m_liveCollector, "start", Qt::QueuedConnection, Q_ARG(QString, m_selectedDirectoryPath),
+                              Q_ARG(CalibrationTarget, m_target));
+}
+
 void VideoCalibrationDialog::updateVideoLabel()
 {
   if (m_currentPixmap.isNull()) {
@@ -247,6 +150,72 @@ void VideoCalibrationDialog::updateVideoLabel()
   ui->videoLabel->setPixmap(m_currentPixmap.scaled(ui->videoLabel->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
 }
 
+/**
+ * @brief Entrega el fotograma actual al hilo de captura automática.
+ * @details Solo se envía un fotograma cada LIVE_DETECTION_INTERVAL_MS y nunca mientras el
+ * anterior se está procesando; los demás se descartan sin coste para el vídeo.
+ */
+void VideoCalibrationDialog::submitLiveFrame()
+{
+  const int LIVE_DETECTION_INTERVAL_MS = 250;
+
+  if (!m_autoCaptureEnabled || m_rawFrame.isNull())
+    return;
+  if (m_liveFrameTimer.isValid() && m_liveFrameTimer.elapsed() < LIVE_DETECTION_INTERVAL_MS)
+    return;
+  if (!m_liveCollector->tryAcquire())
+    return;
+
+  m_liveFrameTimer.restart();
+  QMetaObject::invokeMethod(m_liveCollector, "processFrame", Qt::QueuedConnection, Q_ARG(QImage, m_rawFrame));
+}
+
+void VideoCalibrationDialog::on_pushButtonAutoCapture_toggled(bool checked)
+{
+  if (checked) {
+    if (m_selectedDirectoryPath.isEmpty()) {
+      QMessageBox::warning(this, tr("Advertencia de Carpeta"), tr("Por favor, selecciona primero una carpeta de destino."));
+      ui->pushButtonAutoCapture->setChecked(false);
+      return;
+    }
+    QMetaObject::invokeMethod(m_liveCollector, "start", Qt::QueuedConnection, Q_ARG(QString, m_selectedDirectoryPath),
+                              Q_ARG(CalibrationTarget, m_target));
+    m_liveFrameTimer.invalidate();
+    m_autoCaptureEnabled = true;
+    ui->labelAutoCaptureStatus->setText(tr("Buscando tablero..."));
+  }
+  else if (m_autoCaptureEnabled) {
+    m_autoCaptureEnabled = false;
+    QMetaObject::invokeMethod(m_liveCollector, "stop", Qt::QueuedConnection);
+  }
+}
+
+void VideoCalibrationDialog::on_liveFrameAccepted(const QString& filePath, const PoseCoverage& coverage)
+{
+  ui->textEditInfo->append(tr("Captura automática guardada: %1").arg(QFileInfo(filePath).fileName()));
+  ui->labelAutoCaptureStatus->setText(tr("%1 vistas | posición %2/%3 | escala %4/%5 | inclinación %6/%7")
+                                        .arg(coverage.acceptedFrames)
+                                        .arg(coverage.positions)
+                                        .arg(PoseCoverage::TOTAL_POSITIONS)
+                                        .arg(coverage.scales)
+                                        .arg(PoseCoverage::TOTAL_SCALES)
+                                        .arg(coverage.tilts)
+                                        .arg(PoseCoverage::TOTAL_TILTS));
+  m_thumbnailModel->addFile(filePath);
+}
+
+void VideoCalibrationDialog::on_liveFrameRejected(const QString& reason)
+{
+  ui->labelAutoCaptureStatus->setText(tr("Descartada: %1").arg(reason));
+}
+
+void VideoCalibrationDialog::on_liveCollectionFinished(const PoseCoverage& coverage)
+{
+  m_autoCaptureEnabled = false;
+  ui->pushButtonAutoCapture->setChecked(false);
+  ui->textEditInfo->append(tr("Captura automática finalizada con %1 vistas.").arg(coverage.acceptedFrames));
+}
+
 void VideoCalibrationDialog::on_pushButtonSelectDirectory_clicked()
 {
   QString newDirPath = QFileDialog::getExistingDirectory(this, tr("Seleccionar Carpeta para Calibración"), m_selectedDirectoryPath);
@@ -254,6 +223,11 @@ void VideoCalibrationDialog::on_pushButtonSelectDirectory_clicked()
   if (!newDirPath.isEmpty()) {
     m_selectedDirectoryPath = newDirPath;
     updateFilesList();
+
+    // La captura automática continúa en la nueva carpeta
+    if (m_autoCaptureEnabled)
+      QMetaObject::invokeMethod(m_liveCollector, "start", Qt::QueuedConnection, Q_ARG(QString, m_selectedDirectoryPath),
+                                Q_ARG(CalibrationTarget, m_target));
   }
 }
 
@@ -264,7 +238,7 @@ void VideoCalibrationDialog::on_pushButtonCaptureImage_clicked()
     return;
   }
 
-  if (m_currentPixmap.isNull()) {
+  if (m_rawFrame.isNull()) {
     QMessageBox::warning(this, tr("Advertencia de Captura"), tr("No hay ninguna imagen de la cámara disponible para guardar."));
     return;
   }
@@ -273,9 +247,9 @@ void VideoCalibrationDialog::on_pushButtonCaptureImage_clicked()
   QString fileName  = QString("capture_%1.tiff").arg(timestamp);
   QString filePath  = QDir(m_selectedDirectoryPath).filePath(fileName);
 
-  if (m_currentPixmap.save(filePath, "TIFF")) {
+  if (m_rawFrame.save(filePath, "TIFF")) {
     ui->textEditInfo->append(tr("Captura guardada: %1").arg(fileName));
-    updateFilesList();
+    m_thumbnailModel->addFile(filePath);
   }
   else {
     QMessageBox::critical(this, tr("Error de Guardado"), tr("No se pudo guardar la imagen en: %1").arg(filePath));
@@ -284,106 +258,12 @@ void VideoCalibrationDialog::on_pushButtonCaptureImage_clicked()
 
 void VideoCalibrationDialog::updateFilesList()
 {
-  QWidget* contentWidget = ui->scrollAreaWidgetContents;
-  QLayout* layout        = contentWidget->layout();
-
-  QGridLayout* gridLayout = qobject_cast<QGridLayout*>(layout);
-  if (!gridLayout) {
-    if (layout) {
-      QLayoutItem* item;
-      while ((item = layout->takeAt(0)) != nullptr) {
-        delete item->widget();
-        delete item;
-      }
-      delete layout;
-    }
-    gridLayout = new QGridLayout(contentWidget);
-    gridLayout->setAlignment(Qt::AlignLeft | Qt::AlignTop);
-    gridLayout->setSpacing(10);
-  }
-
-  QLayoutItem* item;
-  while ((item = gridLayout->takeAt(0)) != nullptr) {
-    delete item->widget();
-    delete item;
-  }
-
-  QDir        directory(m_selectedDirectoryPath);
   QStringList nameFilters;
   nameFilters << "*.png"
               << "*.jpg"
               << "*.jpeg"
               << "*.tiff";
-  QFileInfoList fileList = directory.entryInfoList(nameFilters, QDir::Files, QDir::Name);
-
-  const int THUMBNAIL_WIDTH = 120;
-  int       MAX_COLUMNS     = contentWidget->width() / (THUMBNAIL_WIDTH + 10);
-  MAX_COLUMNS               = qMax(1, MAX_COLUMNS);
-  int row                   = 0;
-  int col                   = 0;
-
-  for (const QFileInfo& fileInfo : fileList) {
-    QString filePath = fileInfo.absoluteFilePath();
-
-    QPixmap originalPixmap(filePath);
-    if (originalPixmap.isNull()) {
-      continue;
-    }
-    QPixmap thumbnail = originalPixmap.scaled(THUMBNAIL_WIDTH, THUMBNAIL_WIDTH, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-
-    QWidget*     itemWidget = new QWidget();
-    QVBoxLayout* itemLayout = new QVBoxLayout(itemWidget);
-    itemLayout->setAlignment(Qt::AlignCenter);
-    itemLayout->setContentsMargins(0, 0, 0, 0);
-
-    QLabel* imageLabel = new QLabel();
-    imageLabel->setPixmap(thumbnail);
-    imageLabel->setAlignment(Qt::AlignCenter);
-    imageLabel->setFixedSize(THUMBNAIL_WIDTH, THUMBNAIL_WIDTH);
-
-    QLabel* nameLabel = new QLabel(fileInfo.fileName());
-    nameLabel->setAlignment(Qt::AlignLeft | Qt::AlignTop);
-    nameLabel->setFixedWidth(THUMBNAIL_WIDTH);
-    nameLabel->setWordWrap(true);
-
-    itemLayout->addWidget(imageLabel);
-    itemLayout->addWidget(nameLabel);
-
-    gridLayout->addWidget(itemWidget, row, col);
-
-    col++;
-    if (col >= MAX_COLUMNS) {
-      col = 0;
-      row++;
-    }
-  }
-
-  contentWidget->adjustSize();
-}
-
-/**
- * @brief Carga las matrices de calibración.
- */
-bool VideoCalibrationDialog::loadCalibration(const std::string& camMatrixPath)
-{
-  cv::FileStorage fs(camMatrixPath, cv::FileStorage::READ);
-  if (!fs.isOpened()) {
-    return false;
-  }
-
-  fs["m_cameraMatrix"] >> m_cameraMatrix;
-  fs["m_newCameraMatrix"] >> m_newCameraMatrix; // <-- AÑADIDO
-  fs.release();
-
-  // También cargamos los coeficientes si es posible
-  QString         distCoeffsPath = QDir(DEFAULT_CALIB_DIR).filePath("dist_coeffs.yml");
-  cv::FileStorage fsDist(distCoeffsPath.toStdString(), cv::FileStorage::READ);
-  if (fsDist.isOpened()) {
-    fsDist["m_distCoeffs"] >> m_distCoeffs;
-    fsDist.release();
-  }
-
-  return !m_cameraMatrix.empty();
+  m_thumbnailModel->setDirectory(m_selectedDirectoryPath, nameFilters);
 }
 
 /**
@@ -418,28 +298,56 @@ void VideoCalibrationDialog::displayCalibrationResults(const cv::Mat& cameraMatr
 }
 
 /**
- * @brief Comprueba si existe un archivo de calibración y lo carga al inicio.
+ * @brief Muestra el error de reproyección de cada imagen y lo refleja en la lista de archivos.
  */
-void VideoCalibrationDialog::loadExistingCalibration()
+void VideoCalibrationDialog::displayViewErrors(const QVector<CalibrationViewError>& viewErrors)
 {
-  // Ruta del archivo de la matriz de cámara a buscar
-  QString camMatrixFile = "camera_matrix.yml";
-  QString camMatrixPath = QDir(DEFAULT_CALIB_DIR).filePath(camMatrixFile);
-
-  if (QFile::exists(camMatrixPath)) {
-    ui->textEditInfo->setText(tr("¡Calibración existente detectada!"));
+  if (viewErrors.isEmpty())
+    return;
 
-    if (loadCalibration(camMatrixPath.toStdString())) {
-      // Usamos la nueva función auxiliar para mostrar (con la nueva matriz)
-      displayCalibrationResults(m_cameraMatrix, m_distCoeffs, m_newCameraMatrix, 0.0);
-    }
-    else {
-      ui->textEditInfo->append(tr("Advertencia: No se pudo cargar la calibración."));
-    }
+  QString text = tr("Error de reproyección por imagen:");
+  for (const CalibrationViewError& view : viewErrors) {
+    text += QString("\n  %1: %2 px").arg(view.fileName).arg(view.error, 0, 'f', 3);
+    if (view.rejected)
+      text += tr("  [descartada]");
   }
-  else {
+  ui->textEditInfo->append(text);
+
+  m_thumbnailModel->clearViewErrors();
+  for (const CalibrationViewError& view : viewErrors)
+    m_thumbnailModel->setViewError(view.fileName, view.error, view.rejected);
+}
+
+/**
+ * @brief Comprueba si existen perfiles de calibración de la cámara activa y los muestra al inicio.
+ */
+void VideoCalibrationDialog::loadExistingCalibration()
+{
+  CameraInfo                      info     = VideoCaptureHandler::instance().cameraInfo();
+  std::vector<CalibrationProfile> profiles = CalibrationProfile::loadAll(DEFAULT_CALIB_DIR, info.name);
+
+  if (profiles.empty()) {
     ui->textEditInfo->setText(tr("No se ha encontrado ninguna calibración previa en la carpeta '%1'.").arg(DEFAULT_CALIB_DIR));
+    return;
   }
+
+  ui->textEditInfo->setText(tr("¡Calibración existente detectada!"));
+  for (const CalibrationProfile& profile : profiles) {
+    if (profile.isLegacy())
+      ui->textEditInfo->append(tr("Perfil sin resolución (formato antiguo)"));
+    else
+      ui->textEditInfo->append(tr("Perfil %1x%2").arg(profile.imageSize.width).arg(profile.imageSize.height));
+  }
+
+  // Se muestra el perfil que se aplica a la resolución activa (escalado si es necesario)
+  CalibrationProfile active = CalibrationProfile::select(profiles, cv::Size(info.width, info.height));
+  if (!active.isValid())
+    active = profiles.front();
+
+  m_cameraMatrix    = active.cameraMatrix;
+  m_distCoeffs      = active.distCoeffs;
+  m_newCameraMatrix = active.newCameraMatrix;
+  displayCalibrationResults(m_cameraMatrix, m_distCoeffs, m_newCameraMatrix, 0.0);
 }
 
 /**
@@ -474,7 +382,8 @@ void VideoCalibrationDialog::on_startButton_clicked()
 
   // 3. Iniciar el trabajo en el hilo (NO BLOQUEANTE)
   QMetaObject::invokeMethod(m_worker, "doCalibration", Qt::QueuedConnection, Q_ARG(QString, m_selectedDirectoryPath),
-                            Q_ARG(cv::Size, m_calibrationBoardSize), Q_ARG(float, m_squareSize));
+                            Q_ARG(CalibrationTarget, m_target),
+                            Q_ARG(QString, QString::fromStdString(VideoCaptureHandler::instance().cameraInfo().name)));
 }
 
 /**
@@ -507,8 +416,12 @@ void VideoCalibrationDialog::on_calibrationFinished(const CalibrationResult& res
 
   // 2. Mostrar los resultados
   displayCalibrationResults(result.cameraMatrix, result.distCoeffs, result.newCameraMatrix, result.rms);
+  displayViewErrors(result.viewErrors);
   ui->textEditInfo->append(tr("\nProceso de calibración finalizado."));
 
-  // 3. Re-habilitar el botón
+  // 3. Aplicar la nueva calibración al vídeo en directo sin reiniciar la cámara
+  VideoCaptureHandler::instance().reloadCalibration();
+
+  // 4. Re-habilitar el botón
   ui->startButton->setEnabled(true);
 }
\ No newline at end of file
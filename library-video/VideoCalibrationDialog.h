@@ -1,13 +1,21 @@
 #ifndef VIDEOCALIBRATIONDIALOG_H
 #define VIDEOCALIBRATIONDIALOG_H
 
+#include "CalibrationLiveCollector.h"
+#include "CalibrationProfile.h"
+#include "CalibrationThumbnailModel.h"
+#include "CalibrationWorker.h"
 #include "VideoCaptureHandler.h"
 #include <QDialog>
+#include <QElapsedTimer>
+#include <QImage>
 #include <QPixmap>
 #include <QResizeEvent>
 #include <QSize>
 #include <QString>
+#include <QStringList>
 #include <QThread>
+#include <QVector>
 #include <opencv2/opencv.hpp>
 
 namespace Ui
@@ -15,48 +23,6 @@ namespace Ui
 class VideoCalibrationDialog;
 }
 
-struct CalibrationResult
-{
-  double   rms = -1.0;
-  cv::Mat  cameraMatrix;
-  cv::Mat  distCoeffs;
-  cv::Mat  newCameraMatrix; // Matriz óptima
-  cv::Rect roi;             // Región de interés
-  int      processedCount = 0;
-};
-Q_DECLARE_METATYPE(CalibrationResult)
-
-// Esta clase contiene la lógica de calibración que se ejecutará en segundo plano
-class CalibrationWorker : public QObject
-{
-  Q_OBJECT
-public:
-  CalibrationWorker(QObject* parent = nullptr) : QObject(parent)
-  {
-    qRegisterMetaType<CalibrationResult>();
-  }
-
-public slots:
-  // Slot que será llamado por el hilo principal para iniciar la tarea
-  void doCalibration(const QString& directoryPath, cv::Size boardSize, float squareSize);
-
-signals:
-  // Señales para enviar resultados al hilo principal (VideoCalibrationDialog)
-  void calibrationFinished(const CalibrationResult& result);
-  void calibrationError(const QString& message);
-  void progressUpdate(const QString& message); // Para mostrar el progreso
-
-private:
-  // Métodos de calibración movidos del VideoCalibrationDialog
-  std::vector<cv::Point3f> createObjectPoints(cv::Size boardSize, float squareSize) const;
-  bool processImageForCorners(const cv::Mat& image, cv::Size boardSize, float squareSize, std::vector<std::vector<cv::Point2f>>& imagePoints,
-                              std::vector<std::vector<cv::Point3f>>& objectPoints);
-  bool runCalibration(cv::Size boardSize, std::vector<std::vector<cv::Point2f>>& imagePoints, std::vector<std::vector<cv::Point3f>>& objectPoints,
-                      CalibrationResult& result);
-  void saveCalibration(const std::string& cameraMatrixFile, const std::string& distCoeffsFile, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs,
-                       const cv::Mat& newCameraMatrix) const;
-};
-
 class VideoCalibrationDialog : public QDialog
 {
   Q_OBJECT
@@ -75,14 +41,23 @@ private slots:
   void on_calibrationError(const QString& message);
   void on_progressUpdate(const QString& message);
 
+  // Captura automática sobre el vídeo en directo
+  void on_pushButtonAutoCapture_toggled(bool checked);
+  void on_comboBoxPattern_currentIndexChanged(int index);
+  void on_liveFrameAccepted(const QString& filePath, const PoseCoverage& coverage);
+  void on_liveFrameRejected(const QString& reason);
+  void on_liveCollectionFinished(const PoseCoverage& coverage);
+
 private:
   Ui::VideoCalibrationDialog* ui;
 
-  QPixmap m_currentPixmap;
+  QPixmap m_currentPixmap; // Corregido, solo para mostrar
+  QImage  m_rawFrame;      // Sin corregir: el que se guarda para calibrar
   QString m_selectedDirectoryPath;
 
-  cv::Size m_calibrationBoardSize = cv::Size(9, 6); // Tamaño del tablero de ajedrez (número de esquinas interiores)
-  float    m_squareSize           = 10.0f;          // Tamaño real de cada cuadrado en mm
+  CalibrationThumbnailModel* m_thumbnailModel = nullptr;
+
+  CalibrationTarget m_target = CalibrationTarget::defaults(CalibrationPattern::Chessboard); // Patrón y medidas reales (mm)
 
   cv::Mat m_cameraMatrix; // Matriz de cámara
   cv::Mat m_distCoeffs;   // Coeficientes de distorsión
@@ -92,11 +67,19 @@ private:
   QThread*           m_workerThread = nullptr;
   CalibrationWorker* m_worker       = nullptr;
 
+  // Hilo de la captura automática
+  QThread*                  m_liveThread    = nullptr;
+  CalibrationLiveCollector* m_liveCollector = nullptr;
+  QElapsedTimer             m_liveFrameTimer;
+  bool                      m_autoCaptureEnabled = false;
+
+  void populatePatterns();
   void updateVideoLabel();
+  void submitLiveFrame();
   void updateFilesList();
   void displayCalibrationResults(const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, const cv::Mat& newCameraMatrix, double rms);
+  void displayViewErrors(const QVector<CalibrationViewError>& viewErrors);
 
-  bool loadCalibration(const std::string& filename);
   void loadExistingCalibration();
 };
 #endif // VIDEOCALIBRATIONDIALOG_H
\ No newline at end of file
@@ -1,8 +1,14 @@
 #include "VideoCaptureHandler.h"
 #include <QDebug>
 #include <QDir>
+#include <QMetaMethod>
+#include <QThreadPool>
 #include <QtMath>
-#include <opencv2/core/persistence.hpp>
+
+namespace
+{
+const QString CALIBRATION_DIR = "calibration";
+} // namespace
 
 VideoCaptureHandler& VideoCaptureHandler::instance()
 {
@@ -16,8 +22,8 @@ VideoCaptureHandler::VideoCaptureHandler(QObject* parent) : QThread(parent)
   qRegisterMetaType<CameraPropertyRanges>();
   qRegisterMetaType<CameraInfo>();
 
-  m_isCalibrated = false; // Inicializar
-  loadCalibration();      // Cargar la calibración al iniciar
+  // Hasta conocer la cámara solo se dispone del perfil antiguo (y de su paquete binario, si existe)
+  publishProfiles(m_cameraInfo.name, {});
 
   start(QThread::HighestPriority);
 }
@@ -33,6 +39,11 @@ bool VideoCaptureHandler::isCameraRunning() const
   return m_VideoCapture.isOpened();
 }
 
+CameraInfo VideoCaptureHandler::cameraInfo() const
+{
+  return m_cameraInfo;
+}
+
 void VideoCaptureHandler::requestCameraChange(int cameraId, const QSize& resolution)
 {
   m_requestedWidth  = resolution.width();
@@ -42,12 +53,21 @@ void VideoCaptureHandler::requestCameraChange(int cameraId, const QSize& resolut
   m_cameraInfo.height = resolution.height();
   m_requestedCamera   = cameraId;
 
+  // Los mapas de la nueva resolución se generan mientras la cámara se abre
+  if (cameraId >= START_CAMERA && !resolution.isEmpty())
+    scheduleMapBuild(cv::Size(resolution.width(), resolution.height()));
+
   emit cameraInfoChanged(m_cameraInfo);
 }
 
 void VideoCaptureHandler::setCameraName(const std::string& name)
 {
+  bool changed      = (m_cameraInfo.name != name);
   m_cameraInfo.name = name;
+
+  if (changed)
+    publishProfiles(name, {cv::Size(m_requestedWidth.load(), m_requestedHeight.load())});
+
   emit cameraInfoChanged(m_cameraInfo);
 }
 void VideoCaptureHandler::setAutoFocus(bool manual)
@@ -116,42 +136,108 @@ PropertyRange VideoCaptureHandler::getPropertyRange(int propId)
   return range;
 }
 
-void VideoCaptureHandler::loadCalibration()
+std::shared_ptr<const UndistortionData> UndistortionSet::find(cv::Size size) const
 {
-  QString dirPath        = "calibration";
-  QString camMatrixPath  = QDir(dirPath).filePath("camera_matrix.yml");
-  QString distCoeffsPath = QDir(dirPath).filePath("dist_coeffs.yml");
+  for (const std::shared_ptr<const UndistortionData>& data : maps) {
+    if (data->mapSize == size)
+      return data;
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Elige el perfil para la resolución y genera sus mapas de corrección.
+ * @details Si ningún perfil es aplicable se devuelve una entrada sin mapas, para que el hilo de
+ * captura no vuelva a solicitarla en cada fotograma.
+ */
+std::shared_ptr<const UndistortionData> VideoCaptureHandler::buildUndistortion(const std::vector<CalibrationProfile>& profiles, cv::Size size)
+{
+  auto data     = std::make_shared<UndistortionData>();
+  data->mapSize = size;
+  data->profile = CalibrationProfile::select(profiles, size);
 
-  qDebug() << "Cargando archivos de calibración desde:" << camMatrixPath << "y" << distCoeffsPath;
+  if (data->profile.isValid()) {
+    cv::initUndistortRectifyMap(data->profile.cameraMatrix, data->profile.distCoeffs, cv::Mat(), data->profile.newCameraMatrix, size, CV_16SC2,
+                                data->map1, data->map2);
+  }
+  return data;
+}
 
-  cv::FileStorage fsCam(camMatrixPath.toStdString(), cv::FileStorage::READ);
-  cv::FileStorage fsDist(distCoeffsPath.toStdString(), cv::FileStorage::READ);
+/**
+ * @brief Carga los perfiles de una cámara y los publica de forma atómica.
+ * @details Si el paquete binario de la cámara está al día, sus mapas se usan directamente sobre
+ * el fichero mapeado y no se genera ninguno. Si no, se leen los .yml y se generan los mapas para
+ * las resoluciones indicadas y para todas las que tienen perfil propio. Todo ocurre en el pool
+ * global; el hilo de captura sigue usando el conjunto anterior hasta que el nuevo está completo,
+ * por lo que ningún fotograma se procesa con datos a medias ni espera a que se generen los mapas.
+ */
+void VideoCaptureHandler::publishProfiles(const std::string& cameraName, const std::vector<cv::Size>& prebuildSizes)
+{
+  const int generation = ++m_undistortionGeneration;
 
-  if (fsCam.isOpened() && fsDist.isOpened()) {
-    fsCam["m_cameraMatrix"] >> m_cameraMatrix;
-    fsCam["m_newCameraMatrix"] >> m_newCameraMatrix; // <-- ¡NUEVO! Cargar
-    fsDist["m_distCoeffs"] >> m_distCoeffs;
+  QThreadPool::globalInstance()->start([this, cameraName, prebuildSizes, generation]() {
+    auto set        = std::make_shared<UndistortionSet>();
+    set->generation = generation;
+    set->cameraName = cameraName;
 
-    // Imprimir en consola (como tenías antes)
-    std::cout << "Matriz de Cámara (Original):\\n" << m_cameraMatrix << std::endl;
-    std::cout << "Matriz de Cámara (Óptima):\\n" << m_newCameraMatrix << std::endl;
-    std::cout << "Coeficientes de Distorsión:\\n" << m_distCoeffs << std::endl;
+    bool fromBundle = CalibrationBundle::load(CALIBRATION_DIR, cameraName, set->profiles, set->maps);
+    if (!fromBundle)
+      set->profiles = CalibrationProfile::loadAll(CALIBRATION_DIR, cameraName);
 
-    // Comprobar que se cargaron las TRES matrices
-    if (!m_cameraMatrix.empty() && !m_distCoeffs.empty() && !m_newCameraMatrix.empty()) {
-      m_isCalibrated = true;
-      qDebug() << "Calibración cargada exitosamente.";
+    std::vector<cv::Size> sizes = prebuildSizes;
+    for (const CalibrationProfile& profile : set->profiles) {
+      if (!profile.isLegacy())
+        sizes.push_back(profile.imageSize);
     }
-    else {
-      qWarning() << "No se pudieron leer todos los datos de los archivos de calibración.";
+    bool builtMaps = false;
+    for (const cv::Size& size : sizes) {
+      if (!size.empty() && !set->find(size)) {
+        set->maps.push_back(buildUndistortion(set->profiles, size));
+        builtMaps = true;
+      }
     }
-  }
-  else {
-    qWarning() << "No se encontraron archivos de calibración. El vídeo no será corregido.";
-  }
 
-  fsCam.release();
-  fsDist.release();
+    // Una publicación más reciente (p. ej. otro cambio de cámara) tiene prioridad
+    std::shared_ptr<const UndistortionSet> current = std::atomic_load(&m_undistortion);
+    do {
+      if (current && current->generation > generation)
+        return;
+    } while (!std::atomic_compare_exchange_weak(&m_undistortion, &current, std::shared_ptr<const UndistortionSet>(set)));
+
+    qDebug() << "Perfiles de calibración publicados:" << set->profiles.size() << "perfiles," << set->maps.size() << "resoluciones preparadas"
+             << (fromBundle ? "(paquete binario)." : "(YAML).");
+
+    if (builtMaps && !set->profiles.empty())
+      CalibrationBundle::save(CALIBRATION_DIR, cameraName, set->profiles, set->maps);
+  });
+}
+
+void VideoCaptureHandler::reloadCalibration()
+{
+  publishProfiles(m_cameraInfo.name, {cv::Size(m_requestedWidth.load(), m_requestedHeight.load()),
+                                      cv::Size(m_lastFrameWidth.load(), m_lastFrameHeight.load())});
+}
+
+/**
+ * @brief Genera en segundo plano los mapas de una resolución que aún no los tiene.
+ * @details El conjunto se copia con la entrada nueva y solo se publica si entretanto no se ha
+ * publicado otro.
+ */
+void VideoCaptureHandler::scheduleMapBuild(cv::Size size)
+{
+  if (m_mapBuildPending.exchange(true))
+    return;
+
+  QThreadPool::globalInstance()->start([this, size]() {
+    std::shared_ptr<const UndistortionSet> current = std::atomic_load(&m_undistortion);
+    if (current && !current->find(size)) {
+      auto next = std::make_shared<UndistortionSet>(*current);
+      next->maps.push_back(buildUndistortion(current->profiles, size));
+      if (std::atomic_compare_exchange_strong(&m_undistortion, &current, std::shared_ptr<const UndistortionSet>(next)) && !next->profiles.empty())
+        CalibrationBundle::save(CALIBRATION_DIR, next->cameraName, next->profiles, next->maps); // Disponible en el próximo arranque
+    }
+    m_mapBuildPending = false;
+  });
 }
 
 void VideoCaptureHandler::run()
@@ -260,16 +346,35 @@ void VideoCaptureHandler::run()
 
         cv::Mat correctedFrame; // Fotograma corregido
 
-        if (m_isCalibrated) {
-          cv::undistort(m_frame,            // 1. Entrada
-                        correctedFrame,     // 2. Salida
-                        m_cameraMatrix,     // 3. Matriz Original
-                        m_distCoeffs,       // 4. Coeficientes
-                        m_newCameraMatrix); // 5. Matriz Óptima
+        m_lastFrameWidth  = m_frame.cols;
+        m_lastFrameHeight = m_frame.rows;
+
+        // Las imágenes de calibración tienen que ser las originales: corregidas, se calibraría la
+        // distorsión residual del perfil activo. Con memoria propia, m_frame se reutiliza
+        if (isSignalConnected(QMetaMethod::fromSignal(&VideoCaptureHandler::rawFrameCaptured))) {
+          QImage raw = cvMatToQImage(m_frame);
+          emit rawFrameCaptured(raw.constBits() == m_frame.data ? raw.copy() : raw);
+        }
+
+        // Una única instantánea por fotograma: una recarga simultánea no puede mezclar datos
+        std::shared_ptr<const UndistortionSet>  undistortion = std::atomic_load(&m_undistortion);
+        std::shared_ptr<const UndistortionData> calibration  = undistortion ? undistortion->find(m_frame.size()) : nullptr;
+
+        if (calibration && !calibration->map1.empty()) {
+          cv::remap(m_frame, correctedFrame, calibration->map1, calibration->map2, cv::INTER_LINEAR);
+        }
+        else if (undistortion && !calibration && !undistortion->profiles.empty()) {
+          // Resolución sin mapas todavía: se corrige directamente (más caro, genera los mapas en
+          // cada fotograma) mientras el pool los prepara
+          scheduleMapBuild(m_frame.size());
+          const CalibrationProfile profile = CalibrationProfile::select(undistortion->profiles, m_frame.size());
+          if (profile.isValid())
+            cv::undistort(m_frame, correctedFrame, profile.cameraMatrix, profile.distCoeffs, profile.newCameraMatrix);
+          else
+            correctedFrame = m_frame.clone();
         }
         else {
-          // Si no hay calibración, solo clonar
-          correctedFrame = m_frame.clone();
+          correctedFrame = m_frame.clone(); // Sin calibración aplicable a esta resolución
         }
 
         // Emitir la imagen corregida
@@ -1,13 +1,16 @@
 #ifndef VIDEOCAPTUREHANDLER_H
 #define VIDEOCAPTUREHANDLER_H
 
+#include "CalibrationBundle.h"
 #include <QImage>
 #include <QMetaType>
 #include <QPixmap>
 #include <QSize>
 #include <QThread>
 #include <atomic>
+#include <memory>
 #include <opencv2/opencv.hpp>
+#include <vector>
 
 #define ID_CAMERA_DEFAULT 0
 
@@ -65,6 +68,17 @@ struct CameraInfo
 };
 Q_DECLARE_METATYPE(CameraInfo)
 
+// Estado que lee el hilo de captura: perfiles de la cámara activa y mapas ya generados
+struct UndistortionSet
+{
+  int                                                  generation = 0;
+  std::string                                          cameraName;
+  std::vector<CalibrationProfile>                      profiles;
+  std::vector<std::shared_ptr<const UndistortionData>> maps; // Uno por resolución
+
+  std::shared_ptr<const UndistortionData> find(cv::Size size) const;
+};
+
 class VideoCaptureHandler : public QThread
 {
   Q_OBJECT
@@ -85,10 +99,17 @@ public:
   void setFocus(int value);
   void setExposure(int value);
 
-  bool isCameraRunning() const;
+  bool       isCameraRunning() const;
+  CameraInfo cameraInfo() const;
+
+  // Relee los perfiles de calibración de disco y los publica en el hilo de captura sin detenerlo
+  void reloadCalibration();
 
 signals:
   void newPixmapCaptured(const QPixmap& pixmap);
+  // Fotograma tal como sale de la cámara, sin corregir la distorsión (para calibrar). Solo se
+  // convierte si hay alguien conectado
+  void rawFrameCaptured(const QImage& frame);
   void propertiesSupported(CameraPropertiesSupport support);
   void cameraInfoChanged(const CameraInfo& values);
   void rangesSupported(CameraPropertyRanges ranges);
@@ -121,12 +142,17 @@ private:
   std::atomic<int> m_requestedSaturation{STOP_CAMERA};
   std::atomic<int> m_requestedSharpness{STOP_CAMERA};
 
-  bool    m_isCalibrated;
-  cv::Mat m_cameraMatrix;    // Matriz original
-  cv::Mat m_distCoeffs;      // Coeficientes de distorsión
-  cv::Mat m_newCameraMatrix; // Matriz óptima
+  // Instantánea publicada con std::atomic_load/atomic_store: nula hasta la primera carga
+  std::shared_ptr<const UndistortionSet> m_undistortion;
+  std::atomic<int>                       m_undistortionGeneration{0};
+  std::atomic<bool>                      m_mapBuildPending{false};
+  std::atomic<int>                       m_lastFrameWidth{0};
+  std::atomic<int>                       m_lastFrameHeight{0};
+
+  void publishProfiles(const std::string& cameraName, const std::vector<cv::Size>& prebuildSizes);
+  void scheduleMapBuild(cv::Size size);
 
-  void loadCalibration(); // Función auxiliar
+  static std::shared_ptr<const UndistortionData> buildUndistortion(const std::vector<CalibrationProfile>& profiles, cv::Size size);
 
   QImage  cvMatToQImage(const cv::Mat& inMat);
   QPixmap cvMatToQPixmap(const cv::Mat& inMat);
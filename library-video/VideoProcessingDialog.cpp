@@ -1,16 +1,38 @@
 #include "VideoProcessingDialog.h"
 #include "./ui_VideoProcessingDialog.h"
 #include "ClickableLabel.h"
+#include "../library-robot/RobotHandler.h"
 #include <QCameraDevice>
 #include <QMediaDevices>
 #include <QMessageBox>
 #include <QPainter>
+#include <QSettings>
 #include <QtMath>
 #include <algorithm>
 #include <opencv2/opencv.hpp>
 
-VideoProcessingDialog::VideoProcessingDialog(QWidget* parent)
-  : QDialog(parent), ui(new Ui::VideoProcessingDialog), m_selectedCorner(None), m_applySegmentacion(false)
+namespace
+{
+// Claves de QSettings de cada esquina de la mesa, en el orden de m_tableCorners
+const char* const TABLE_CORNER_KEYS[4] = {"table/TL", "table/TR", "table/BR", "table/BL"};
+const int         ALL_TABLE_CORNERS    = 0xF;
+
+double meanHeight(const std::array<cv::Point3d, 4>& corners, int mask)
+{
+  double sum   = 0;
+  int    count = 0;
+  for (int i = 0; i < 4; ++i) {
+    if (mask & (1 << i)) {
+      sum += corners[i].z;
+      ++count;
+    }
+  }
+  return count ? sum / count : 0;
+}
+} // namespace
+
+VideoProcessingDialog::VideoProcessingDialog(QWidget* parent, RobotHandler* robot)
+  : QDialog(parent), ui(new Ui::VideoProcessingDialog), m_robot(robot), m_selectedCorner(None), m_applySegmentacion(false)
 {
   ui->setupUi(this);
   this->setWindowTitle("Camera Manager");
@@ -44,6 +66,9 @@ VideoProcessingDialog::VideoProcessingDialog(QWidget* parent)
     updatePointInfoLabel();
   });
 
+  loadTableGeometry();
+  updatePointInfoLabel();
+
   // Llenar ComboBox de cámaras
   QStringList cameraNames;
   for (const QCameraDevice& camera : QMediaDevices::videoInputs()) {
@@ -117,6 +142,63 @@ void VideoProcessingDialog::on_videoLabel_clicked(const QPoint& pos)
   drawCropPointsOnLabel();
 }
 
+// Guarda como esquina de la mesa del punto seleccionado la posición actual de la pinza
+void VideoProcessingDialog::on_pushButtonTeachTableCorner_clicked()
+{
+  if (m_selectedCorner == None) {
+    QMessageBox::information(this, "Esquina de la mesa", "Selecciona el punto (1-4) de la esquina que toca la pinza.");
+    return;
+  }
+  if (!m_robot || !m_robot->poseKnown()) {
+    QMessageBox::warning(this, "Esquina de la mesa", "No se conoce la pose del robot: conecta el robot antes de medir la mesa.");
+    return;
+  }
+
+  const int                        index   = m_selectedCorner - TL;
+  const RobotKinematics::Transform gripper = RobotKinematics::effectorPose(m_robot->currentAngles(), m_robot->geometry());
+  m_tableCorners[index]                    = RobotKinematics::transformPoint(gripper, cv::Point3d(0, 0, 0));
+  m_tableCornerMask |= 1 << index;
+  m_tableHeight = meanHeight(m_tableCorners, m_tableCornerMask);
+  saveTableGeometry();
+
+  // La máscara de alcance depende de las esquinas: se recalcula en el siguiente fotograma
+  m_reachableMask.release();
+  m_maskMap.reset();
+  updatePointInfoLabel();
+}
+
+void VideoProcessingDialog::loadTableGeometry()
+{
+  QSettings settings("InBiot", "QualityTest");
+  m_tableCornerMask = 0;
+  for (int i = 0; i < 4; ++i) {
+    const QString key = TABLE_CORNER_KEYS[i];
+    if (!settings.contains(key + "/x") || !settings.contains(key + "/y") || !settings.contains(key + "/z"))
+      continue;
+    m_tableCorners[i] =
+      cv::Point3d(settings.value(key + "/x").toDouble(), settings.value(key + "/y").toDouble(), settings.value(key + "/z").toDouble());
+    m_tableCornerMask |= 1 << i;
+  }
+  m_tableHeight = meanHeight(m_tableCorners, m_tableCornerMask);
+  m_pickHeight  = settings.value("table/pickHeight", m_pickHeight).toDouble();
+}
+
+void VideoProcessingDialog::saveTableGeometry() const
+{
+  QSettings settings("InBiot", "QualityTest");
+  for (int i = 0; i < 4; ++i) {
+    if (!(m_tableCornerMask & (1 << i)))
+      continue;
+    const QString key = TABLE_CORNER_KEYS[i];
+    settings.setValue(key + "/x", m_tableCorners[i].x);
+    settings.setValue(key + "/y", m_tableCorners[i].y);
+    settings.setValue(key + "/z", m_tableCorners[i].z);
+  }
+  settings.setValue("table/pickHeight", m_pickHeight);
+}
+
+bool VideoProcessingDialog::tableGeometryValid() const { return m_tableCornerMask == ALL_TABLE_CORNERS; }
+
 void VideoProcessingDialog::updatePointInfoLabel()
 {
   QString info;
@@ -126,6 +208,16 @@ void VideoProcessingDialog::updatePointInfoLabel()
   info += QString("BR: (%1, %2)\n").arg(m_cropPointBR.x()).arg(m_cropPointBR.y());
   info += QString("BL: (%1, %2)\n").arg(m_cropPointBL.x()).arg(m_cropPointBL.y());
 
+  // Esquinas de la mesa en coordenadas del robot (mm)
+  const char* const names[4] = {"TL", "TR", "BR", "BL"};
+  for (int i = 0; i < 4; ++i) {
+    const cv::Point3d& corner = m_tableCorners[i];
+    if (m_tableCornerMask & (1 << i))
+      info += QString("Mesa %1: (%2, %3, %4)\n").arg(names[i]).arg(corner.x, 0, 'f', 1).arg(corner.y, 0, 'f', 1).arg(corner.z, 0, 'f', 1);
+    else
+      info += QString("Mesa %1: sin medir\n").arg(names[i]);
+  }
+
   ui->labelCurrentPoint->setText(info);
 }
 
@@ -272,21 +364,41 @@ void VideoProcessingDialog::applySegmentacion(QPixmap& pixmap)
   double  max_area    = 0;
   int     largest_idx = -1;
 
+  // Zona fuera del alcance del robot sombreada en rojo. Sin las cuatro esquinas de la mesa medidas
+  // no hay correspondencia fiable entre píxel y robot: ni sombreado ni descarte
+  const std::shared_ptr<const WorkspaceMap> map = m_robot && tableGeometryValid() ? m_robot->workspaceMap() : nullptr;
+  cv::Mat                                   homography;
+  if (map) {
+    homography = tableHomography(output.size());
+    cv::Mat tint(output.size(), output.type(), cv::Scalar(0, 0, 255));
+    cv::Mat blended;
+    cv::addWeighted(output, 0.65, tint, 0.35, 0, blended);
+    blended.copyTo(output, reachableMask(map, output.size()) == 0);
+  }
+
   for (size_t i = 0; i < contours.size(); i++) {
     double area = cv::contourArea(contours[i]);
     if (area < 100)
       continue; // descartar muy pequeños
 
+    cv::Rect    box = cv::boundingRect(contours[i]);
+    cv::Moments M   = cv::moments(contours[i]);
+    if (M.m00 == 0)
+      continue;
+    int cx = int(M.m10 / M.m00);
+    int cy = int(M.m01 / M.m00);
+
+    // Objetos que el brazo no alcanza: caja gris tachada y fuera de la selección, sin llegar a la cinemática inversa
+    if (map && !map->contains(pixelToRobot(homography, cv::Point2d(cx, cy)))) {
+      cv::rectangle(output, box, cv::Scalar(128, 128, 128), 2);
+      cv::line(output, box.tl(), box.br(), cv::Scalar(128, 128, 128), 2);
+      cv::line(output, cv::Point(box.x + box.width, box.y), cv::Point(box.x, box.y + box.height), cv::Scalar(128, 128, 128), 2);
+      continue;
+    }
+
     // Dibujar rectángulo verde y centro rojo
-    cv::Rect box = cv::boundingRect(contours[i]);
     cv::rectangle(output, box, cv::Scalar(0, 255, 0), 2);
-
-    cv::Moments M = cv::moments(contours[i]);
-    if (M.m00 != 0) {
-      int cx = int(M.m10 / M.m00);
-      int cy = int(M.m01 / M.m00);
-      cv::circle(output, cv::Point(cx, cy), 4, cv::Scalar(0, 0, 255), -1);
-    }
+    cv::circle(output, cv::Point(cx, cy), 4, cv::Scalar(0, 0, 255), -1);
 
     if (area > max_area) {
       max_area    = area;
@@ -312,6 +424,57 @@ void VideoProcessingDialog::applySegmentacion(QPixmap& pixmap)
   QImage outImg(output_rgb.data, output_rgb.cols, output_rgb.rows, output_rgb.step, QImage::Format_RGB888);
   pixmap = QPixmap::fromImage(outImg.copy()); // copia para asegurar memoria válida
 }
+
+// Homografía de la vista rectificada (W x H) al plano de la mesa en coordenadas del robot
+cv::Mat VideoProcessingDialog::tableHomography(const cv::Size& size) const
+{
+  std::vector<cv::Point2f> imagePts = {cv::Point2f(0, 0), cv::Point2f(size.width - 1, 0), cv::Point2f(size.width - 1, size.height - 1),
+                                       cv::Point2f(0, size.height - 1)};
+  std::vector<cv::Point2f> tablePts;
+  for (const cv::Point3d& corner : m_tableCorners)
+    tablePts.emplace_back(float(corner.x), float(corner.y));
+  return cv::getPerspectiveTransform(imagePts, tablePts);
+}
+
+cv::Point3d VideoProcessingDialog::pixelToRobot(const cv::Mat& homography, const cv::Point2d& pixel) const
+{
+  std::vector<cv::Point2d> src = {pixel};
+  std::vector<cv::Point2d> dst;
+  cv::perspectiveTransform(src, dst, homography);
+  return cv::Point3d(dst[0].x, dst[0].y, m_tableHeight + m_pickHeight);
+}
+
+/**
+ * @brief Máscara (255 = alcanzable) de la vista rectificada a la altura de agarre. Se muestrea
+ * cada pocos píxeles y se amplía sin interpolar; solo se recalcula cuando cambia el mapa o el
+ * tamaño del recorte, no en cada fotograma.
+ */
+const cv::Mat& VideoProcessingDialog::reachableMask(const std::shared_ptr<const WorkspaceMap>& map, const cv::Size& size)
+{
+  const int MASK_STEP = 4;
+  if (map == m_maskMap && m_reachableMask.size() == size)
+    return m_reachableMask;
+
+  const cv::Size           coarse((size.width + MASK_STEP - 1) / MASK_STEP, (size.height + MASK_STEP - 1) / MASK_STEP);
+  std::vector<cv::Point2d> pixels;
+  pixels.reserve(size_t(coarse.area()));
+  for (int y = 0; y < coarse.height; ++y) {
+    for (int x = 0; x < coarse.width; ++x)
+      pixels.emplace_back(x * MASK_STEP + MASK_STEP / 2, y * MASK_STEP + MASK_STEP / 2);
+  }
+  std::vector<cv::Point2d> table;
+  cv::perspectiveTransform(pixels, table, tableHomography(size));
+
+  cv::Mat mask(coarse, CV_8U);
+  for (size_t i = 0; i < table.size(); ++i)
+    mask.at<uchar>(int(i) / coarse.width, int(i) % coarse.width) =
+      map->contains(cv::Point3d(table[i].x, table[i].y, m_tableHeight + m_pickHeight)) ? 255 : 0;
+
+  cv::resize(mask, mask, cv::Size(coarse.width * MASK_STEP, coarse.height * MASK_STEP), 0, 0, cv::INTER_NEAREST);
+  m_reachableMask = mask(cv::Rect(0, 0, size.width, size.height)).clone();
+  m_maskMap       = map;
+  return m_reachableMask;
+}
 // Actualizar label (Sin cambios)
 void VideoProcessingDialog::updateVideoLabel()
 {
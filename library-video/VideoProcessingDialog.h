@@ -7,8 +7,13 @@
 #include <QPoint>
 #include <QResizeEvent>
 #include <QSize>
+#include <array>
+#include <memory>
 #include <vector>
 
+class RobotHandler;
+class WorkspaceMap;
+
 namespace Ui
 {
 class VideoProcessingDialog;
@@ -19,7 +24,7 @@ class VideoProcessingDialog : public QDialog
   Q_OBJECT
 
 public:
-  explicit VideoProcessingDialog(QWidget* parent = nullptr);
+  explicit VideoProcessingDialog(QWidget* parent = nullptr, RobotHandler* robot = nullptr);
   ~VideoProcessingDialog();
 
 private slots:
@@ -47,6 +52,9 @@ private slots:
   void handleNewPixmap(const QPixmap& pixmap);
   void on_videoLabel_clicked(const QPoint& pos);
 
+  // Esquina de la mesa del punto seleccionado = posición actual de la pinza
+  void on_pushButtonTeachTableCorner_clicked();
+
 private:
   Ui::VideoProcessingDialog* ui;
 
@@ -60,6 +68,19 @@ private:
   // Puntos transformados después de aplicar perspectiva
   std::vector<QPoint> m_transformedCropPoints;
 
+  // Esquinas de la mesa (en el orden de los puntos de recorte, TL TR BR BL) en coordenadas de la
+  // base del robot, mm. Se miden llevando la pinza a cada esquina y se guardan en QSettings;
+  // mientras falte alguna no se sombrea el alcance ni se descartan objetos
+  RobotHandler*              m_robot = nullptr;
+  std::array<cv::Point3d, 4> m_tableCorners{};
+  int                        m_tableCornerMask = 0;  // Bit i: esquina i medida
+  double                     m_tableHeight     = 0;  // z de la mesa respecto a la base (media de las esquinas, mm)
+  double                     m_pickHeight      = 20; // Altura de agarre sobre la mesa (mm)
+
+  // Máscara de píxeles alcanzables de la vista rectificada; se recalcula si cambia el mapa o el tamaño
+  cv::Mat                             m_reachableMask;
+  std::shared_ptr<const WorkspaceMap> m_maskMap;
+
   // Configuración
   bool m_applyPerspectiveCorrection = true;
   bool m_applySegmentacion          = false;
@@ -90,6 +111,16 @@ private:
                                std::vector<QPoint>& transformedPoints);
   void    updatePointInfoLabel();
 
+  // Geometría de la mesa guardada en QSettings
+  void loadTableGeometry();
+  void saveTableGeometry() const;
+  bool tableGeometryValid() const;
+
+  // Alcance del robot sobre la vista rectificada
+  cv::Mat        tableHomography(const cv::Size& size) const;
+  cv::Point3d    pixelToRobot(const cv::Mat& homography, const cv::Point2d& pixel) const;
+  const cv::Mat& reachableMask(const std::shared_ptr<const WorkspaceMap>& map, const cv::Size& size);
+
   // Utilidades
   QSize parseResolution(const QString& text);
   int   mapSliderToOpenCV(int sliderValue, const PropertyRange& range);
@@ -5,6 +5,7 @@
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QFutureWatcher>
 #include <QLineEdit>
 #include <QProcess>
 #include <QSettings>
@@ -14,6 +15,7 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
 {
   ui->setupUi(this);
   this->setWindowTitle("Robot Arm Controller");
+  m_RobotHandler->setRobotSettings(&m_robotSettings);
 
   setupConnections();
   connectVideoSignals();
@@ -35,10 +37,12 @@ void MainWindow::setupConnections()
   connect(&serial, &SerialPortHandler::errorOccurred, this, &MainWindow::onSerialError);
   connect(&serial, &SerialPortHandler::connectionStatusChanged, this, &MainWindow::onSerialStatusChanged);
   connect(&serial, &SerialPortHandler::dataReceived, this, &MainWindow::onDataReceived);
+  connect(&serial, &SerialPortHandler::linkStatsUpdated, this, &MainWindow::onSerialLinkStatsUpdated);
   connect(m_RobotHandler, &RobotHandler::motorAngleChanged, this, &MainWindow::onRobotMotorAngleUpdatedFromSerial);
   connect(m_RobotHandler, &RobotHandler::motorOffsetsChanged, this, &MainWindow::onRobotMotorOffsetsReadFromMemory);
   connect(m_RobotHandler, &RobotHandler::errorOccurred, this, &MainWindow::onSerialError);
   connect(m_RobotHandler, &RobotHandler::efectorPositionChanged, this, &MainWindow::onEfectorPositionChanged);
+  connect(m_RobotHandler, &RobotHandler::controlStatsUpdated, this, &MainWindow::onRobotControlStatsUpdated);
 }
 
 void MainWindow::on_actionSerial_triggered()
@@ -135,7 +139,7 @@ void MainWindow::on_actionCalibrationVideo_triggered()
 void MainWindow::on_actionProcessingVideo_triggered()
 {
   if (!m_VideoProcessingDialog) {
-    m_VideoProcessingDialog = new VideoProcessingDialog(this);
+    m_VideoProcessingDialog = new VideoProcessingDialog(this, m_RobotHandler);
   }
 
   // Si la cámara ya está corriendo, el diálogo mostrará el stream actual.
@@ -183,42 +187,60 @@ void MainWindow::on_actionControlRobot_triggered()
   // Disconnect previous connections if any to avoid duplicates
   disconnect(m_RobotControl, &RobotControlDialog::errorOccurred, this, &MainWindow::onRobotControlError);
   disconnect(m_RobotControl, &RobotControlDialog::motorAngleChanged, this, &MainWindow::onRobotMotorAngleChanged);
+  disconnect(m_RobotControl, &RobotControlDialog::motorAnglesChanged, this, &MainWindow::onRobotMotorAnglesChanged);
+  disconnect(m_RobotControl, &RobotControlDialog::linearMoveRequested, this, &MainWindow::onRobotLinearMoveRequested);
   disconnect(m_RobotControl, &RobotControlDialog::allMotorsReset, this, &MainWindow::onAllMotorsReset);
   disconnect(m_RobotControl, &RobotControlDialog::motorOffsetChanged, this, &MainWindow::onRobotMotorOffsetChanged);
 
   // Connect signals from RobotControlDialog
   connect(m_RobotControl, &RobotControlDialog::errorOccurred, this, &MainWindow::onRobotControlError);
   connect(m_RobotControl, &RobotControlDialog::motorAngleChanged, this, &MainWindow::onRobotMotorAngleChanged);
+  connect(m_RobotControl, &RobotControlDialog::motorAnglesChanged, this, &MainWindow::onRobotMotorAnglesChanged);
+  connect(m_RobotControl, &RobotControlDialog::linearMoveRequested, this, &MainWindow::onRobotLinearMoveRequested);
   connect(m_RobotControl, &RobotControlDialog::allMotorsReset, this, &MainWindow::onAllMotorsReset);
   connect(m_RobotControl, &RobotControlDialog::motorOffsetChanged, this, &MainWindow::onRobotMotorOffsetChanged);
 
-  // Enviar comando al Arduino para leer los offsets
+  // Leer los offsets del Arduino
   if (SerialPortHandler::instance().isConnected()) {
-    QString commandOffset = "READ:OFFSETS";
-    SerialPortHandler::instance().sendData(commandOffset.toUtf8());
-    // QString commandAngles = "READ:ANGLES_WITH_OFFSET";
-    // SerialPortHandler::instance().sendData(commandAngles.toUtf8());
+    requestOffsets();
   }
   else {
     LogHandler::warning(ui->textEditLog, "No se puede enviar comando: puerto serie no conectado");
   }
 }
 
+void MainWindow::requestOffsets()
+{
+  // Los valores llegan por RobotHandler::motorOffsetsChanged según entran; aquí solo se sabe si se completó
+  SerialRequest request;
+  request.kind = SerialRequest::ReadOffsets;
+
+  auto* watcher = new QFutureWatcher<SerialReply>(this);
+  connect(watcher, &QFutureWatcher<SerialReply>::finished, this, [this, watcher]() {
+    watcher->deleteLater();
+    if (!watcher->future().isResultReadyAt(0))
+      return;
+    const SerialReply reply = watcher->result();
+    if (reply.ok)
+      LogHandler::info(ui->textEditLog, QString("Offsets read in %1 ms (attempt %2)").arg(reply.rttMs, 0, 'f', 1).arg(reply.attempts));
+    else
+      LogHandler::warning(ui->textEditLog, "Could not read offsets: " + reply.error);
+  });
+  watcher->setFuture(SerialPortHandler::instance().request(request));
+}
+
 void MainWindow::on_actionCalibrateRobot_triggered()
 {
   LogHandler::info(ui->textEditLog, "Robot calibration started");
-  int calibratedAngles[] = {90, 90, 98, 90, 142, 82};
-  for (int i = 0; i < 6; ++i) {
-    if (SerialPortHandler::instance().isConnected()) {
-      QString command = QString("SETUP:SERVO%1:%2").arg(i + 1).arg(calibratedAngles[i]);
-      SerialPortHandler::instance().sendData(command.toUtf8());
-      LogHandler::info(ui->textEditLog, QString("Sent calibration to motor %1: %2").arg(i + 1).arg(command.trimmed()));
-    }
-    else {
-      LogHandler::warning(ui->textEditLog, "Cannot send calibration: Serial port not connected");
-      break;
-    }
+  if (!SerialPortHandler::instance().isConnected()) {
+    LogHandler::warning(ui->textEditLog, "Cannot send calibration: Serial port not connected");
+    return;
   }
+
+  // También pasa por el planificador, así el siguiente movimiento parte de esta pose
+  const JointAngles calibratedAngles = {90, 90, 98, 90, 142, 82};
+  m_RobotHandler->moveTo(calibratedAngles);
+  LogHandler::info(ui->textEditLog, "Moving to the calibration pose");
 }
 
 void MainWindow::onSerialError(const QString& error)
@@ -229,6 +251,10 @@ void MainWindow::onSerialError(const QString& error)
 void MainWindow::onSerialStatusChanged(bool connected)
 {
   LogHandler::info(ui->textEditLog, QString("Serial port %1").arg(connected ? "connected" : "disconnected"));
+
+  // Sincronización inicial: la petición espera a que termine la negociación del protocolo
+  if (connected)
+    requestOffsets();
 }
 
 void MainWindow::onSetupConnectionError(const QString& error)
@@ -246,6 +272,23 @@ void MainWindow::onDataReceived(const QByteArray& data)
   LogHandler::info(ui->textEditLog, QString("Serial port %1").arg(data));
 }
 
+void MainWindow::onSerialLinkStatsUpdated(const SerialLinkStats& stats)
+{
+  // Solo se avisa al entrar y al salir de la saturación, no cada segundo
+  const bool saturated = stats.utilization >= 0.9;
+  if (saturated == m_serialLinkSaturated)
+    return;
+  m_serialLinkSaturated = saturated;
+  if (saturated)
+    LogHandler::warning(ui->textEditLog, QString("Serial link at %1% of %2 baud (%3 of %4 servo updates coalesced)")
+                                           .arg(stats.utilization * 100.0, 0, 'f', 0)
+                                           .arg(stats.baudRate)
+                                           .arg(stats.coalescedUpdates)
+                                           .arg(stats.servoUpdates));
+  else
+    LogHandler::info(ui->textEditLog, QString("Serial link back to %1% utilization").arg(stats.utilization * 100.0, 0, 'f', 0));
+}
+
 void MainWindow::onRobotControlError(const QString& error)
 {
   LogHandler::error(ui->textEditLog, "Robot Control Error: " + error);
@@ -253,17 +296,30 @@ void MainWindow::onRobotControlError(const QString& error)
 
 void MainWindow::onRobotMotorAngleChanged(int motorIndex, int angle)
 {
-  // send command to robot via serial
+  // El hilo de control lleva el motor hasta el ángulo con los límites de velocidad y aceleración
+  // Llega con cada valueChanged de un slider: sin línea de registro por evento, el envío ya lo agrupa el puerto serie
   if (SerialPortHandler::instance().isConnected()) {
-    QString command = QString("SETUP:SERVO%1:%2").arg(motorIndex).arg(angle);
-    SerialPortHandler::instance().sendData(command.toUtf8());
-    LogHandler::info(ui->textEditLog, QString("Sent command to motor %1: %2").arg(motorIndex).arg(command.trimmed()));
+    m_RobotHandler->moveJointTo(motorIndex, angle);
   }
   else {
     LogHandler::warning(ui->textEditLog, "Cannot send command: Serial port not connected");
   }
 }
 
+void MainWindow::onRobotMotorAnglesChanged(const QVector<int>& angles)
+{
+  if (!SerialPortHandler::instance().isConnected()) {
+    LogHandler::warning(ui->textEditLog, "Cannot send command: Serial port not connected");
+    return;
+  }
+
+  JointAngles goal = m_RobotHandler->currentAngles();
+  for (int i = 0; i < angles.size() && i < int(goal.size()); ++i)
+    goal[i] = angles[i];
+  m_RobotHandler->moveTo(goal);
+  LogHandler::info(ui->textEditLog, "Moving all motors to the requested pose");
+}
+
 void MainWindow::onRobotMotorOffsetChanged(int motorIndex, int newOffset)
 {
   // send command to robot via serial
@@ -322,7 +378,9 @@ void MainWindow::onRobotMotorOffsetsReadFromMemory(int motorIndex, int offset)
 
   m_robotSettings.motors[motorIndex - 1].defaultAngle = offset;
 
-  m_RobotControl->setupOffsets();
+  // Al conectar se leen antes de haber abierto el control del robot
+  if (m_RobotControl)
+    m_RobotControl->setupOffsets();
 
   LogHandler::info(ui->textEditLog, QString("Updated offset for motor %1 with value %2").arg(motorIndex).arg(offset));
 }
@@ -332,6 +390,37 @@ void MainWindow::onEfectorPositionChanged(double x, double y, double z)
   ui->lineEditX->setText(QString::number(x, 'f', 2) + " mm");
   ui->lineEditY->setText(QString::number(y, 'f', 2) + " mm");
   ui->lineEditZ->setText(QString::number(z, 'f', 2) + " mm");
+  if (m_RobotControl)
+    m_RobotControl->setEffectorPosition(x, y, z);
+}
+
+void MainWindow::onRobotLinearMoveRequested(double x, double y, double z, double speed, bool keepPitch)
+{
+  if (!SerialPortHandler::instance().isConnected()) {
+    LogHandler::warning(ui->textEditLog, "Cannot send command: Serial port not connected");
+    return;
+  }
+
+  LinearMove move;
+  move.target    = cv::Point3d(x, y, z);
+  move.speed     = speed;
+  move.keepPitch = keepPitch;
+  m_RobotHandler->moveLinear(move);
+  LogHandler::info(ui->textEditLog, QString("Moving effector linearly to (%1, %2, %3) at %4 mm/s").arg(x).arg(y).arg(z).arg(speed));
+}
+
+void MainWindow::onRobotControlStatsUpdated(const ControlLoopStats& stats)
+{
+  // Solo se avisa cuando aparecen plazos incumplidos nuevos
+  if (stats.missedDeadlines <= m_reportedMissedDeadlines)
+    return;
+  m_reportedMissedDeadlines = stats.missedDeadlines;
+  LogHandler::warning(ui->textEditLog, QString("Control loop at %1 Hz: %2 missed deadlines in %3 ticks (max lateness %4 us, max work %5 us)")
+                                         .arg(stats.rateHz)
+                                         .arg(stats.missedDeadlines)
+                                         .arg(stats.ticks)
+                                         .arg(stats.maxLatenessUs, 0, 'f', 0)
+                                         .arg(stats.maxWorkUs, 0, 'f', 0));
 }
 
 void MainWindow::onAllMotorsReset()
@@ -50,10 +50,14 @@ private slots:
   void onSetupConnectionError(const QString& error);
   void onSerialMonitorWarning(const QString& warning);
   void onDataReceived(const QByteArray& data);
+  void onSerialLinkStatsUpdated(const SerialLinkStats& stats);
 
   // Robot Control
   void onRobotControlError(const QString& error);
   void onRobotMotorAngleChanged(int motorIndex, int angle);
+  void onRobotMotorAnglesChanged(const QVector<int>& angles);
+  void onRobotLinearMoveRequested(double x, double y, double z, double speed, bool keepPitch);
+  void onRobotControlStatsUpdated(const ControlLoopStats& stats);
   void onAllMotorsReset();
   void onRobotMotorAngleUpdatedFromSerial(int motorIndex, int angle);
   void onRobotMotorOffsetsReadFromMemory(int motorIndex, int offset);
@@ -76,11 +80,14 @@ private:
   VideoProcessingDialog*  m_VideoProcessingDialog  = nullptr;
   RobotHandler*           m_RobotHandler           = nullptr;
   QImage                  m_lastCapturedFrame;
+  quint64                 m_reportedMissedDeadlines = 0;
+  bool                    m_serialLinkSaturated     = false;
 
   QSettings                  m_settings;
   RobotConfig::RobotSettings m_robotSettings;
 
   void setupConnections();
+  void requestOffsets();
   void connectVideoSignals();
   void disconnectVideoSignals();
 };
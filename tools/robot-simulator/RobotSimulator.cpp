@@ -0,0 +1,493 @@
+/**
+ * @file RobotSimulator.cpp
+ * @brief Firmware del brazo simulado sobre un pseudoterminal, para probar sin hardware.
+ * @details Abre un pty y se comporta como el Arduino al otro lado del cable:
+ *   - ASCII: SETUP:SERVOn:ángulo, SETUP:OFFSETn:offset, READ:OFFSETS y READ:ANGLES_WITH_OFFSET;
+ *     informa del movimiento de los servos con ANGLE_WITH_OFFSET:SERVOn:ángulo.
+ *   - Binario (--protocol binary): contesta al PROBE y pasa a las tramas de SerialProtocol; las
+ *     respuestas a un Command repiten su secuencia y los informes de movimiento llevan la marca
+ *     UNSOLICITED. Un PROBE posterior (la aplicación ha vuelto a abrir el puerto) se contesta otra vez.
+ * Cada servo sigue a su objetivo con velocidad y aceleración máximas, frenando a tiempo para no
+ * pasarse. El enlace se modela en los dos sentidos con los baudios (10 bits por byte en el cable,
+ * un byte detrás de otro) y una latencia fija por tramo, así que los tiempos que ve
+ * SerialPortHandler se parecen a los de un adaptador USB-serie.
+ *
+ * La aplicación abre el otro extremo como cualquier puerto: basta escribir la ruta que se
+ * imprime al arrancar (o la de --link) en el combo de puertos del diálogo de conexión.
+ *
+ * Uso: robotSimulator [--link /tmp/robotarm] [--baud 115200] [--latency-ms 2] [--protocol ascii|binary]
+ *                     [--speed 300] [--accel 3000] [--report-hz 20]
+ */
+#include "SerialLineParser.h"
+#include "SerialProtocol.h"
+#include <QByteArray>
+#include <QVector>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+const int    SERVO_COUNT  = SerialProtocol::SERVO_COUNT;
+const qint64 TICK_NS      = 1000000; // Paso de la dinámica de los servos: 1 kHz
+const int    READ_CHUNK   = 4096;
+const int    HOME_ANGLE   = 90;
+const double SETTLE_ANGLE = 0.05; // Grados: por debajo se da el servo por llegado
+
+volatile std::sig_atomic_t g_running = 1;
+
+void stop(int)
+{
+  g_running = 0;
+}
+
+qint64 nowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+struct Options
+{
+  std::string link;
+  qint32      baudRate  = 115200;
+  double      latencyMs = 2.0;
+  bool        binary    = false;
+  double      speed     = 300.0;  // Grados/s
+  double      accel     = 3000.0; // Grados/s²
+  double      reportHz  = 20.0;   // 0: solo se informa al pedirlo con READ:ANGLES_WITH_OFFSET
+};
+
+bool parseOptions(int argc, char* argv[], Options& options)
+{
+  for (int i = 1; i < argc; ++i) {
+    const std::string name = argv[i];
+    if (i + 1 >= argc)
+      return false;
+    const char* value = argv[++i];
+    if (name == "--link")
+      options.link = value;
+    else if (name == "--baud")
+      options.baudRate = std::atoi(value);
+    else if (name == "--latency-ms")
+      options.latencyMs = std::atof(value);
+    else if (name == "--protocol")
+      options.binary = std::strcmp(value, "binary") == 0;
+    else if (name == "--speed")
+      options.speed = std::atof(value);
+    else if (name == "--accel")
+      options.accel = std::atof(value);
+    else if (name == "--report-hz")
+      options.reportHz = std::atof(value);
+    else
+      return false;
+  }
+  return options.baudRate > 0 && options.latencyMs >= 0.0 && options.speed > 0.0 && options.accel > 0.0 && options.reportHz >= 0.0;
+}
+
+/**
+ * @brief Un sentido del cable.
+ * @details Cada tramo empieza a transmitirse cuando ha terminado el anterior, tarda 10 bits por
+ * byte a los baudios dados y se entrega tras la latencia fija.
+ */
+class Wire
+{
+public:
+  Wire(qint32 baudRate, double latencyMs) : m_nsPerByte(10.0e9 / baudRate), m_latencyNs(qint64(latencyMs * 1e6)) {}
+
+  void push(const QByteArray& data, qint64 now)
+  {
+    const qint64 start = std::max(now, m_freeNs);
+    m_freeNs           = start + qint64(data.size() * m_nsPerByte);
+    m_chunks.emplace_back(m_freeNs + m_latencyNs, data);
+  }
+
+  bool pop(qint64 now, QByteArray& data)
+  {
+    if (m_chunks.empty() || m_chunks.front().first > now)
+      return false;
+    data = std::move(m_chunks.front().second);
+    m_chunks.pop_front();
+    return true;
+  }
+
+private:
+  double                                    m_nsPerByte;
+  qint64                                    m_latencyNs;
+  qint64                                    m_freeNs = 0;
+  std::deque<std::pair<qint64, QByteArray>> m_chunks;
+};
+
+struct Servo
+{
+  double position = HOME_ANGLE;
+  double velocity = 0.0;
+  int    target   = HOME_ANGLE;
+  int    offset   = 0;
+  int    reported = HOME_ANGLE; // Último ángulo enviado; en reposo no se informa de nada
+};
+
+struct Stats
+{
+  quint64 rxBytes  = 0;
+  quint64 txBytes  = 0;
+  quint64 commands = 0; // SETUP de servo u offset
+  quint64 reads    = 0; // READ:OFFSETS y READ:ANGLES_WITH_OFFSET
+  quint64 reports  = 0; // Líneas o tramas de ángulo enviadas sin pedirlas
+  quint64 unknown  = 0;
+};
+
+int readInt16(const QByteArray& data, int offset)
+{
+  return qint16(quint16(quint8(data[offset])) | quint16(quint8(data[offset + 1]) << 8));
+}
+
+QByteArray servoValuePayload(int servo, int value)
+{
+  QByteArray payload;
+  payload.append(char(quint8(servo)));
+  payload.append(char(quint16(qint16(value)) & 0xFF));
+  payload.append(char(quint16(qint16(value)) >> 8));
+  return payload;
+}
+
+/**
+ * @brief Lo que corre en el Arduino: interpreta comandos, mueve los servos y contesta.
+ * @details El ángulo informado está en la misma referencia que SETUP:SERVO; el offset solo
+ * desplazaría el pulso del servo real, así que aquí se guarda y se devuelve con READ:OFFSETS.
+ */
+class Firmware
+{
+public:
+  Firmware(const Options& options, Wire& tx) : m_options(options), m_tx(tx) {}
+
+  void receive(const QByteArray& data, qint64 now)
+  {
+    int offset = 0;
+    while (!m_binaryActive && offset < data.size()) {
+      offset += m_lines->write(data.constData() + offset, data.size() - offset);
+      drainLines(now);
+    }
+    if (m_binaryActive && offset < data.size())
+      feedFrames(data.mid(offset), now);
+  }
+
+  void step(double dt, qint64 now)
+  {
+    for (Servo& servo : m_servos) {
+      const double error = servo.target - servo.position;
+      // Velocidad con la que todavía se puede parar justo en el objetivo
+      const double brake   = std::sqrt(2.0 * m_options.accel * std::abs(error));
+      const double desired = std::copysign(std::min(m_options.speed, brake), error);
+      servo.velocity += std::clamp(desired - servo.velocity, -m_options.accel * dt, m_options.accel * dt);
+      servo.position += servo.velocity * dt;
+      if (std::abs(servo.target - servo.position) < SETTLE_ANGLE && std::abs(servo.velocity) < m_options.accel * dt) {
+        servo.position = servo.target;
+        servo.velocity = 0.0;
+      }
+    }
+
+    if (m_options.reportHz > 0.0 && now >= m_nextReportNs) {
+      m_nextReportNs = now + qint64(1e9 / m_options.reportHz);
+      report(now);
+    }
+  }
+
+  const Stats& stats() const { return m_stats; }
+  Stats&       stats() { return m_stats; }
+
+private:
+  const Options&                    m_options;
+  Wire&                             m_tx;
+  std::array<Servo, SERVO_COUNT>    m_servos{};
+  std::unique_ptr<SerialLineParser> m_lines{new SerialLineParser()};
+  SerialProtocol::FrameDecoder      m_decoder;
+  QByteArray                        m_probeWindow; // Cola de lo recibido en binario, para ver un PROBE partido
+  bool                              m_binaryActive = false;
+  quint8                            m_sequence     = SerialProtocol::UNSOLICITED; // Informes sin petición
+  qint64                            m_nextReportNs = 0;
+  Stats                             m_stats;
+
+  void send(const QByteArray& data, qint64 now)
+  {
+    m_tx.push(data, now);
+  }
+
+  void sendLine(const QByteArray& line, qint64 now)
+  {
+    send(line + '\n', now);
+  }
+
+  void sendFrame(quint8 type, quint8 sequence, const QByteArray& payload, qint64 now)
+  {
+    send(SerialProtocol::encodeFrame(type, sequence, payload), now);
+  }
+
+  int angle(int index) const
+  {
+    return int(std::lround(m_servos[index].position));
+  }
+
+  void setTarget(int servo, int value)
+  {
+    if (servo < 1 || servo > SERVO_COUNT)
+      return;
+    m_servos[servo - 1].target = std::clamp(value, -180, 180);
+    ++m_stats.commands;
+  }
+
+  void setOffset(int servo, int value)
+  {
+    if (servo < 1 || servo > SERVO_COUNT)
+      return;
+    m_servos[servo - 1].offset = value;
+    ++m_stats.commands;
+  }
+
+  void drainLines(qint64 now)
+  {
+    SerialLineParser::Event event;
+    while (!m_binaryActive && m_lines->next(event)) {
+      if (event.type != SerialLineParser::Event::Overflow)
+        handleLine(QByteArray(event.text, event.length), now);
+    }
+    // Lo que quedase detrás del PROBE ya son tramas
+    if (m_binaryActive && m_lines->pending() > 0)
+      feedFrames(m_lines->takeRemaining(), now);
+  }
+
+  void handleLine(const QByteArray& line, qint64 now)
+  {
+    int servo = 0, value = 0;
+    if (line == SerialProtocol::PROBE) {
+      // El firmware antiguo no conoce el PROBE y lo ignora
+      if (m_options.binary) {
+        sendLine(SerialProtocol::PROBE_REPLY, now);
+        m_binaryActive = true;
+        m_decoder.clear();
+      }
+    }
+    else if (std::sscanf(line.constData(), "SETUP:SERVO%d:%d", &servo, &value) == 2)
+      setTarget(servo, value);
+    else if (std::sscanf(line.constData(), "SETUP:OFFSET%d:%d", &servo, &value) == 2)
+      setOffset(servo, value);
+    else if (line == "READ:OFFSETS") {
+      ++m_stats.reads;
+      for (int i = 0; i < SERVO_COUNT; ++i)
+        sendLine("OFFSET:SERVO" + QByteArray::number(i + 1) + ':' + QByteArray::number(m_servos[i].offset), now);
+    }
+    else if (line == "READ:ANGLES_WITH_OFFSET") {
+      ++m_stats.reads;
+      for (int i = 0; i < SERVO_COUNT; ++i)
+        sendLine("ANGLE_WITH_OFFSET:SERVO" + QByteArray::number(i + 1) + ':' + QByteArray::number(angle(i)), now);
+    }
+    else
+      ++m_stats.unknown;
+  }
+
+  void feedFrames(const QByteArray& data, qint64 now)
+  {
+    // La aplicación manda el PROBE en ASCII cada vez que abre el puerto: se vuelve a contestar
+    m_probeWindow += data;
+    if (m_probeWindow.contains(SerialProtocol::PROBE)) {
+      m_probeWindow.clear();
+      m_decoder.clear();
+      sendLine(SerialProtocol::PROBE_REPLY, now);
+      return;
+    }
+    m_probeWindow = m_probeWindow.right(int(std::strlen(SerialProtocol::PROBE)));
+
+    m_decoder.feed(data);
+    SerialProtocol::Frame frame;
+    while (m_decoder.next(frame))
+      handleFrame(frame, now);
+  }
+
+  void handleFrame(const SerialProtocol::Frame& frame, qint64 now)
+  {
+    const QByteArray& p = frame.payload;
+    switch (frame.type) {
+      case SerialProtocol::SetServo:
+        if (p.size() == 3)
+          setTarget(quint8(p[0]), readInt16(p, 1));
+        return;
+      case SerialProtocol::SetOffset:
+        if (p.size() == 3)
+          setOffset(quint8(p[0]), readInt16(p, 1));
+        return;
+      case SerialProtocol::SetAllServos:
+        if (p.size() == 2 * SERVO_COUNT) {
+          for (int i = 0; i < SERVO_COUNT; ++i)
+            m_servos[i].target = std::clamp(readInt16(p, 2 * i), -180, 180);
+          ++m_stats.commands;
+        }
+        return;
+      case SerialProtocol::Command:
+        // Las respuestas llevan la secuencia de la petición
+        if (p == "READ:OFFSETS") {
+          ++m_stats.reads;
+          for (int i = 0; i < SERVO_COUNT; ++i)
+            sendFrame(SerialProtocol::ServoOffset, frame.sequence, servoValuePayload(i + 1, m_servos[i].offset), now);
+          return;
+        }
+        if (p == "READ:ANGLES_WITH_OFFSET") {
+          ++m_stats.reads;
+          sendFrame(SerialProtocol::AllServoAngles, frame.sequence, SerialProtocol::allServosPayload(angles()), now);
+          return;
+        }
+        break;
+      default:
+        break;
+    }
+    ++m_stats.unknown;
+  }
+
+  QVector<int> angles() const
+  {
+    QVector<int> result(SERVO_COUNT);
+    for (int i = 0; i < SERVO_COUNT; ++i)
+      result[i] = angle(i);
+    return result;
+  }
+
+  void report(qint64 now)
+  {
+    bool moved = false;
+    for (int i = 0; i < SERVO_COUNT; ++i) {
+      if (angle(i) == m_servos[i].reported)
+        continue;
+      moved                = true;
+      m_servos[i].reported = angle(i);
+      if (!m_binaryActive) {
+        sendLine("ANGLE_WITH_OFFSET:SERVO" + QByteArray::number(i + 1) + ':' + QByteArray::number(angle(i)), now);
+        ++m_stats.reports;
+      }
+    }
+    // En binario, una sola trama con las seis articulaciones
+    if (moved && m_binaryActive) {
+      sendFrame(SerialProtocol::AllServoAngles, m_sequence, SerialProtocol::allServosPayload(angles()), now);
+      m_sequence = SerialProtocol::nextSequence(m_sequence);
+      ++m_stats.reports;
+    }
+  }
+};
+
+void printStats(const Stats& stats, double seconds)
+{
+  std::printf("%.1f s: %llu bytes recibidos, %llu enviados, %llu comandos, %llu lecturas, %llu informes, %llu no reconocidos\n", seconds,
+              (unsigned long long)stats.rxBytes, (unsigned long long)stats.txBytes, (unsigned long long)stats.commands,
+              (unsigned long long)stats.reads, (unsigned long long)stats.reports, (unsigned long long)stats.unknown);
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    std::fprintf(stderr, "Uso: %s [--link ruta] [--baud 115200] [--latency-ms 2] [--protocol ascii|binary] [--speed 300] [--accel 3000] "
+                         "[--report-hz 20]\n",
+                 argv[0]);
+    return 1;
+  }
+
+  // 1. Pseudoterminal: el maestro es el firmware, el esclavo lo abre la aplicación
+  const int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+    std::perror("posix_openpt");
+    return 1;
+  }
+  const std::string slavePath = ptsname(master);
+
+  // Se mantiene abierto un extremo esclavo en crudo: sin él, el maestro da EIO cada vez que la
+  // aplicación cierra el puerto, y el eco de la disciplina de línea devolvería los comandos
+  const int slave = open(slavePath.c_str(), O_RDWR | O_NOCTTY);
+  termios   tio{};
+  if (slave < 0 || tcgetattr(slave, &tio) != 0) {
+    std::perror(slavePath.c_str());
+    return 1;
+  }
+  cfmakeraw(&tio);
+  tcsetattr(slave, TCSANOW, &tio);
+  fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+  if (!options.link.empty()) {
+    unlink(options.link.c_str());
+    if (symlink(slavePath.c_str(), options.link.c_str()) != 0) {
+      std::perror(options.link.c_str());
+      return 1;
+    }
+  }
+
+  std::printf("Puerto: %s%s%s\n", slavePath.c_str(), options.link.empty() ? "" : " -> ", options.link.c_str());
+  std::printf("%d baudios, %.1f ms de latencia, protocolo %s, %.0f grados/s, %.0f grados/s², informes a %.0f Hz\n", options.baudRate,
+              options.latencyMs, options.binary ? "binario" : "ASCII", options.speed, options.accel, options.reportHz);
+  std::fflush(stdout);
+
+  std::signal(SIGINT, stop);
+  std::signal(SIGTERM, stop);
+
+  // 2. Bucle: pty -> cable de entrada -> firmware -> cable de salida -> pty
+  Wire       rx(options.baudRate, options.latencyMs);
+  Wire       tx(options.baudRate, options.latencyMs);
+  Firmware   firmware(options, tx);
+  QByteArray outgoing;
+  char       buffer[READ_CHUNK];
+
+  const qint64 startNs  = nowNs();
+  qint64       nextTick = startNs;
+  while (g_running) {
+    pollfd fd{master, short(POLLIN | (outgoing.isEmpty() ? 0 : POLLOUT)), 0};
+    poll(&fd, 1, 1);
+
+    qint64 now = nowNs();
+    for (;;) {
+      const ssize_t received = read(master, buffer, sizeof(buffer));
+      if (received <= 0)
+        break;
+      firmware.stats().rxBytes += quint64(received);
+      rx.push(QByteArray(buffer, int(received)), now);
+    }
+
+    QByteArray data;
+    while (rx.pop(now, data))
+      firmware.receive(data, now);
+
+    // Si el proceso se ha retrasado, la dinámica se pone al día con pasos fijos (como mucho 100 ms)
+    nextTick = std::max(nextTick, now - 100 * TICK_NS);
+    while (nextTick <= now) {
+      firmware.step(TICK_NS / 1e9, nextTick);
+      nextTick += TICK_NS;
+    }
+
+    while (tx.pop(now, data))
+      outgoing += data;
+    if (!outgoing.isEmpty()) {
+      const ssize_t written = write(master, outgoing.constData(), size_t(outgoing.size()));
+      if (written > 0) {
+        firmware.stats().txBytes += quint64(written);
+        outgoing.remove(0, int(written));
+      }
+    }
+  }
+
+  if (!options.link.empty())
+    unlink(options.link.c_str());
+  close(slave);
+  close(master);
+  printStats(firmware.stats(), (nowNs() - startNs) / 1e9);
+  return 0;
+}